@@ -0,0 +1,307 @@
+// Config descriptor parsing, allocated tree against usbdesc views over
+// raw bytes. Tree is built by usbsysfs_parseconfig(), same allocations
+// as libusb_get_config_descriptor() does ( config, interfaces, alts,
+// endpoints and each extra ), so no device is needed :
+//
+//  walk     : parse, visit every interface, endpoint and class specific
+//             descriptor, free ( tree ) or only iterate ( views ).
+//  snapshot : one config into usbsnapshot, as listdevs does, from tree
+//             or from raw bytes copied once.
+//
+// Blobs are of mock devices, and a composite one of video and audio
+// functions with IADs, many alternate settings and class descriptors.
+//
+// build : make bench
+// usage : bin/desc_bench [passes]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+#include "usbdesc.h"
+#include "usbsnap.h"
+#include "usbsysfs.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define BENCH_REPS          20000
+
+typedef struct _benchblob {
+    const char*             name;
+    std::vector< uint8_t >  raw;
+}benchblob;
+
+static const uint8_t raw_hid[] = {
+    0x09, 0x02, 0x22, 0x00, 0x01, 0x01, 0x00, 0xA0, 0x32,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x01, 0x01, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x3F, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x08, 0x00, 0x0A
+};
+
+static const uint8_t raw_storage[] = {
+    0x09, 0x02, 0x2C, 0x00, 0x01, 0x01, 0x04, 0x80, 0x70,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0x08, 0x06, 0x50, 0x00,
+    0x07, 0x05, 0x81, 0x02, 0x00, 0x04, 0x00,
+    0x06, 0x30, 0x0F, 0x00, 0x00, 0x00,
+    0x07, 0x05, 0x02, 0x02, 0x00, 0x04, 0x00,
+    0x06, 0x30, 0x0F, 0x00, 0x00, 0x00
+};
+
+static const uint8_t raw_audio[] = {
+    0x09, 0x02, 0x3D, 0x00, 0x02, 0x01, 0x00, 0x80, 0x32,
+    0x08, 0x0B, 0x00, 0x02, 0x01, 0x00, 0x00, 0x00,
+    0x09, 0x04, 0x00, 0x00, 0x00, 0x01, 0x01, 0x00, 0x00,
+    0x09, 0x24, 0x01, 0x00, 0x01, 0x09, 0x00, 0x01, 0x01,
+    0x09, 0x04, 0x01, 0x00, 0x00, 0x01, 0x02, 0x00, 0x00,
+    0x09, 0x04, 0x01, 0x01, 0x01, 0x01, 0x02, 0x00, 0x00,
+    0x09, 0x05, 0x01, 0x05, 0xC0, 0x00, 0x01, 0x00, 0x00
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static double elapsedms( std::chrono::steady_clock::time_point t0 )
+{
+    std::chrono::duration< double, std::milli > d = \
+        std::chrono::steady_clock::now() - t0;
+    return d.count();
+}
+
+static void putdesc( std::vector< uint8_t >& raw, const uint8_t* d )
+{
+    raw.insert( raw.end(), d, d + d[0] );
+}
+
+// webcam and headset like, one IAD per function.
+static void composite( std::vector< uint8_t >& raw )
+{
+    const uint8_t cfg[] = { 0x09, 0x02, 0x00, 0x00, 0x04, 0x01, 0x00, 0x80, 0xFA };
+    putdesc( raw, cfg );
+
+    for ( uint8_t fn=0; fn<2; fn++ )
+    {
+        uint8_t cls = fn == 0 ? 0x0E : 0x01;
+        uint8_t ifn = fn * 2;
+
+        const uint8_t iad[] = { 0x08, USBDESC_DT_IAD, ifn, 0x02, cls, 0x03, 0x00, 0x00 };
+        putdesc( raw, iad );
+
+        const uint8_t ctl[] = { 0x09, 0x04, ifn, 0x00, 0x01, cls, 0x01, 0x00, 0x00 };
+        putdesc( raw, ctl );
+
+        for ( uint8_t cs=0; cs<6; cs++ )
+        {
+            const uint8_t csd[] = { 0x0C, 0x24, (uint8_t)( cs + 1 ), cs, 0, 0, 0, 0, 0, 0, 0, 0 };
+            putdesc( raw, csd );
+        }
+
+        const uint8_t ep[] = { 0x07, 0x05, (uint8_t)( 0x81 + ifn ), 0x03, 0x10, 0x00, 0x08 };
+        putdesc( raw, ep );
+
+        const uint8_t csep[] = { 0x05, 0x25, 0x03, 0x10, 0x00 };
+        putdesc( raw, csep );
+
+        for ( uint8_t alt=0; alt<8; alt++ )
+        {
+            const uint8_t sif[] = { 0x09, 0x04, (uint8_t)( ifn + 1 ), alt,
+                                    (uint8_t)( alt > 0 ? 1 : 0 ), cls, 0x02, 0x00, 0x00 };
+            putdesc( raw, sif );
+
+            if ( alt == 0 )
+            {
+                for ( uint8_t cs=0; cs<10; cs++ )
+                {
+                    const uint8_t fmt[] = { 0x1E, 0x24, 0x05, cs, 0, 0, 0, 0, 0, 0,
+                                            0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                            0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+                    putdesc( raw, fmt );
+                }
+                continue;
+            }
+
+            uint16_t mps = 128 * alt;
+            const uint8_t ep[] = { 0x07, 0x05, (uint8_t)( 0x82 + ifn ), 0x05,
+                                   (uint8_t)( mps & 0xFF ), (uint8_t)( mps >> 8 ), 0x01 };
+            putdesc( raw, ep );
+        }
+    }
+
+    raw[2] = raw.size() & 0xFF;
+    raw[3] = raw.size() >> 8;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// sum of fields, so nothing visited is optimized out.
+static size_t walktree( const uint8_t* raw, size_t len )
+{
+    libusb_config_descriptor* cfg = usbsysfs_parseconfig( raw, len );
+    if ( cfg == NULL )
+        return 0;
+
+    size_t sum = cfg->extra_length;
+
+    for ( uint8_t x=0; x<cfg->bNumInterfaces; x++ )
+    {
+        const libusb_interface* pif = &cfg->interface[x];
+
+        for ( int y=0; y<pif->num_altsetting; y++ )
+        {
+            const libusb_interface_descriptor* pas = &pif->altsetting[y];
+            sum += pas->bInterfaceClass + pas->extra_length;
+
+            for ( uint8_t z=0; z<pas->bNumEndpoints; z++ )
+            {
+                sum += pas->endpoint[z].wMaxPacketSize + pas->endpoint[z].extra_length;
+            }
+        }
+    }
+
+    usbsysfs_freeconfig( cfg );
+
+    return sum;
+}
+
+static size_t walkviews( const uint8_t* raw, size_t len )
+{
+    usbdesciter it;
+    usbdescview v;
+
+    if ( usbdesc_config( &it, raw, len, &v ) == false )
+        return 0;
+
+    size_t sum = v.extralen;
+
+    do
+    {
+        if ( usbdesc_type( &v ) == LIBUSB_DT_INTERFACE )
+            sum += v.data[USBDESC_IF_CLASS] + v.extralen;
+        else
+        if ( usbdesc_type( &v ) == LIBUSB_DT_ENDPOINT )
+            sum += usbdesc_u16( &v.data[USBDESC_EP_MAXPKT] ) + v.extralen;
+
+        // class specific ones are visited too, tree leaves them in extra.
+        size_t off = 0;
+        const uint8_t* cs = NULL;
+        while( usbdesc_nextextra( &v, &off, &cs ) == true )
+        {
+            sum += cs[1];
+        }
+    }
+    while( usbdesc_next( &it, &v ) == true );
+
+    return sum;
+}
+
+static size_t snaptree( usbsnapshot& snap, usbdevfetch& pf, const std::vector< uint8_t >& raw )
+{
+    pf.config[0].cfg = usbsysfs_parseconfig( raw.data(), raw.size() );
+    usbsnap_clear( snap );
+    usbsnap_append( snap, &pf );
+    usbsysfs_freeconfig( pf.config[0].cfg );
+    pf.config[0].cfg = NULL;
+
+    return snap.eps.size();
+}
+
+static size_t snapraw( usbsnapshot& snap, usbdevfetch& pf, const std::vector< uint8_t >& raw )
+{
+    pf.config[0].raw.assign( raw.begin(), raw.end() );
+    usbsnap_clear( snap );
+    usbsnap_append( snap, &pf );
+    pf.config[0].raw.clear();
+
+    return snap.eps.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main( int argc, char** argv )
+{
+    int passes = 3;
+
+    if ( argc > 1 )
+        passes = atoi( argv[1] );
+
+    if ( passes <= 0 )
+        passes = 1;
+
+    std::vector< benchblob > blobs( 4 );
+    blobs[0].name = "hid";
+    blobs[0].raw.assign( raw_hid, raw_hid + sizeof( raw_hid ) );
+    blobs[1].name = "storage";
+    blobs[1].raw.assign( raw_storage, raw_storage + sizeof( raw_storage ) );
+    blobs[2].name = "audio";
+    blobs[2].raw.assign( raw_audio, raw_audio + sizeof( raw_audio ) );
+    blobs[3].name = "composite";
+    composite( blobs[3].raw );
+
+    usbdevfetch pf = usbdevfetch();
+    pf.config.resize( 1 );
+    pf.config[0].cfg = NULL;
+
+    usbsnapshot snap;
+
+    printf( "%-10s %6s %12s %12s %8s %12s %12s %8s\n",
+            "blob", "bytes", "walk tree", "walk views", "speedup",
+            "snap tree", "snap raw", "speedup" );
+
+    for ( size_t cnt=0; cnt<blobs.size(); cnt++ )
+    {
+        const std::vector< uint8_t >& raw = blobs[cnt].raw;
+
+        // same result of both, or comparison means nothing.
+        usbsnapshot st, sr;
+        snaptree( st, pf, raw );
+        snapraw( sr, pf, raw );
+        if ( ( st.eps.size() != sr.eps.size() ) || ( st.alts.size() != sr.alts.size() )
+             || ( st.pool != sr.pool ) )
+        {
+            fprintf( stderr, "%s : snapshots of tree and raw differ.\n", blobs[cnt].name );
+            return 1;
+        }
+
+        double best[4] = { 1e30, 1e30, 1e30, 1e30 };
+        volatile size_t sink = 0;
+
+        for ( int pass=0; pass<passes; pass++ )
+        {
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            for ( int rep=0; rep<BENCH_REPS; rep++ )
+                sink += walktree( raw.data(), raw.size() );
+            double ms = elapsedms( t0 );
+            if ( ms < best[0] ) best[0] = ms;
+
+            t0 = std::chrono::steady_clock::now();
+            for ( int rep=0; rep<BENCH_REPS; rep++ )
+                sink += walkviews( raw.data(), raw.size() );
+            ms = elapsedms( t0 );
+            if ( ms < best[1] ) best[1] = ms;
+
+            t0 = std::chrono::steady_clock::now();
+            for ( int rep=0; rep<BENCH_REPS; rep++ )
+                sink += snaptree( snap, pf, raw );
+            ms = elapsedms( t0 );
+            if ( ms < best[2] ) best[2] = ms;
+
+            t0 = std::chrono::steady_clock::now();
+            for ( int rep=0; rep<BENCH_REPS; rep++ )
+                sink += snapraw( snap, pf, raw );
+            ms = elapsedms( t0 );
+            if ( ms < best[3] ) best[3] = ms;
+        }
+
+        // ns per config.
+        for ( size_t itr=0; itr<4; itr++ )
+            best[itr] = best[itr] * 1e6 / BENCH_REPS;
+
+        printf( "%-10s %6zu %9.1f ns %9.1f ns %7.1fx %9.1f ns %9.1f ns %7.1fx\n",
+                blobs[cnt].name, raw.size(),
+                best[0], best[1], best[0] / best[1],
+                best[2], best[3], best[2] / best[3] );
+    }
+
+    return 0;
+}
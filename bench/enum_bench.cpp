@@ -0,0 +1,240 @@
+// Enumeration throughput on usbmock backend, no USB hardware needed.
+// For 10, 100, 1k and 10k synthesized devices, times each path of main
+// as listusb runs it, output buffer dropped instead of written :
+//
+//  listdevs     : enumerate with configs, snapshot, render every device.
+//  treelistdevs : enumerate without configs, build hub tree, render it.
+//  prtconfig    : render of config sections only, rendering of snapshot
+//                 with configs less same snapshot without them.
+//
+// With latency, each string transfer sleeps as a slow device would, 10k
+// devices are left out, and listdevs of 1k devices is timed for some
+// number of jobs.
+//
+// build : make bench
+// usage : bin/enum_bench [passes] [latency_us]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+#include "outbuf.h"
+#include "usbenum.h"
+#include "usbsnap.h"
+#include "usbrender.h"
+#include "usbtree.h"
+#include "usbmock.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define BENCH_DROPSZ        ( 1024 * 1024 )
+
+static const size_t benchdevs[] = { 10, 100, 1000, 10000 };
+static const uint32_t benchjobs[] = { 1, 2, 4, 8, 16 };
+
+////////////////////////////////////////////////////////////////////////////////
+
+static double elapsedms( std::chrono::steady_clock::time_point t0 )
+{
+    std::chrono::duration< double, std::milli > d = \
+        std::chrono::steady_clock::now() - t0;
+    return d.count();
+}
+
+static void dropout()
+{
+    if ( obuf.size >= BENCH_DROPSZ )
+        obuf.size = 0;
+}
+
+static void renderlist( const usbrenderer* render, const usbsnapshot* snap )
+{
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        render->device( snap, cnt );
+        dropout();
+    }
+}
+
+static size_t listdevs( libusb_context* ctx, const usbenumopt* opt,
+                        const usbrenderer* render )
+{
+    usbfetchlist ufl;
+    usbsnapshot  snap;
+
+    usbenum_fetchdevs( ctx, opt, ufl, true );
+    usbsnap_build( snap, ufl );
+    usbenum_free( ufl );
+
+    renderlist( render, &snap );
+    obuf.size = 0;
+
+    return snap.devs.size();
+}
+
+static size_t treelistdevs( libusb_context* ctx, const usbenumopt* opt,
+                            const usbrenderer* render )
+{
+    usbfetchlist ufl;
+    usbsnapshot  snap;
+
+    usbenum_fetchdevs( ctx, opt, ufl, false );
+    usbsnap_build( snap, ufl );
+    usbenum_free( ufl );
+
+    usbtree tree;
+    usbtree_init( tree );
+
+    for ( size_t cnt=0; cnt<snap.devs.size(); cnt++ )
+    {
+        usbtree_add( tree, &snap, cnt );
+    }
+
+    usbtree_link( tree );
+
+    for ( const usbtreebus* pb = tree.first; pb != NULL; pb = pb->next )
+    {
+        render->treebus( pb->bus, pb->devs );
+
+        for ( const usbtreedev* pn = pb->first; pn != NULL; pn = usbtree_walk( pn ) )
+        {
+            render->treedev( pn );
+            dropout();
+        }
+    }
+
+    usbtree_free( tree );
+    obuf.size = 0;
+
+    return snap.devs.size();
+}
+
+static void snapshot( libusb_context* ctx, const usbenumopt* opt,
+                      usbsnapshot& snap, bool withconfig )
+{
+    usbfetchlist ufl;
+
+    usbenum_fetchdevs( ctx, opt, ufl, withconfig );
+    usbsnap_build( snap, ufl );
+    usbenum_free( ufl );
+}
+
+int main( int argc, char** argv )
+{
+    size_t   passes  = 5;
+    unsigned latency = 0;
+
+    if ( argc > 1 )
+        passes = strtoul( argv[1], NULL, 10 );
+
+    if ( argc > 2 )
+        latency = strtoul( argv[2], NULL, 10 );
+
+    if ( passes == 0 )
+        passes = 1;
+
+    const usbrenderer* render = usbrender_select( false, false, false );
+
+    usbenumopt opt;
+    usbenum_defaults( &opt );
+    opt.backend = usbmock_backend();
+
+    printf( "passes : %zu, latency : %u us, ms per pass\n", passes, latency );
+    printf( "  devices     listdevs  treelistdevs    prtconfig\n" );
+
+    for ( size_t idx=0; idx<sizeof( benchdevs ) / sizeof( size_t ); idx++ )
+    {
+        if ( ( latency > 0 ) && ( benchdevs[idx] > 1000 ) )
+            break;
+
+        usbmockopt mopt;
+        usbmock_defaults( &mopt );
+        mopt.devices    = benchdevs[idx];
+        mopt.latency_us = latency;
+
+        usbmock* mock = usbmock_create( &mopt );
+        libusb_context* ctx = usbmock_context( mock );
+
+        // strings of every device sleep, keep slow runs short.
+        size_t runs = passes;
+        if ( ( latency > 0 ) && ( benchdevs[idx] > 100 ) )
+            runs = 1;
+
+        std::chrono::steady_clock::time_point t0 = \
+            std::chrono::steady_clock::now();
+        size_t devs = 0;
+        for ( size_t pass=0; pass<runs; pass++ )
+        {
+            devs = listdevs( ctx, &opt, render );
+        }
+        double ms_list = elapsedms( t0 ) / runs;
+
+        t0 = std::chrono::steady_clock::now();
+        for ( size_t pass=0; pass<runs; pass++ )
+        {
+            treelistdevs( ctx, &opt, render );
+        }
+        double ms_tree = elapsedms( t0 ) / runs;
+
+        usbsnapshot snapcfg;
+        usbsnapshot snapnocfg;
+        snapshot( ctx, &opt, snapcfg, true );
+        snapshot( ctx, &opt, snapnocfg, false );
+
+        // rendering only is fast, repeated for at least 10k devices a pass.
+        size_t reps = passes * ( benchdevs[idx] < 10000 ? 10000 / benchdevs[idx] : 1 );
+
+        t0 = std::chrono::steady_clock::now();
+        for ( size_t pass=0; pass<reps; pass++ )
+        {
+            renderlist( render, &snapcfg );
+        }
+        double ms_withcfg = elapsedms( t0 ) / reps;
+
+        t0 = std::chrono::steady_clock::now();
+        for ( size_t pass=0; pass<reps; pass++ )
+        {
+            renderlist( render, &snapnocfg );
+        }
+        double ms_nocfg = elapsedms( t0 ) / reps;
+        obuf.size = 0;
+
+        printf( "  %7zu  %11.3f  %12.3f  %11.3f\n",
+                devs, ms_list, ms_tree, ms_withcfg - ms_nocfg );
+
+        usbmock_destroy( mock );
+    }
+
+    if ( latency > 0 )
+    {
+        usbmockopt mopt;
+        usbmock_defaults( &mopt );
+        mopt.devices    = 1000;
+        mopt.latency_us = latency;
+
+        usbmock* mock = usbmock_create( &mopt );
+        libusb_context* ctx = usbmock_context( mock );
+
+        printf( "listdevs of %zu devices by jobs :\n", mopt.devices );
+
+        for ( size_t idx=0; idx<sizeof( benchjobs ) / sizeof( uint32_t ); idx++ )
+        {
+            opt.jobs = benchjobs[idx];
+
+            std::chrono::steady_clock::time_point t0 = \
+                std::chrono::steady_clock::now();
+            listdevs( ctx, &opt, render );
+
+            printf( "  jobs %2u : %10.3f ms\n", opt.jobs, elapsedms( t0 ) );
+        }
+
+        usbmock_destroy( mock );
+    }
+
+    ob_reset();
+
+    return 0;
+}
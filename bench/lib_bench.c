@@ -0,0 +1,168 @@
+// Repeated enumeration through liblistusb C interface. Every thread
+// enumerates on one shared context, walks whole snapshot and frees it.
+// Reports time per enumeration and peak RSS growth after first pass,
+// which should stay zero for any number of iterations.
+//
+// build : make bench
+// usage : bin/lib_bench [iterations] [threads] [--sysfs]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#include "listusb.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _benchjob {
+    listusb_ctx*    ctx;
+    size_t          iterations;
+    size_t          endpoints;
+}benchjob;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static long peakrss()
+{
+    struct rusage ru;
+    getrusage( RUSAGE_SELF, &ru );
+    return ru.ru_maxrss;
+}
+
+static double nowms()
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static size_t walk( const listusb_snapshot* snap )
+{
+    size_t eps = 0;
+    size_t devs = listusb_count( snap );
+
+    for ( size_t d=0; d<devs; d++ )
+    {
+        listusb_device dev;
+        if ( listusb_get_device( snap, d, &dev ) != LISTUSB_OK )
+            continue;
+
+        for ( size_t c=0; c<dev.configs; c++ )
+        {
+            listusb_config cfg;
+            if ( listusb_get_config( snap, d, c, &cfg ) != LISTUSB_OK )
+                continue;
+
+            for ( size_t i=0; i<cfg.bNumInterfaces; i++ )
+            {
+                size_t alts = listusb_altsettings( snap, d, c, i );
+
+                for ( size_t a=0; a<alts; a++ )
+                {
+                    listusb_altsetting as;
+                    listusb_endpoint ep;
+                    listusb_get_altsetting( snap, d, c, i, a, &as );
+
+                    for ( size_t e=0; e<as.bNumEndpoints; e++ )
+                    {
+                        if ( listusb_get_endpoint( snap, d, c, i, a, e, &ep ) == LISTUSB_OK )
+                            eps++;
+                    }
+                }
+            }
+        }
+    }
+
+    return eps;
+}
+
+static void* benchloop( void* param )
+{
+    benchjob* job = (benchjob*)param;
+
+    for ( size_t cnt=0; cnt<job->iterations; cnt++ )
+    {
+        listusb_snapshot* snap = listusb_enumerate( job->ctx );
+        if ( snap == NULL )
+            break;
+
+        job->endpoints += walk( snap );
+        listusb_free( snap );
+    }
+
+    return NULL;
+}
+
+int main( int argc, char** argv )
+{
+    size_t iterations = 10000;
+    size_t threads    = 1;
+    listusb_options opt;
+
+    listusb_options_init( &opt );
+
+    for ( int cnt=1, pos=0; cnt<argc; cnt++ )
+    {
+        if ( strcmp( argv[cnt], "--sysfs" ) == 0 )
+            opt.sysfs = 1;
+        else
+        if ( pos++ == 0 )
+            iterations = strtoul( argv[cnt], NULL, 10 );
+        else
+            threads = strtoul( argv[cnt], NULL, 10 );
+    }
+
+    if ( threads == 0 )
+        threads = 1;
+
+    listusb_ctx* ctx = listusb_create( &opt );
+    if ( ctx == NULL )
+    {
+        fprintf( stderr, "cannot create listusb context.\n" );
+        return -1;
+    }
+
+    // first pass allocates anything lazily kept, like libusb backend.
+    listusb_snapshot* snap = listusb_enumerate( ctx );
+    size_t devs = listusb_count( snap );
+    listusb_free( snap );
+
+    long   rss0 = peakrss();
+    double t0   = nowms();
+
+    benchjob*  jobs = (benchjob*)calloc( threads, sizeof( benchjob ) );
+    pthread_t* tids = (pthread_t*)calloc( threads, sizeof( pthread_t ) );
+
+    for ( size_t cnt=0; cnt<threads; cnt++ )
+    {
+        jobs[cnt].ctx        = ctx;
+        jobs[cnt].iterations = iterations / threads;
+        pthread_create( &tids[cnt], NULL, benchloop, &jobs[cnt] );
+    }
+
+    size_t eps = 0;
+    for ( size_t cnt=0; cnt<threads; cnt++ )
+    {
+        pthread_join( tids[cnt], NULL );
+        eps += jobs[cnt].endpoints;
+    }
+
+    double ms   = nowms() - t0;
+    long   rss1 = peakrss();
+
+    free( tids );
+    free( jobs );
+    listusb_destroy( ctx );
+
+    printf( "devices : %zu, iterations : %zu, threads : %zu, endpoints walked : %zu\n",
+            devs, iterations, threads, eps );
+    printf( "enumerate+walk+free : %.3f ms each, %.2f ms total\n",
+            iterations > 0 ? ms / iterations : 0.0, ms );
+    printf( "peak RSS : %ld KiB after first pass, %ld KiB at end ( +%ld KiB )\n",
+            rss0, rss1, rss1 - rss0 );
+
+    return 0;
+}
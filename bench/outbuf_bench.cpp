@@ -0,0 +1,115 @@
+// Microbenchmark : printf() per token vs. outbuf.
+// Renders the same endpoint-like listing as prtUSBConfig() does, to
+// /dev/null, both ways.
+//
+// build : make bench
+// usage : bin/outbuf_bench [lines]
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <chrono>
+
+#include "outbuf.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+static double elapsedms( std::chrono::steady_clock::time_point t0 )
+{
+    std::chrono::duration<double, std::milli> d = \
+        std::chrono::steady_clock::now() - t0;
+    return d.count();
+}
+
+static void render_printf( size_t lines )
+{
+    for( size_t cnt=0; cnt<lines; cnt++ )
+    {
+        printf( "\033[0m" );
+        printf( "  |-" );
+        printf( "\033[94m" );
+        printf( " endpoint[" );
+        printf( "\033[97m" );
+        printf( "%u", (unsigned)( cnt & 0x0F ) );
+        printf( "\033[94m" );
+        printf( "] : " );
+        printf( "\033[93m" );
+        printf( "0x%02X", (unsigned)( cnt & 0xFF ) );
+        printf( "\033[94m" );
+        printf( ", max packet size = " );
+        printf( "\033[97m" );
+        printf( "%u", (unsigned)( cnt % 1025 ) );
+        printf( "\033[0m" );
+        printf( "\n" );
+    }
+
+    fflush( stdout );
+}
+
+static void render_outbuf( size_t lines )
+{
+    for( size_t cnt=0; cnt<lines; cnt++ )
+    {
+        ob_puts( "\033[0m" );
+        ob_puts( "  |-" );
+        ob_puts( "\033[94m" );
+        ob_puts( " endpoint[" );
+        ob_puts( "\033[97m" );
+        ob_dec( cnt & 0x0F );
+        ob_puts( "\033[94m" );
+        ob_puts( "] : " );
+        ob_puts( "\033[93m" );
+        ob_puts( "0x" );
+        ob_hex( cnt & 0xFF, 2 );
+        ob_puts( "\033[94m" );
+        ob_puts( ", max packet size = " );
+        ob_puts( "\033[97m" );
+        ob_dec( cnt % 1025 );
+        ob_puts( "\033[0m" );
+        ob_putc( '\n' );
+    }
+
+    ob_flush();
+}
+
+int main( int argc, char** argv )
+{
+    size_t lines = 1000000;
+
+    if ( argc > 1 )
+        lines = strtoul( argv[1], NULL, 10 );
+
+    // both paths go to /dev/null, report goes to stderr.
+    int fdnull = open( "/dev/null", O_WRONLY );
+    if ( fdnull < 0 )
+    {
+        fprintf( stderr, "cannot open /dev/null\n" );
+        return -1;
+    }
+
+    fflush( stdout );
+    dup2( fdnull, 1 );
+    close( fdnull );
+
+    std::chrono::steady_clock::time_point t0 = \
+        std::chrono::steady_clock::now();
+    render_printf( lines );
+    double ms_printf = elapsedms( t0 );
+
+    t0 = std::chrono::steady_clock::now();
+    render_outbuf( lines );
+    double ms_outbuf = elapsedms( t0 );
+
+    fprintf( stderr, "lines  : %zu\n", lines );
+    fprintf( stderr, "printf : %.2f ms\n", ms_printf );
+    fprintf( stderr, "outbuf : %.2f ms ( x%.2f )\n",
+             ms_outbuf,
+             ms_outbuf > 0.0 ? ms_printf / ms_outbuf : 0.0 );
+
+    ob_reset();
+
+    return 0;
+}
@@ -0,0 +1,214 @@
+// Microbenchmark : runtime branched renderer vs. specialized usbrender.
+// Renders same synthetic devices in every ( simple, color, lessinfo )
+// mode both ways, output buffer is dropped after each pass. Legacy model
+// renders from fetched list, usbrender from snapshot, which build time
+// is reported apart. Tree of tree view is built and freed both ways,
+// one allocation per node vs. usbtree arena.
+//
+// build : make bench
+// usage : bin/render_bench [devices] [passes]
+
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+#include "outbuf.h"
+#include "usbfetch.h"
+#include "usbsnap.h"
+#include "usbrender.h"
+#include "usbtree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define BENCH_INTERFACES    3
+#define BENCH_ALTSETTINGS   2
+#define BENCH_ENDPOINTS     4
+
+extern uint32_t optpar_simple;
+extern uint32_t optpar_color;
+extern uint32_t optpar_lessinfo;
+
+void legacy_prtdevice( usbdevfetch* pf );
+size_t legacy_treebuild( const usbsnapshot* snap );
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const uint8_t epextra[] = { 0x06, 0x30, 0x0F, 0x05, 0x00, 0x00 };
+
+static libusb_config_descriptor* makeconfig()
+{
+    libusb_config_descriptor* cfg = new libusb_config_descriptor();
+    libusb_interface* pif = new libusb_interface[BENCH_INTERFACES]();
+
+    for ( size_t x=0; x<BENCH_INTERFACES; x++ )
+    {
+        libusb_interface_descriptor* pas = \
+            new libusb_interface_descriptor[BENCH_ALTSETTINGS]();
+
+        for ( size_t y=0; y<BENCH_ALTSETTINGS; y++ )
+        {
+            libusb_endpoint_descriptor* pep = \
+                new libusb_endpoint_descriptor[BENCH_ENDPOINTS]();
+
+            for ( size_t z=0; z<BENCH_ENDPOINTS; z++ )
+            {
+                pep[z].bEndpointAddress = (uint8_t)( z + 1 ) | ( ( z & 1 ) ? 0x80 : 0 );
+                pep[z].bmAttributes     = ( z & 1 ) ? 0x03 : 0x02;
+                pep[z].wMaxPacketSize   = 512;
+                pep[z].extra            = epextra;
+                pep[z].extra_length     = sizeof( epextra );
+            }
+
+            pas[y].bInterfaceNumber   = x;
+            pas[y].bAlternateSetting  = y;
+            pas[y].bInterfaceClass    = LIBUSB_CLASS_HID;
+            pas[y].bNumEndpoints      = BENCH_ENDPOINTS;
+            pas[y].endpoint           = pep;
+        }
+
+        pif[x].altsetting     = pas;
+        pif[x].num_altsetting = BENCH_ALTSETTINGS;
+    }
+
+    cfg->bNumInterfaces      = BENCH_INTERFACES;
+    cfg->bConfigurationValue = 1;
+    cfg->MaxPower            = 50;
+    cfg->interface           = pif;
+
+    return cfg;
+}
+
+static void makedevs( usbfetchlist& ufl, size_t cnt )
+{
+    ufl.resize( cnt );
+
+    for ( size_t idx=0; idx<cnt; idx++ )
+    {
+        usbdevfetch* pf = &ufl[idx];
+
+        pf->bus                   = 1 + ( idx / 16 );
+        pf->port                  = idx % 16;
+        pf->opened                = true;
+        pf->desc.idVendor         = 0x1D6B;
+        pf->desc.idProduct        = (uint16_t)idx;
+        pf->desc.bcdUSB           = ( idx & 1 ) ? 0x0300 : 0x0200;
+        pf->desc.bDeviceClass     = LIBUSB_CLASS_HUB;
+        pf->desc.bNumConfigurations = 1;
+
+        snprintf( (char*)pf->manufacturer, SLEN_MANUFACTURER, "Vendor %zu", idx );
+        snprintf( (char*)pf->product, SLEN_PRODUCT, "Product %zu", idx );
+        snprintf( (char*)pf->serialnumber, SLEN_SN, "SN%08zu", idx );
+
+        pf->config.resize( 1 );
+        pf->config[0].cfg = makeconfig();
+        snprintf( (char*)pf->config[0].cfgstr, SLEN_CONFIG, "Config %zu", idx );
+    }
+}
+
+static double elapsedms( std::chrono::steady_clock::time_point t0 )
+{
+    std::chrono::duration<double, std::milli> d = \
+        std::chrono::steady_clock::now() - t0;
+    return d.count();
+}
+
+int main( int argc, char** argv )
+{
+    size_t devs   = 256;
+    size_t passes = 200;
+
+    if ( argc > 1 )
+        devs = strtoul( argv[1], NULL, 10 );
+
+    if ( argc > 2 )
+        passes = strtoul( argv[2], NULL, 10 );
+
+    usbfetchlist ufl;
+    usbsnapshot  snap;
+    makedevs( ufl, devs );
+
+    std::chrono::steady_clock::time_point t0 = \
+        std::chrono::steady_clock::now();
+    for ( size_t pass=0; pass<passes; pass++ )
+    {
+        usbsnap_build( snap, ufl );
+    }
+    double ms_snap = elapsedms( t0 );
+
+    t0 = std::chrono::steady_clock::now();
+    for ( size_t pass=0; pass<passes; pass++ )
+    {
+        legacy_treebuild( &snap );
+    }
+    double ms_tlegacy = elapsedms( t0 );
+
+    t0 = std::chrono::steady_clock::now();
+    for ( size_t pass=0; pass<passes; pass++ )
+    {
+        usbtree tree;
+        usbtree_init( tree );
+
+        for ( size_t cnt=0; cnt<devs; cnt++ )
+        {
+            usbtree_add( tree, &snap, cnt );
+        }
+
+        usbtree_link( tree );
+        usbtree_free( tree );
+    }
+    double ms_tarena = elapsedms( t0 );
+
+    printf( "devices : %zu, passes : %zu\n", devs, passes );
+    printf( "snapshot build : %.2f ms\n", ms_snap );
+    printf( "tree build+free : %8.2f ms  %8.2f ms ( x%.2f )\n",
+            ms_tlegacy, ms_tarena,
+            ms_tarena > 0.0 ? ms_tlegacy / ms_tarena : 0.0 );
+    printf( "simple color lessinfo :     legacy  specialized\n" );
+
+    for ( uint32_t mode=0; mode<8; mode++ )
+    {
+        optpar_simple   = ( mode >> 2 ) & 1;
+        optpar_color    = ( mode >> 1 ) & 1;
+        optpar_lessinfo = mode & 1;
+
+        const usbrenderer* render = usbrender_select( optpar_simple > 0,
+                                                      optpar_color > 0,
+                                                      optpar_lessinfo > 0 );
+
+        t0 = std::chrono::steady_clock::now();
+        for ( size_t pass=0; pass<passes; pass++ )
+        {
+            for ( size_t cnt=0; cnt<devs; cnt++ )
+            {
+                legacy_prtdevice( &ufl[cnt] );
+            }
+            obuf.size = 0;
+        }
+        double ms_legacy = elapsedms( t0 );
+
+        t0 = std::chrono::steady_clock::now();
+        for ( size_t pass=0; pass<passes; pass++ )
+        {
+            for ( size_t cnt=0; cnt<devs; cnt++ )
+            {
+                render->device( &snap, cnt );
+            }
+            obuf.size = 0;
+        }
+        double ms_special = elapsedms( t0 );
+
+        printf( "     %u     %u        %u : %8.2f ms  %8.2f ms ( x%.2f )\n",
+                optpar_simple, optpar_color, optpar_lessinfo,
+                ms_legacy, ms_special,
+                ms_special > 0.0 ? ms_legacy / ms_special : 0.0 );
+    }
+
+    ob_reset();
+
+    return 0;
+}
@@ -0,0 +1,313 @@
+// Baseline of render_bench : minimal model of listusb renderer before
+// usbrender, not a copy of it. Every print site tests runtime option
+// flags, as old one did, through lg_color() and lg_pick(), for same
+// tokens usbrender emits per device, config, interface and endpoint.
+// Class names are printed as codes, switch of names is same both ways.
+// Tree build allocates one node per device, as treelistdevs() did.
+
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <vector>
+
+#include "outbuf.h"
+#include "usbfetch.h"
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t    optpar_simple       = 0;
+uint32_t    optpar_color        = 0;
+uint32_t    optpar_lessinfo     = 0;
+
+typedef struct _usbdevinfo {
+    uint8_t     port;
+    uint16_t    vid;
+    uint16_t    pid;
+    uint16_t    bcd;
+    uint16_t    clsID[2];
+    char        manufacturer[SLEN_MANUFACTURER];
+    char        product[SLEN_PRODUCT];
+    char        serialnumber[SLEN_SN];
+    char        classname[SLEN_CLASS];
+}usbdevdevinfo;
+
+typedef struct _usbdevbusinfo {
+    uint8_t                         bus;
+    std::vector< usbdevdevinfo* >   device;
+}usbdevbusinfo;
+
+typedef std::vector< usbdevbusinfo* >  usbdevtree;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void lg_color( const char* esc )
+{
+    if ( optpar_color > 0 )
+    {
+        ob_puts( esc );
+    }
+}
+
+static void lg_pick( const char* full, const char* simple )
+{
+    if ( optpar_simple == 0 )
+        ob_puts( full );
+    else
+        ob_puts( simple );
+}
+
+static void lg_field( const char* name, const char* sname, const char* str, const char* none )
+{
+    if ( optpar_simple == 0 )
+    {
+        ob_puts( "    + " );
+        lg_color( "\033[94m" );
+        ob_puts( name );
+        lg_color( "\033[93m" );
+        ob_puts( strlen( str ) > 0 ? str : none );
+        ob_putc( '\n' );
+    }
+    else
+    {
+        lg_color( "\033[94m" );
+        ob_puts( sname );
+        lg_color( "\033[93m" );
+        ob_puts( str );
+        ob_putc( ';' );
+    }
+}
+
+static void lg_endpoint( const libusb_endpoint_descriptor* pep )
+{
+    lg_color( "\033[96m" );
+    ob_hex( pep->bmAttributes, 2 );
+    ob_puts( " (" );
+
+    switch( pep->bmAttributes & LIBUSB_TRANSFER_TYPE_MASK )
+    {
+        case LIBUSB_ENDPOINT_TRANSFER_TYPE_CONTROL:     ob_puts( "Control" ); break;
+        case LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS: ob_puts( "Isochronous" ); break;
+        case LIBUSB_ENDPOINT_TRANSFER_TYPE_BULK:        ob_puts( "Bulk" ); break;
+        default:                                        ob_puts( "Interrupt" ); break;
+    }
+
+    ob_putc( ')' );
+    lg_color( "\033[93m" );
+
+    if ( ( pep->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK ) == LIBUSB_ENDPOINT_IN )
+        ob_puts( " EP:IN, " );
+    else
+        ob_puts( " EP:OUT, " );
+
+    for ( int q=0; q<pep->extra_length; q++ )
+    {
+        ob_hex( pep->extra[q], 2 );
+    }
+}
+
+static void lg_config( uint8_t idx, uint16_t bcd, const libusb_config_descriptor* cfg, const uint8_t* cfgstr )
+{
+    lg_color( "\033[93m" );
+
+    if ( optpar_simple == 0 )
+    {
+        ob_puts( "    + config[" );
+        ob_dec( idx, 2 );
+        ob_puts( "] : " );
+        ob_puts( (const char*)cfgstr );
+        ob_puts( ", interfaces = " );
+        ob_dec( cfg->bNumInterfaces );
+        ob_puts( ", ID = 0x" );
+        ob_hex( cfg->bConfigurationValue, 2 );
+        ob_puts( ", " );
+    }
+    else
+    {
+        ob_puts( (const char*)cfgstr );
+        ob_putc( ';' );
+    }
+
+    lg_color( "\033[94m" );
+    lg_pick( "max required power = ", "MRP=" );
+    lg_color( "\033[93m" );
+    ob_dec( cfg->MaxPower * ( bcd >= 0x0300 ? 8 : 2 ) );
+    lg_pick( " mA\n", "(mA)\n" );
+
+    if ( ( optpar_lessinfo > 0 ) || ( optpar_simple > 0 ) )
+        return;
+
+    for ( int x=0; x<cfg->bNumInterfaces; x++ )
+    {
+        const libusb_interface* pif = &cfg->interface[x];
+
+        lg_color( "\033[94m" );
+        ob_puts( "        - interface[" );
+        ob_int( x );
+        ob_puts( "] : alt.settings = " );
+        lg_color( "\033[93m" );
+        ob_int( pif->num_altsetting );
+        ob_puts( " : " );
+
+        for ( int y=0; y<pif->num_altsetting; y++ )
+        {
+            lg_color( "\033[31m" );
+            ob_hex( pif->altsetting[y].bInterfaceClass, 2 );
+            if ( y+1 < pif->num_altsetting )
+                ob_puts( ", " );
+        }
+        ob_putc( '\n' );
+
+        for ( int y=0; y<pif->num_altsetting; y++ )
+        {
+            const libusb_interface_descriptor* pas = &pif->altsetting[y];
+
+            lg_color( "\033[94m" );
+            ob_puts( "            -> ep[" );
+            ob_int( y );
+            ob_puts( "]=" );
+            lg_color( "\033[93m" );
+            ob_int( pas->bNumEndpoints );
+            ob_putc( ':' );
+
+            for ( int z=0; z<pas->bNumEndpoints; z++ )
+            {
+                lg_endpoint( &pas->endpoint[z] );
+                if ( z+1 < pas->bNumEndpoints )
+                    ob_puts( "\n                       " );
+            }
+            ob_putc( '\n' );
+        }
+    }
+}
+
+void legacy_prtdevice( usbdevfetch* pf )
+{
+    const libusb_device_descriptor& desc = pf->desc;
+
+    if ( pf->descerr != 0 )
+        return;
+
+    lg_color( "\033[94m" );
+    if ( optpar_simple == 0 )
+        ob_puts( "Bus " );
+    lg_color( "\033[93m" );
+    ob_dec( pf->bus, 3, '0' );
+    lg_color( "\033[94m" );
+    lg_pick( ", Port ", ";" );
+    lg_color( "\033[97m" );
+    ob_dec( pf->port, 3, '0' );
+    lg_pick( " ", ";" );
+
+    lg_color( "\033[92m" );
+    ob_putc( '[' );
+    ob_hex( desc.idVendor, 4 );
+    ob_putc( ':' );
+    ob_hex( desc.idProduct, 4 );
+    lg_pick( "] ", "];" );
+
+    lg_color( "\033[91m" );
+    ob_puts( (const char*)pf->manufacturer );
+    lg_pick( ", ", ";" );
+    lg_color( "\033[95m" );
+    ob_puts( (const char*)pf->product );
+    lg_pick( "\n", ";" );
+
+    lg_field( "Serial number = ", "", (const char*)pf->serialnumber, "(SN not found)" );
+
+    char code[8];
+    snprintf( code, sizeof( code ), "%02X:%02X",
+              desc.bDeviceClass, desc.bDeviceSubClass );
+    lg_field( "Class = ", "cls=", code, "none" );
+
+    uint16_t l16bcdID = libusb_cpu_to_le16( desc.bcdUSB );
+    char bcd[16];
+    snprintf( bcd, sizeof( bcd ), "%04X (%u.%u)", l16bcdID,
+              l16bcdID >> 8, ( l16bcdID & 0x00F0 ) >> 4 );
+    lg_field( "bcdID = ", "bcdID=", bcd, "" );
+
+    for ( size_t itr=0; itr<pf->config.size(); itr++ )
+    {
+        if ( pf->config[itr].cfg != NULL )
+        {
+            lg_config( itr, l16bcdID, pf->config[itr].cfg,
+                       pf->config[itr].cfgstr );
+        }
+        else
+        {
+            ob_putc( '\n' );
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t legacy_treebuild( const usbsnapshot* snap )
+{
+    usbdevtree usbtree;
+    size_t     nodes = 0;
+
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+        if ( pd->descerr != 0 )
+            continue;
+
+        usbdevbusinfo* pbi = NULL;
+        for ( size_t itr=0; itr<usbtree.size(); itr++ )
+        {
+            if ( usbtree[itr]->bus == pd->bus )
+            {
+                pbi = usbtree[itr];
+                break;
+            }
+        }
+
+        if ( pbi == NULL )
+        {
+            pbi = new usbdevbusinfo;
+            pbi->bus = pd->bus;
+            usbtree.push_back( pbi );
+        }
+
+        usbdevdevinfo* pdi = new usbdevdevinfo;
+        memset( pdi, 0, sizeof( usbdevdevinfo ) );
+        pbi->device.push_back( pdi );
+
+        pdi->port     = pd->port;
+        pdi->vid      = pd->desc.idVendor;
+        pdi->pid      = pd->desc.idProduct;
+        pdi->bcd      = libusb_cpu_to_le16( pd->desc.bcdUSB );
+        pdi->clsID[0] = pd->desc.bDeviceClass;
+        pdi->clsID[1] = pd->desc.bDeviceSubClass;
+
+        if ( pd->opened == true )
+        {
+            snprintf( pdi->product, SLEN_PRODUCT, "%s",
+                      usbsnap_str( snap, pd->product ) );
+            snprintf( pdi->manufacturer, SLEN_MANUFACTURER, "%s",
+                      usbsnap_str( snap, pd->manufacturer ) );
+            snprintf( pdi->serialnumber, SLEN_SN, "%s",
+                      usbsnap_str( snap, pd->serialnumber ) );
+        }
+
+        snprintf( pdi->classname, SLEN_CLASS, "%04X", pd->desc.bDeviceClass );
+        nodes++;
+    }
+
+    for ( size_t cnt=0; cnt<usbtree.size(); cnt++ )
+    {
+        for ( size_t itr=0; itr<usbtree[cnt]->device.size(); itr++ )
+        {
+            delete usbtree[cnt]->device[itr];
+        }
+
+        delete usbtree[cnt];
+    }
+
+    return nodes;
+}
@@ -0,0 +1,311 @@
+#include <libusb.h>
+#include <version_nano.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#include "listusb.h"
+#include "usbenum.h"
+#include "usbsysfs.h"
+#include "usbsnap.h"
+#include "usbdump.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct _listusb_ctx {
+    libusb_context*     usbctx;
+    usbenumopt          opt;
+    bool                withconfig;
+    mutex               lock;       /// one enumeration at a time.
+};
+
+struct _listusb_snapshot {
+    usbsnapshot         snap;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const snapcfg* getcfg( const listusb_snapshot* snap, size_t dev, size_t cfg )
+{
+    if ( ( snap == NULL ) || ( dev >= snap->snap.devs.size() ) )
+        return NULL;
+
+    const snapdev* pd = &snap->snap.devs[dev];
+    if ( cfg >= pd->cfgcount )
+        return NULL;
+
+    return &snap->snap.cfgs[pd->cfgfirst + cfg];
+}
+
+static const snapif* getif( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                            size_t intf )
+{
+    const snapcfg* pc = getcfg( snap, dev, cfg );
+    if ( ( pc == NULL ) || ( pc->valid == false ) || ( intf >= pc->bNumInterfaces ) )
+        return NULL;
+
+    return &snap->snap.ifs[pc->iffirst + intf];
+}
+
+static const snapalt* getalt( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                              size_t intf, size_t alt )
+{
+    const snapif* pi = getif( snap, dev, cfg, intf );
+    if ( ( pi == NULL ) || ( alt >= pi->altcount ) )
+        return NULL;
+
+    return &snap->snap.alts[pi->altfirst + alt];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void listusb_options_init( listusb_options* opt )
+{
+    if ( opt == NULL )
+        return;
+
+    memset( opt, 0, sizeof( listusb_options ) );
+    opt->jobs       = 1;
+    opt->withconfig = 1;
+}
+
+listusb_ctx* listusb_create( const listusb_options* opt )
+{
+    listusb_options defopt;
+    if ( opt == NULL )
+    {
+        listusb_options_init( &defopt );
+        opt = &defopt;
+    }
+
+    listusb_ctx* ctx = new listusb_ctx();
+
+    usbenum_defaults( &ctx->opt );
+    ctx->opt.jobs  = opt->jobs > 0 ? opt->jobs : 1;
+    ctx->opt.async = ( opt->async != 0 );
+    ctx->opt.sysfs = ( opt->sysfs != 0 );
+    ctx->opt.devtimeout = opt->devtimeout;
+    ctx->opt.deadline   = opt->deadline;
+    if ( opt->sysfsroot != NULL )
+        ctx->opt.sysfsroot = opt->sysfsroot;
+    ctx->withconfig = ( opt->withconfig != 0 );
+
+    if ( ctx->opt.sysfs == false )
+    {
+        int usberr = 0;
+#if (LIBUSB_NANO>11780)
+        libusb_init_option lusbopt[1];
+        lusbopt[0].option = LIBUSB_OPTION_LOG_LEVEL;
+        lusbopt[0].value.ival = 0;
+        usberr = libusb_init_context( &ctx->usbctx, lusbopt, 1 );
+#else
+        usberr = libusb_init( &ctx->usbctx );
+#endif
+        if ( usberr != LIBUSB_SUCCESS )
+        {
+            delete ctx;
+            return NULL;
+        }
+
+        if ( opt->cache != 0 )
+            ctx->opt.cache = usbcache_open( opt->cachefile );
+    }
+
+    return ctx;
+}
+
+void listusb_destroy( listusb_ctx* ctx )
+{
+    if ( ctx == NULL )
+        return;
+
+    usbcache_close( ctx->opt.cache );
+
+    if ( ctx->usbctx != NULL )
+        libusb_exit( ctx->usbctx );
+
+    delete ctx;
+}
+
+listusb_snapshot* listusb_enumerate( listusb_ctx* ctx )
+{
+    if ( ctx == NULL )
+        return NULL;
+
+    usbfetchlist ufl;
+    int          listerr = 0;
+
+    // cache handle and libusb event handling are not shared by threads.
+    {
+        lock_guard< mutex > guard( ctx->lock );
+        usbenum_fetchdevs( ctx->usbctx, &ctx->opt, ufl, ctx->withconfig, &listerr );
+    }
+
+    // failed device list is not an empty bus.
+    if ( listerr != 0 )
+    {
+        usbenum_free( ufl );
+        return NULL;
+    }
+
+    listusb_snapshot* snap = new listusb_snapshot();
+
+    usbsnap_build( snap->snap, ufl );
+    usbenum_free( ufl );
+
+    return snap;
+}
+
+listusb_snapshot* listusb_load( const char* path )
+{
+    if ( path == NULL )
+        return NULL;
+
+    listusb_snapshot* snap = new listusb_snapshot();
+
+    if ( usbdump_read( path, snap->snap ) == false )
+    {
+        delete snap;
+        return NULL;
+    }
+
+    return snap;
+}
+
+int listusb_dump( const listusb_snapshot* snap, const char* path )
+{
+    if ( ( snap == NULL ) || ( path == NULL ) )
+        return LISTUSB_ERR_PARAM;
+
+    if ( usbdump_write( path, &snap->snap ) == false )
+        return LISTUSB_ERR_IO;
+
+    return LISTUSB_OK;
+}
+
+void listusb_free( listusb_snapshot* snap )
+{
+    delete snap;
+}
+
+size_t listusb_count( const listusb_snapshot* snap )
+{
+    if ( snap == NULL )
+        return 0;
+
+    return snap->snap.devs.size();
+}
+
+int listusb_get_device( const listusb_snapshot* snap, size_t dev, listusb_device* out )
+{
+    if ( ( snap == NULL ) || ( out == NULL ) )
+        return LISTUSB_ERR_PARAM;
+
+    if ( dev >= snap->snap.devs.size() )
+        return LISTUSB_ERR_RANGE;
+
+    const usbsnapshot* ps = &snap->snap;
+    const snapdev* pd = &ps->devs[dev];
+
+    memset( out, 0, sizeof( listusb_device ) );
+    out->descerr = pd->descerr;
+    out->opened  = pd->opened ? 1 : 0;
+    out->timedout = pd->timedout ? 1 : 0;
+    out->bus     = pd->bus;
+    out->port    = pd->port;
+    out->devnum  = pd->devnum;
+    out->depth   = pd->depth;
+    memcpy( out->portpath, pd->portpath, MAX_PORTDEPTH );
+    out->bcdUSB             = pd->desc.bcdUSB;
+    out->bDeviceClass       = pd->desc.bDeviceClass;
+    out->bDeviceSubClass    = pd->desc.bDeviceSubClass;
+    out->bDeviceProtocol    = pd->desc.bDeviceProtocol;
+    out->bMaxPacketSize0    = pd->desc.bMaxPacketSize0;
+    out->idVendor           = pd->desc.idVendor;
+    out->idProduct          = pd->desc.idProduct;
+    out->bcdDevice          = pd->desc.bcdDevice;
+    out->bNumConfigurations = pd->desc.bNumConfigurations;
+    out->configs            = pd->cfgcount;
+    out->manufacturer = usbsnap_str( ps, pd->manufacturer );
+    out->product      = usbsnap_str( ps, pd->product );
+    out->serialnumber = usbsnap_str( ps, pd->serialnumber );
+
+    return LISTUSB_OK;
+}
+
+int listusb_get_config( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                        listusb_config* out )
+{
+    if ( out == NULL )
+        return LISTUSB_ERR_PARAM;
+
+    const snapcfg* pc = getcfg( snap, dev, cfg );
+    if ( pc == NULL )
+        return LISTUSB_ERR_RANGE;
+
+    memset( out, 0, sizeof( listusb_config ) );
+    out->valid               = pc->valid ? 1 : 0;
+    out->bNumInterfaces      = pc->bNumInterfaces;
+    out->bConfigurationValue = pc->bConfigurationValue;
+    out->MaxPower            = pc->MaxPower;
+    out->name                = usbsnap_str( &snap->snap, pc->cfgstr );
+
+    return LISTUSB_OK;
+}
+
+size_t listusb_altsettings( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                            size_t intf )
+{
+    const snapif* pi = getif( snap, dev, cfg, intf );
+    if ( pi == NULL )
+        return 0;
+
+    return pi->altcount;
+}
+
+int listusb_get_altsetting( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                            size_t intf, size_t alt, listusb_altsetting* out )
+{
+    if ( out == NULL )
+        return LISTUSB_ERR_PARAM;
+
+    const snapalt* pa = getalt( snap, dev, cfg, intf, alt );
+    if ( pa == NULL )
+        return LISTUSB_ERR_RANGE;
+
+    out->bInterfaceNumber   = pa->bInterfaceNumber;
+    out->bAlternateSetting  = pa->bAlternateSetting;
+    out->bInterfaceClass    = pa->bInterfaceClass;
+    out->bInterfaceSubClass = pa->bInterfaceSubClass;
+    out->bInterfaceProtocol = pa->bInterfaceProtocol;
+    out->bNumEndpoints      = pa->bNumEndpoints;
+
+    return LISTUSB_OK;
+}
+
+int listusb_get_endpoint( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                          size_t intf, size_t alt, size_t ep,
+                          listusb_endpoint* out )
+{
+    if ( out == NULL )
+        return LISTUSB_ERR_PARAM;
+
+    const snapalt* pa = getalt( snap, dev, cfg, intf, alt );
+    if ( ( pa == NULL ) || ( ep >= pa->bNumEndpoints ) )
+        return LISTUSB_ERR_RANGE;
+
+    const snapep* pe = &snap->snap.eps[pa->epfirst + ep];
+
+    out->bEndpointAddress = pe->bEndpointAddress;
+    out->bmAttributes     = pe->bmAttributes;
+    out->wMaxPacketSize   = pe->wMaxPacketSize;
+    out->bInterval        = pe->bInterval;
+
+    return LISTUSB_OK;
+}
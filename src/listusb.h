@@ -0,0 +1,127 @@
+#ifndef __LISTUSB_H__
+#define __LISTUSB_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// liblistusb, C interface of listusb enumeration.
+//
+// A context keeps libusb session and string cache alive between calls,
+// listusb_enumerate() returns an owned snapshot which holds no libusb
+// object and must be released by listusb_free(). Enumerations of one
+// context are serialized, different contexts run in parallel. Reading
+// a snapshot never modifies it, so it may be shared among threads.
+//
+// build : make lib ( bin/liblistusb.a, bin/liblistusb.so )
+// link  : -llistusb -lusb-1.0, with -lstdc++ -lpthread for static one.
+
+#define LISTUSB_API_VERSION     1
+
+#define LISTUSB_OK              0
+#define LISTUSB_ERR_PARAM       -1
+#define LISTUSB_ERR_RANGE       -2
+#define LISTUSB_ERR_IO          -3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef __cplusplus
+extern "C" {
+#endif /// of __cplusplus
+
+typedef struct _listusb_options {
+    unsigned        jobs;           /// parallel device readers, 0 or 1 for serial.
+    int             async;          /// read strings by asynchronous transfers.
+    int             sysfs;          /// read linux sysfs, not opening devices.
+    const char*     sysfsroot;      /// NULL for /sys/bus/usb/devices.
+    int             cache;          /// keep device strings in cache file.
+    const char*     cachefile;      /// NULL for default cache file.
+    int             withconfig;     /// read config descriptors.
+    unsigned        devtimeout;     /// ms of each device, 0 for libusb default.
+    unsigned        deadline;       /// ms of each enumeration, 0 for none.
+}listusb_options;
+
+// strings are owned by snapshot, never NULL.
+typedef struct _listusb_device {
+    int             descerr;        /// libusb error of device descriptor.
+    int             opened;
+    int             timedout;       /// strings abandoned by time budget.
+    uint8_t         bus;
+    uint8_t         port;
+    uint8_t         devnum;
+    uint8_t         depth;          /// number of valid portpath.
+    uint8_t         portpath[7];
+    uint16_t        bcdUSB;
+    uint8_t         bDeviceClass;
+    uint8_t         bDeviceSubClass;
+    uint8_t         bDeviceProtocol;
+    uint8_t         bMaxPacketSize0;
+    uint16_t        idVendor;
+    uint16_t        idProduct;
+    uint16_t        bcdDevice;
+    uint8_t         bNumConfigurations;
+    size_t          configs;        /// configs in snapshot, 0 without withconfig.
+    const char*     manufacturer;
+    const char*     product;
+    const char*     serialnumber;
+}listusb_device;
+
+typedef struct _listusb_config {
+    int             valid;          /// 0 when descriptor was not read.
+    uint8_t         bNumInterfaces;
+    uint8_t         bConfigurationValue;
+    uint8_t         MaxPower;
+    const char*     name;
+}listusb_config;
+
+typedef struct _listusb_altsetting {
+    uint8_t         bInterfaceNumber;
+    uint8_t         bAlternateSetting;
+    uint8_t         bInterfaceClass;
+    uint8_t         bInterfaceSubClass;
+    uint8_t         bInterfaceProtocol;
+    uint8_t         bNumEndpoints;
+}listusb_altsetting;
+
+typedef struct _listusb_endpoint {
+    uint8_t         bEndpointAddress;
+    uint8_t         bmAttributes;
+    uint16_t        wMaxPacketSize;
+    uint8_t         bInterval;
+}listusb_endpoint;
+
+typedef struct _listusb_ctx         listusb_ctx;
+typedef struct _listusb_snapshot    listusb_snapshot;
+
+void                listusb_options_init( listusb_options* opt );
+
+// NULL when libusb cannot be initialized.
+listusb_ctx*        listusb_create( const listusb_options* opt );
+void                listusb_destroy( listusb_ctx* ctx );
+
+// NULL on error, as device list or sysfs not read, no device is not
+// an error.
+listusb_snapshot*   listusb_enumerate( listusb_ctx* ctx );
+listusb_snapshot*   listusb_load( const char* path );
+int                 listusb_dump( const listusb_snapshot* snap, const char* path );
+void                listusb_free( listusb_snapshot* snap );
+
+size_t  listusb_count( const listusb_snapshot* snap );
+int     listusb_get_device( const listusb_snapshot* snap, size_t dev,
+                            listusb_device* out );
+int     listusb_get_config( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                            listusb_config* out );
+size_t  listusb_altsettings( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                             size_t intf );
+int     listusb_get_altsetting( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                                size_t intf, size_t alt, listusb_altsetting* out );
+int     listusb_get_endpoint( const listusb_snapshot* snap, size_t dev, size_t cfg,
+                              size_t intf, size_t alt, size_t ep,
+                              listusb_endpoint* out );
+
+#ifdef __cplusplus
+}
+#endif /// of __cplusplus
+
+#endif /// of __LISTUSB_H__
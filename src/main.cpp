@@ -10,9 +10,23 @@
 #include <cstdint>
 #include <cerrno>
 #include <cctype>
+#include <csignal>
 #include <vector>
 
 #include "resource.h"
+#include "outbuf.h"
+#include "usbfetch.h"
+#include "usbenum.h"
+#include "usbsnap.h"
+#include "usbrender.h"
+#include "usbformat.h"
+#include "usbdump.h"
+#include "usbmock.h"
+#include "usbstats.h"
+#include "usbdaemon.h"
+#include "usbprom.h"
+#include "usbaudit.h"
+#include "usbbudget.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -23,31 +37,39 @@ using namespace std;
 #define ME_STR              "listusb"
 #define VERSION_STR         APP_VERSION_STR
 
-#define SLEN_MANUFACTURER   128
-#define SLEN_PRODUCT        128
-#define SLEN_SN             64
-#define SLEN_CLASS          64
+// long options only, out of char range.
+#define OPT_SYSFS           0x100
+#define OPT_SYSFSROOT       0x101
+#define OPT_CACHE           0x102
+#define OPT_FORMAT          0x103
+#define OPT_DUMP            0x104
+#define OPT_LOAD            0x105
+#define OPT_DEVTIMEOUT      0x106
+#define OPT_DEADLINE        0x107
+#define OPT_FIELDS          0x108
+#define OPT_VID             0x109
+#define OPT_PID             0x10A
+#define OPT_BUS             0x10B
+#define OPT_PORTPATH        0x10C
+#define OPT_CLASS           0x10D
+#define OPT_EXISTS          0x10E
+#define OPT_STATS           0x10F
+#define OPT_DAEMON          0x110
+#define OPT_FROMDAEMON      0x111
+#define OPT_PROMETHEUS      0x112
+#define OPT_INTERVAL        0x113
+#define OPT_SPEEDAUDIT      0x114
+#define OPT_BANDWIDTH       0x115
+
+#define DAEMON_NAME         "listusbd"
+#define SOCKPATH_MAX        108
 
 ////////////////////////////////////////////////////////////////////////////////
 
-typedef struct _usbdevinfo {
-    uint8_t     port;
-    uint16_t    vid;
-    uint16_t    pid;
-    uint16_t    bcd;
-    uint16_t    clsID[2];
-    char        manufacturer[SLEN_MANUFACTURER];
-    char        product[SLEN_PRODUCT];
-    char        serialnumber[SLEN_SN];
-    char        classname[SLEN_CLASS];
-}usbdevdevinfo;
-
-typedef struct _usbdevbusinfo {
-    uint8_t                     bus;
-    vector< usbdevdevinfo* >    device;
-}usbdevbusinfo;
-
-typedef vector< usbdevbusinfo* >  usbdevtree;
+typedef struct _usbwatchevt {
+    libusb_device*          device;
+    libusb_hotplug_event    event;
+}usbwatchevt;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -58,6 +80,32 @@ static struct option long_opts[] = {
     { "version",        no_argument,        0, 'v' },
     { "color",          no_argument,        0, 'c' },
     { "lessinfo",       no_argument,        0, 'L' },
+    { "tree",           no_argument,        0, 't' },
+    { "jobs",           required_argument,  0, 'j' },
+    { "async",          no_argument,        0, 'a' },
+    { "sysfs",          no_argument,        0, OPT_SYSFS },
+    { "sysfs-root",     required_argument,  0, OPT_SYSFSROOT },
+    { "cache",          optional_argument,  0, OPT_CACHE },
+    { "watch",          no_argument,        0, 'w' },
+    { "format",         required_argument,  0, OPT_FORMAT },
+    { "dump",           required_argument,  0, OPT_DUMP },
+    { "load",           required_argument,  0, OPT_LOAD },
+    { "device-timeout", required_argument,  0, OPT_DEVTIMEOUT },
+    { "deadline",       required_argument,  0, OPT_DEADLINE },
+    { "fields",         required_argument,  0, OPT_FIELDS },
+    { "vid",            required_argument,  0, OPT_VID },
+    { "pid",            required_argument,  0, OPT_PID },
+    { "bus",            required_argument,  0, OPT_BUS },
+    { "port-path",      required_argument,  0, OPT_PORTPATH },
+    { "class",          required_argument,  0, OPT_CLASS },
+    { "exists",         no_argument,        0, OPT_EXISTS },
+    { "stats",          optional_argument,  0, OPT_STATS },
+    { "daemon",         optional_argument,  0, OPT_DAEMON },
+    { "from-daemon",    optional_argument,  0, OPT_FROMDAEMON },
+    { "prometheus",     required_argument,  0, OPT_PROMETHEUS },
+    { "interval",       required_argument,  0, OPT_INTERVAL },
+    { "speed-audit",    no_argument,        0, OPT_SPEEDAUDIT },
+    { "bandwidth",      no_argument,        0, OPT_BANDWIDTH },
     { NULL, 0, 0, 0 }
 };
 
@@ -66,1422 +114,461 @@ static uint32_t         optpar_simple       = 0;
 static uint32_t         optpar_color        = 0;
 static uint32_t         optpar_lessinfo     = 0;
 static uint32_t         optpar_treeview     = 0;
+static uint32_t         optpar_cache        = 0;
+static uint32_t         optpar_watch        = 0;
+static uint32_t         optpar_exists       = 0;
+static uint32_t         optpar_stats        = 0;
+static uint32_t         optpar_statsjson    = 0;
+static int              optpar_format       = USBFORMAT_TEXT;
+static const char*      optpar_dumpfile     = NULL;
+static const char*      optpar_loadfile     = NULL;
+static uint32_t         optpar_daemon       = 0;
+static uint32_t         optpar_fromdaemon   = 0;
+static char             optpar_sockpath[SOCKPATH_MAX] = {0};
+static const char*      optpar_promfile     = NULL;
+static unsigned         optpar_interval     = 60;
+static uint32_t         optpar_speedaudit   = 0;
+static uint32_t         optpar_bandwidth    = 0;
+static int              retcode             = 0;
+static const char*      optpar_cachefile    = NULL;
+static const char*      optpar_fields       = NULL;
+static usbfields        fields;
+static usbfilter        filter;
 static libusb_context*  libusbctx           = NULL;
-static usbdevtree       usbtree;
+static usbmock*         mockusb             = NULL;
+static libusb_context*  enumctx             = NULL;  /// libusbctx or of mockusb.
+static usbenumopt       enumopt;
+static const usbrenderer*   render          = NULL;
+static vector< usbwatchevt >    watchevts;
+static usbfetchlist             watchknown;
+static volatile sig_atomic_t    watchquit = 0;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void trimStrInner( char *str )
+// devices from snapshot file or listusbd, not enumerated by this process.
+static bool fromsnapshot()
 {
-    char*  spt = str;
-    size_t len = strlen(str);
-    size_t lsz = len;
-
-    if ( len > 0 )
-    {
-        while( isspace(str[len - 1]) ) --len;
-        while( *str && isspace(*str) ) ++str, --len;
-
-        char* tmps = strdup( str );
-        memset( spt, 0, lsz );
-        memcpy( spt, tmps, len );
-        free( tmps );
-    }
+    return ( optpar_loadfile != NULL ) || ( optpar_fromdaemon > 0 );
 }
 
-void alloc_append_portdev( usbdevtree* udt, size_t bi, size_t l )
+size_t snapdevs( usbsnapshot& snap, bool withconfig )
 {
-    if ( ( udt != NULL ) && ( l > 0 ) && ( bi < udt->size() ) )
+    if ( optpar_fromdaemon > 0 )
     {
-        for( size_t cnt=0; cnt<l; cnt++ )
+        if ( usbdaemon_fetch( optpar_sockpath, snap ) == false )
         {
-            usbdevdevinfo* ni = new usbdevdevinfo;
-            if ( ni != NULL )
-            {
-                memset( ni, 0, sizeof( usbdevdevinfo ) );
-                udt->at(bi)->device.push_back( ni );
-            }
+            fprintf( stderr, "cannot get snapshot from %s at %s\n",
+                     DAEMON_NAME, optpar_sockpath );
+            retcode = -1;
         }
     }
-}
-
-void alloc_append_businfo( usbdevtree* udt = NULL, size_t l = 0 )
-{
-    if ( ( udt != NULL ) && ( l > 0 ) )
+    else
+    if ( optpar_loadfile != NULL )
     {
-        for( size_t cnt=0; cnt<l; cnt++ )
+        if ( usbdump_read( optpar_loadfile, snap ) == false )
         {
-            usbdevbusinfo* ni = new usbdevbusinfo;
-            if ( ni != NULL )
-            {
-                memset( ni, 0, sizeof( usbdevbusinfo ) );
-                udt->push_back( ni );
-            }
+            fprintf( stderr, "cannot load snapshot from %s\n", optpar_loadfile );
+            retcode = -1;
         }
     }
-}
 
-void free_portdev( usbdevtree& udt )
-{
-    if ( udt.size() > 0 )
+    if ( fromsnapshot() == true )
     {
-        for( size_t cnt=0; cnt<udt.size(); cnt++ )
+        // configs of dropped devices stay in snapshot, just not referred.
+        size_t kept = 0;
+        for ( size_t cnt=0; cnt<snap.devs.size(); cnt++ )
         {
-            if ( udt[cnt]->device.size() > 0 )
-            {
-                for( size_t itr=0; itr< udt[cnt]->device.size(); itr++ )
-                {
-                    usbdevdevinfo* prm = udt[cnt]->device[itr];
-                    delete prm;
-                    udt[cnt]->device[itr] = NULL;
-                }
-
-                udt[cnt]->device.clear();
-            }
-
-            usbdevbusinfo* prm = udt[cnt];
-            delete prm;
-            udt[cnt] = NULL;
+            if ( usbfilter_snapdev( enumopt.filter, &snap, cnt ) == true )
+                snap.devs[kept++] = snap.devs[cnt];
         }
+        snap.devs.resize( kept );
+
+        return snap.devs.size();
     }
 
-    udt.clear();
-}
+    // dumped file should be able to render any view.
+    if ( optpar_dumpfile != NULL )
+        withconfig = true;
 
-void prtUSBclass( uint8_t id, uint8_t subid, bool simpleovr = false )
-{
-    if ( optpar_color > 0 )
+    usbfetchlist ufl;
+    int          listerr = 0;
+    usbenum_fetchdevs( enumctx, &enumopt, ufl, withconfig, &listerr );
+    usbsnap_build( snap, ufl );
+    usbenum_free( ufl );
+
+    if ( listerr != 0 )
     {
-        printf( "\033[94m" );
+        fprintf( stderr, "cannot get device list, %s\n", libusb_error_name( listerr ) );
+        retcode = -1;
     }
 
-    if ( simpleovr == false )
+    if ( optpar_dumpfile != NULL )
     {
-        if ( optpar_simple == 0 )
-        {
-            printf( "Class = " );
-        }
-        else
-        {
-            printf( "cls=" );
-        }
-        
-        if ( optpar_color > 0 )
+        if ( usbdump_write( optpar_dumpfile, &snap ) == false )
         {
-            printf( "\033[93m" );
+            fprintf( stderr, "cannot write snapshot to %s\n", optpar_dumpfile );
+            retcode = -1;
         }
     }
-    else
-    {
-        if ( optpar_color > 0 )
-        {
-            printf( "\033[31m" );
-        }        
-    }
-
-    switch( id )
-    {
-        case LIBUSB_CLASS_PER_INTERFACE:
-            if ( ( subid > 0 ) && ( optpar_simple == 0 ) )
-            {
-                printf( "PER interface %02X device.\n", subid );
-            }
-            else
-            {
-                printf( "PER/%02X;", subid );
-            }
-            break;
-
-        case LIBUSB_CLASS_AUDIO:
-            if ( optpar_simple == 0 )
-                printf( "audio device" );
-            else
-                printf( "audio;" );
-            break;
-
-        case LIBUSB_CLASS_COMM:
-            if ( optpar_simple == 0 )
-                printf( "communicating device" );
-            else
-                printf( "communicating;" );
-            break;
 
-        case LIBUSB_CLASS_HID:
-            if ( optpar_simple == 0 )
-                printf( "Human Interface Device" );
-            else
-                printf( "HID;" );
-            break;
-
-        case LIBUSB_CLASS_PHYSICAL:
-            if ( optpar_simple == 0 )
-                printf( "Physical device" );
-            else
-                printf( "physical;" );
-            break;
-
-        case LIBUSB_CLASS_IMAGE:
-            if ( optpar_simple == 0 )
-                printf( "Imaging device" );
-            else
-                printf( "image;" );
-            break;
-
-        case LIBUSB_CLASS_PRINTER:
-            if ( optpar_simple == 0 )
-                printf( "Printing device" );
-            else
-                printf( "printer;" );
-            break;
-
-        case LIBUSB_CLASS_MASS_STORAGE:
-            if ( optpar_simple == 0 )
-                printf( "Mass storage device" );
-            else
-                printf( "mass_storage;" );
-            break;
-
-        case LIBUSB_CLASS_HUB:
-            if ( optpar_simple == 0 )
-                printf( "HUB device" );
-            else
-                printf( "HUB;" );
-            break;
-
-        case LIBUSB_CLASS_DATA:
-            if ( optpar_simple == 0 )
-                printf( "Data device" );
-            else
-                printf( "data;" );
-            break;
-
-        case LIBUSB_CLASS_SMART_CARD:
-            if ( optpar_simple == 0 )
-                printf( "Smart Card device" );
-            else
-                printf( "smartcard;" );
-            break;
-
-        case LIBUSB_CLASS_CONTENT_SECURITY:
-            if ( optpar_simple == 0 )
-                printf( "Content Security device" );
-            else
-                printf( "content_security;" );
-            break;
-
-        case LIBUSB_CLASS_VIDEO:
-            if ( optpar_simple == 0 )
-                printf( "Video device" );
-            else
-                printf( "video;" );
-            break;
-
-        case LIBUSB_CLASS_PERSONAL_HEALTHCARE:
-            if ( optpar_simple == 0 )
-                printf( "Personal Healthcare device" );
-            else
-                printf( "personal_healthcare;" );
-            break;
-
-        case LIBUSB_CLASS_DIAGNOSTIC_DEVICE:
-            if ( optpar_simple == 0 )
-                printf( "Diagnositc device" );
-            else
-                printf( "diagnostic;" );
-            break;
-
-        case LIBUSB_CLASS_WIRELESS:
-            if ( optpar_simple == 0 )
-                printf( "Wireless device" );
-            else
-                printf( "wireless;" );
-            break;
-
-        case LIBUSB_CLASS_MISCELLANEOUS:
-            if ( optpar_simple == 0 )
-                printf( "Miscellaneous device" );
-            else
-                printf( "misc.;" );
-            break;
-
-        case LIBUSB_CLASS_APPLICATION:
-            if ( optpar_simple == 0 )
-                printf( "Application device" );
-            else
-                printf( "application;" );
-            break;
-
-        case LIBUSB_CLASS_VENDOR_SPEC:
-            if ( optpar_simple == 0 )
-                printf( "Vendor-Specific device" );
-            else
-                printf( "vendor-spec;" );
-            break;
-
-        default:
-            if ( optpar_simple == 0 )
-                printf( "Unknown %02X class type device", id );
-            else
-                printf( "%02X;", id );
-            break;
-    }
-
-    if ( optpar_color > 0 )
-    {
-        printf( "\033[0m" );
-    }
-
-    if ( ( optpar_simple == 0 ) && ( simpleovr == false ) )
-        printf( "\n" );
+    return snap.devs.size();
 }
 
-void putUSBClass( usbdevdevinfo* pudi = NULL, uint8_t id = 0, uint8_t subid = 0 )
+size_t listdevs()
 {
-    if ( pudi != NULL )
-    {
-        pudi->clsID[0] = id;
-        pudi->clsID[1] = subid;
+    usbsnapshot snap;
+    size_t devscnt = snapdevs( snap, true );
 
-        switch( id )
+    if ( devscnt > 0 )
+    {
+        if ( ( optpar_simple > 0 ) && ( optpar_reftbl > 0 ) )
         {
-            case LIBUSB_CLASS_PER_INTERFACE:
-                snprintf( pudi->classname, SLEN_CLASS, "PER" );
-                break;
-
-            case LIBUSB_CLASS_AUDIO:
-                snprintf( pudi->classname, SLEN_CLASS, "AUD." );
-                break;
-
-            case LIBUSB_CLASS_COMM:
-                snprintf( pudi->classname, SLEN_CLASS, "COM." );
-                break;
-
-            case LIBUSB_CLASS_HID:
-                snprintf( pudi->classname, SLEN_CLASS, "HID" );
-                break;
-
-            case LIBUSB_CLASS_PHYSICAL:
-                snprintf( pudi->classname, SLEN_CLASS, "PHY." );
-                break;
-
-            case LIBUSB_CLASS_IMAGE:
-                snprintf( pudi->classname, SLEN_CLASS, "IMG." );
-                break;
-
-            case LIBUSB_CLASS_PRINTER:
-                snprintf( pudi->classname, SLEN_CLASS, "PRT." );
-                break;
-
-            case LIBUSB_CLASS_MASS_STORAGE:
-                snprintf( pudi->classname, SLEN_CLASS, "MSD." );
-                break;
-
-            case LIBUSB_CLASS_HUB:
-                snprintf( pudi->classname, SLEN_CLASS, "HUB" );
-                break;
-
-            case LIBUSB_CLASS_DATA:
-                snprintf( pudi->classname, SLEN_CLASS, "DAT." );
-                break;
-
-            case LIBUSB_CLASS_SMART_CARD:
-                snprintf( pudi->classname, SLEN_CLASS, "SCD." );
-                break;
-
-            case LIBUSB_CLASS_CONTENT_SECURITY:
-                snprintf( pudi->classname, SLEN_CLASS, "CSD." );
-                break;
-
-            case LIBUSB_CLASS_VIDEO:
-                snprintf( pudi->classname, SLEN_CLASS, "VID." );
-                break;
-
-            case LIBUSB_CLASS_PERSONAL_HEALTHCARE:
-                snprintf( pudi->classname, SLEN_CLASS, "PHD." );
-                break;
-
-            case LIBUSB_CLASS_DIAGNOSTIC_DEVICE:
-                snprintf( pudi->classname, SLEN_CLASS, "DIA." );
-                break;
-
-            case LIBUSB_CLASS_WIRELESS:
-                snprintf( pudi->classname, SLEN_CLASS, "WLS." );
-                break;
-
-            case LIBUSB_CLASS_MISCELLANEOUS:
-                snprintf( pudi->classname, SLEN_CLASS, "MISC." );
-                break;
-
-            case LIBUSB_CLASS_APPLICATION:
-                snprintf( pudi->classname, SLEN_CLASS, "APP." );
-                break;
-
-            case LIBUSB_CLASS_VENDOR_SPEC:
-                snprintf( pudi->classname, SLEN_CLASS, "VSC" );
-                break;
+            render->reftable();
+        }
 
-            default:
-                snprintf( pudi->classname, SLEN_CLASS, "%04X", id );
-                break;
+        for ( size_t cnt = 0; cnt<snap.devs.size(); cnt++ )
+        {
+            render->device( &snap, cnt );
         }
     }
+
+    return devscnt;
 }
 
-const char* bcd2human( uint16_t id )
+size_t treelistdevs()
 {
-    static char retstr[32] = {0};
-
-    uint8_t hv = id >> 8;
-    uint8_t lv = ( id & 0x00F0 ) >> 4;
+    usbsnapshot snap;
+    size_t devscnt = snapdevs( snap, false );
 
-    if ( optpar_simple == 0 )
-    {
-        if ( optpar_color > 0 )
-        {
-            snprintf( retstr, 32, "\033[93mUSB \033[91m%u.%u", hv, lv );
-        }
-        else
-        {
-            snprintf( retstr, 32, "USB %u.%u", hv, lv );
-        }
-    }
-    else
+    if ( devscnt > 0 )
     {
-        if ( optpar_color > 0 )
+        usbtree tree;
+        usbtree_init( tree );
+
+        for ( size_t cnt = 0; cnt<snap.devs.size(); cnt++ )
         {
-            snprintf( retstr, 32, "\033[91m%u.%u", hv, lv );
+            usbtree_add( tree, &snap, cnt );
         }
-        else
+
+        usbtree_link( tree );
+
+        for ( const usbtreebus* pb = tree.first; pb != NULL; pb = pb->next )
         {
-            snprintf( retstr, 32, "%u.%u", hv, lv );
+            render->treebus( pb->bus, pb->devs );
+
+            for ( const usbtreedev* pn = pb->first; pn != NULL; pn = usbtree_walk( pn ) )
+            {
+                render->treedev( pn );
+            }
         }
+
+        usbtree_free( tree );
     }
 
-    return retstr;
+    return devscnt;
 }
 
-void prtEndPoint( uint8_t bits )
+// no output, only exit code tells a device was matched.
+size_t existdevs()
 {
-    printf( "%02X (", bits );
-
-    if ( optpar_color > 0 )
-    {
-        printf( "\033[31m" );
-    }
-
-    printf( " " );
+    size_t devscnt = 0;
 
-    uint8_t testbit = bits & LIBUSB_TRANSFER_TYPE_MASK;
-    
-    if ( ( testbit & LIBUSB_ENDPOINT_TRANSFER_TYPE_CONTROL ) > 0 )
-    {
-        printf ( "Control, " );
-    }
-    
-    if ( ( testbit & LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS  ) > 0 )
-    {
-        printf( "Isochronous, " );
-    }
-    
-    if ( ( testbit & LIBUSB_ENDPOINT_TRANSFER_TYPE_BULK  ) > 0 )
-    {
-        printf( "Bulk, " );
-    }
-    
-    if ( ( testbit & LIBUSB_ENDPOINT_TRANSFER_TYPE_INTERRUPT ) > 0 )
-    {
-        printf( "Interrupt, " );
-    }
-    
-    testbit = bits & LIBUSB_ISO_SYNC_TYPE_MASK;
-    
-    if ( ( testbit & LIBUSB_ISO_SYNC_TYPE_NONE  ) > 0 )
-    {
-        printf( "No-Sync, " );
-    }
-    
-    if ( ( testbit & LIBUSB_ISO_SYNC_TYPE_ASYNC ) > 0 )
-    {
-        printf( "Asynchronous, " );
-    }
-    
-    if ( ( testbit & LIBUSB_ISO_SYNC_TYPE_ADAPTIVE  ) > 0 )
-    {
-        printf( "Adaptive, " );
-    }
-    
-    if ( ( testbit & LIBUSB_ISO_SYNC_TYPE_SYNC  ) > 0 )
+    if ( fromsnapshot() == true )
     {
-        printf( "Synchronous, " );
+        usbsnapshot snap;
+        devscnt = snapdevs( snap, true );
     }
-    
-    testbit = bits & LIBUSB_ISO_USAGE_TYPE_MASK;
-    
-    if ( ( testbit & LIBUSB_ISO_USAGE_TYPE_DATA  ) > 0 )
+    else
     {
-        printf( "Data, ");
-    }
+        usbfetchlist ufl;
 
-    if ( ( testbit & LIBUSB_ISO_USAGE_TYPE_FEEDBACK ) > 0 )
-    {
-        printf( "Feedback , ");
-    }
+        enumopt.strings  = false;
+        enumopt.maxmatch = 1;
 
-    if ( ( testbit & LIBUSB_ISO_USAGE_TYPE_IMPLICIT ) > 0 )
-    {
-        printf( "Implicit feedback Data, ");
+        devscnt = usbenum_fetchdevs( enumctx, &enumopt, ufl,
+                                     ( filter.flags & USBFILTER_CLASS ) != 0 );
+        usbenum_free( ufl );
     }
 
-    if ( optpar_color > 0 )
-    {
-        printf( "\033[92m" );
-    }
-    
-    printf( ")" );
+    if ( retcode == 0 )
+        retcode = devscnt > 0 ? 0 : 1;
+
+    return devscnt;
 }
 
-void prtUSBConfig( libusb_device* device, libusb_device_handle* dev, uint8_t idx, uint16_t bcd, libusb_config_descriptor* cfg )
+size_t fielddevs()
 {
-    if ( cfg != NULL )
-    {
-        uint8_t cfgstr[64] = {0};
+    usbsnapshot snap;
 
-        if ( cfg->bDescriptorType == LIBUSB_DT_STRING )
-        {
-            libusb_get_string_descriptor_ascii( dev,
-                                                cfg->iConfiguration,
-                                                cfgstr, 64 );
-        }
+    // only what selected fields need, snapshot file keeps everything.
+    if ( optpar_dumpfile == NULL )
+        enumopt.strings = ( ( fields.needs & USBFIELD_NEEDSTR ) != 0 );
 
-        if ( optpar_color > 0 )
-        {
-            printf( "\033[93m" );
-        }
+    size_t devscnt = snapdevs( snap, ( fields.needs & USBFIELD_NEEDCFG ) != 0 );
 
-        if ( optpar_simple == 0 )
-            printf( "    + ");
+    usbformat_project( optpar_format, &snap, &fields );
 
-        if ( strlen( (const char*)cfgstr ) > 0 )
-        {
-            if ( optpar_simple == 0 )
-            {
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[94m" );
-                }
+    return devscnt;
+}
 
-                printf( "config[" );
+size_t formatdevs()
+{
+    usbsnapshot snap;
+    size_t devscnt = snapdevs( snap, true );
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[95m" );
-                }
+    usbformat_write( optpar_format, &snap );
 
-                printf( "%2u", idx );
+    return devscnt;
+}
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[94m" );
-                }
+// negotiated speed against BOS, exit 1 when any device runs below.
+size_t auditdevs()
+{
+    usbsnapshot snap;
 
-                printf( "] " );
+    enumopt.bos = true;
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[0m" );
-                }
+    size_t devscnt = snapdevs( snap, false );
+    size_t below = usbaudit_speed( &snap, optpar_color > 0 );
 
-                printf( " : " );
+    if ( ( retcode == 0 ) && ( below > 0 ) )
+        retcode = 1;
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[93m" );
-                }
+    return devscnt;
+}
 
-                printf( "%s, ", (const char*)cfgstr );
-            }
-        }
-        else
-        if ( optpar_simple == 0 )
-        {
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[94m" );
-            }
+// periodic bus time of active alternate settings, exit 1 when over limit.
+size_t budgetdevs()
+{
+    usbsnapshot snap;
 
-            printf( "config[" );
+    enumopt.active = true;
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[95m" );
-            }
+    size_t devscnt = snapdevs( snap, true );
+    size_t over = usbbudget_bandwidth( &snap, optpar_color > 0 );
 
-            printf( "%2u", idx );
+    if ( ( retcode == 0 ) && ( over > 0 ) )
+        retcode = 1;
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[94m" );
-            }
+    return devscnt;
+}
 
-            printf( "], ");
-        }
+static int LIBUSB_CALL watchcb( libusb_context* ctx, libusb_device* device,
+                                libusb_hotplug_event event, void* user_data )
+{
+    // no device I/O in callback, handled in watchdevs().
+    usbwatchevt evt;
+    evt.device = libusb_ref_device( device );
+    evt.event  = event;
+    watchevts.push_back( evt );
 
-        if ( optpar_simple == 0 )
-        {
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[94m" );
-            }
+    return 0;
+}
 
-            printf( "interfaces = " );
+static void watchsig( int signo )
+{
+    watchquit = 1;
+}
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[93m" );
-            }
+// writes textfile again every interval until SIGINT or SIGTERM, once
+// with zero interval. Devices stay referenced between intervals, so only
+// new ones are opened.
+size_t promdevs()
+{
+    usbfetchlist known;
+    size_t       scrapes = 0;
 
-            printf( "%u, ", cfg->bNumInterfaces );
+    signal( SIGINT, watchsig );
+    signal( SIGTERM, watchsig );
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[95m" );
-            }
+    while( watchquit == 0 )
+    {
+        uint64_t    t0 = usbstats_now();
+        usbsnapshot snap;
+        size_t      devsread = 0;
 
-            printf( "ID = " );
+        // sysfs and snapshots cost no bus traffic, read whole as usual.
+        if ( enumctx != NULL )
+        {
+            devsread = usbenum_sync( enumctx, &enumopt, known );
 
-            if ( optpar_color > 0 )
+            for ( size_t cnt=0; cnt<known.size(); cnt++ )
             {
-                printf( "\033[93m" );
+                if ( known[cnt].skipped == false )
+                    usbsnap_append( snap, &known[cnt] );
             }
-
-            printf( "0x%02X, ", cfg->bConfigurationValue );
-        }
-
-        uint32_t pwrCalc = cfg->MaxPower;
-        if ( bcd >= 0x0300 )
-        {
-            pwrCalc *= 8;
         }
         else
         {
-            pwrCalc *= 2;
+            devsread = snapdevs( snap, true );
         }
 
-        if ( optpar_color > 0 )
-        {
-            printf( "\033[94m" );
-        }
+        double scrapesec = (double)( usbstats_now() - t0 ) / 1000000.0;
 
-        if ( optpar_simple == 0 )
-            printf( "max required power = " );
-        else
-            printf( "MRP=" );
-
-        if ( optpar_color > 0 )
+        if ( usbprom_write( optpar_promfile, &snap, scrapesec, devsread ) == false )
         {
-            printf( "\033[93m" );
+            fprintf( stderr, "cannot write metrics to %s\n", optpar_promfile );
+            retcode = -1;
+            break;
         }
 
-        if ( optpar_simple == 0 )
-            printf( "%u mA\n", pwrCalc );
-        else
-            printf( "%u(mA)\n", pwrCalc );
+        scrapes++;
 
-        if ( optpar_color > 0 )
-        {
-            printf( "\033[0m" );
-        }
+        if ( optpar_interval == 0 )
+            break;
 
-        // testing interfaces ...
-        if ( optpar_lessinfo == 0 )
+        // wakes up every second to check quit.
+        for ( unsigned cnt=0; ( cnt<optpar_interval ) && ( watchquit == 0 ); cnt++ )
         {
-            if ( ( cfg->bNumInterfaces > 0 ) && ( optpar_simple == 0 ) )
-            {
-                for ( int x=0; x<cfg->bNumInterfaces; x++ )
-                {
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[97m" );
-                    }
-
-                    printf( "        - interface[" );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[96m" );
-                    }
-
-                    printf( "%d",x );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[97m" );
-                    }
-
-                    printf( "] : " );
-
-                    if ( cfg->extra_length > 0 )
-                    {
-                        printf( "%s, ", (const char*)cfg->extra );
-                    }
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[96m" );
-                    }
-
-                    printf( "alt.settings = " );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-
-                    printf( "%d",cfg->interface[x].num_altsetting );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[97m" );
-                    }
-
-                    if ( cfg->interface[x].num_altsetting > 0 )
-                    {
-                        printf( " : " );
-                        for ( size_t q=0; q<cfg->interface[x].num_altsetting; q++ )
-                        {
-                            prtUSBclass( cfg->interface[x].altsetting[q].bInterfaceClass, 
-                                         cfg->interface[x].altsetting[q].bInterfaceSubClass,
-                                         true );
-                            if ( q+1 < cfg->interface[x].num_altsetting )
-                            {
-                                printf( ", " );
-                            }
-                        }
-
-                        printf( "\n" );
-                        
-                        for( int y=0; y<cfg->interface[x].num_altsetting; y++ )
-                        {
-                            if ( optpar_color > 0 )
-                            {
-                                printf( "\033[96m" );
-                            }
-
-                            printf( "            -> ep[" );
-
-                            if ( optpar_color > 0 )
-                            {
-                                printf( "\033[95m" );
-                            }
-
-                            printf( "%d", y );
-
-                            if ( optpar_color > 0 )
-                            {
-                                printf( "\033[96m" );
-                            }
-
-
-                            printf( "]" );
-
-                            if ( optpar_color > 0 )
-                            {
-                                printf( "\033[91m" );
-                            }
-
-                            printf( "=" );
-
-                            if ( optpar_color > 0 )
-                            {
-                                printf( "\033[92m" );
-                            }
-
-                            printf( "%d", cfg->interface[x].altsetting[y].bNumEndpoints );
-
-                            if ( optpar_color > 0 )
-                            {
-                                printf( "\033[95m" );
-                            }
-
-                            printf( ":" );
-
-                            for ( int z=0; z<cfg->interface[x].altsetting[y].bNumEndpoints; z++ )
-                            {
-                                if ( optpar_color > 0 )
-                                {
-                                    printf( "\033[32m" );
-                                }
-                                
-                                if ( cfg->interface[x].altsetting[y].endpoint[z].bmAttributes > 0 )
-                                {
-                                    prtEndPoint( cfg->interface[x].altsetting[y].endpoint[z].bmAttributes );
-                                }
-                                
-                                uint8_t dirbit = cfg->interface[x].altsetting[y].endpoint[z].bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK;
-                                
-                                if ( dirbit == LIBUSB_ENDPOINT_OUT )
-                                {
-                                    printf( " EP:OUT, " );
-                                }
-                                else
-                                if ( dirbit == LIBUSB_ENDPOINT_IN )
-                                {
-                                    printf( " EP:IN, " );
-                                }
-                                
-                                if ( cfg->interface[x].altsetting[y].endpoint[z].extra_length > 0 )
-                                {
-                                    if ( optpar_color > 0 )
-                                    {
-                                        printf( "\033[33m" );
-                                    }
-
-                                    const char* pE = (const char*)cfg->interface[x].altsetting[y].endpoint[z].extra;
-
-                                    if ( ( *pE >= '0' ) && ( *pE <= '9' ) )
-                                    {
-                                        printf( "%c", *pE );
-                                    }
-                                    else
-                                    {
-                                        for ( size_t q=0; q<cfg->interface[x].altsetting[y].endpoint[z].extra_length; q++ )
-                                        {
-                                            printf( "%02X", (uint8_t)pE[q] );
-                                        }
-                                    }
-                                }
-
-                                if ( z+1 < cfg->interface[x].altsetting[y].bNumEndpoints )
-                                {
-                                    printf( "\n                       " );
-                                }
-                            }
-
-                            if( y+1 < cfg->interface[x].num_altsetting )
-                            {
-                                if ( optpar_color > 0 )
-                                {
-                                    printf( "\033[0m" );
-                                }
-                                
-                                printf( "\n" );
-                            }
-                        }
-
-                        if ( optpar_color > 0 )
-                        {
-                            printf( "\033[96m" );
-                        }
-                        
-                        printf( "\n" );
-                    }
+            sleep( 1 );
+        }
+    }
 
+    usbenum_syncfree( known );
 
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[0m" );
-                    }
-                }
-            } /// of if ( ( cfg->bNumInterfaces > 0 ) && ( optpar_simple == 0 ) )
-        } /// of if ( optpar_lessinfo == 0 )
-    }
+    return scrapes;
 }
 
-size_t listdevs()
+void prtwatchdev( usbdevfetch* pf, bool arrived )
 {
-    libusb_device_handle* dev = NULL;
-    libusb_device** listdev = NULL;
-    size_t devscnt = libusb_get_device_list( libusbctx, &listdev );
+    if ( ( pf->descerr != 0 ) || ( pf->skipped == true ) )
+        return;
 
-    if ( devscnt > 0 )
-    {
-        if ( ( optpar_simple > 0 ) && ( optpar_reftbl > 0 ) )
-        {
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[93m" );
-            }
-            printf( "BUS;" );
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[97m" );
-            }
-            printf( "Port;");
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[92m" );
-            }
-            printf( "[ PID: VID]; ");
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[91m" );
-            }
-            printf( "manufacturer; ");
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[95m" );
-            }
-            printf( "product name; " );
+    usbsnapshot snap;
+    usbsnap_append( snap, pf );
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[91m" );
-            }
-            printf( "serial No.; " );
+    render->watchmark( arrived );
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[94m" );
-            }
-            printf( "class; " );
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[93m" );
-            }
-            printf( "bcdID; " );
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[97m" );
-            }
-            printf( "MRP(mA)\n" );
-
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[0m" );
-            }
-        }
+    if ( optpar_treeview == 0 )
+    {
+        render->device( &snap, 0 );
+    }
+    else
+    {
+        usbtree tree;
+        usbtree_init( tree );
 
-        for ( size_t cnt = 0; cnt<devscnt; cnt++ )
+        const usbtreedev* pn = usbtree_add( tree, &snap, 0 );
+        if ( pn != NULL )
         {
-            libusb_device* device = listdev[cnt];
-            libusb_device_descriptor desc = {0};
-            libusb_config_descriptor* cfg;
-
-            uint8_t dev_pn[SLEN_PRODUCT] = {0};
-            uint8_t dev_mn[SLEN_MANUFACTURER] = {0};
-            uint8_t dev_sn[SLEN_SN] = {0};
-
-            if ( libusb_get_device_descriptor( device, &desc ) == 0 )
-            {
-                uint8_t dev_bus = libusb_get_bus_number( device );
-                uint8_t dev_port = libusb_get_port_number( device );
-
-                if ( optpar_simple == 0 )
-                {
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[94m" );
-                    }
-                    printf( "Bus " );
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-                    printf( "%03u, ", dev_bus );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[94m" );
-                    }
-                    printf( "Port " );
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[97m" );
-                    }
-                    printf( "%03u ", dev_port );
-                }
-                else
-                {
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-                    printf( "%03u;", dev_bus );
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[97m" );
-                    }
-                    printf( "%03u;", dev_port );
-                }
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[92m" );
-                }
-
-                if ( optpar_simple == 0 )
-                {
-                    printf( "[%04X:%04X] ", desc.idVendor, desc.idProduct );
-                }
-                else
-                {
-                    printf( "[%04X:%04X];", desc.idVendor, desc.idProduct );
-                }
-
-                // open device ..
-                int usberr = libusb_open( device, &dev );
-                if ( usberr == 0 )
-                {
-                    libusb_get_string_descriptor_ascii( dev,
-                                                        desc.iProduct,
-                                                        dev_pn,
-                                                        SLEN_PRODUCT );
-
-                    libusb_get_string_descriptor_ascii( dev,
-                                                  desc.iManufacturer,
-                                                  dev_mn,
-                                                  SLEN_MANUFACTURER );
-
-                    libusb_get_string_descriptor_ascii( dev,
-                                                  desc.iSerialNumber,
-                                                  dev_sn,
-                                                  SLEN_SN );
-
-                    trimStrInner( (char*)dev_pn );
-                    trimStrInner( (char*)dev_mn );
-                    trimStrInner( (char*)dev_sn );
-                }
-                else
-                {
-                    dev = NULL;
-                }
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[91m" );
-                }
-
-                if ( strlen( (const char*)dev_mn ) > 0 )
-                {
-                    if ( optpar_simple == 0 )
-                        printf( "%s, ", (const char*)dev_mn );
-                    else
-                        printf( "%s;" , (const char*)dev_mn );
-                }
-                else
-                {
-                    if ( optpar_simple == 0 )
-                        printf( "(no manufacturer)" );
-                    else
-                        printf( ";" );
-                }
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[95m" );
-                }
-
-                if ( strlen( (const char*)dev_pn ) > 0 )
-                {
-                    if ( optpar_simple == 0)
-                        printf( "%s\n", (const char*)dev_pn );
-                    else
-                        printf( "%s;", (const char*)dev_pn );
-                }
-                else
-                {
-                    if ( optpar_simple == 0 )
-                        printf( "(no product name)\n" );
-                    else
-                        printf( ";" );
-                }
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[93m" );
-                }
-
-                if ( optpar_simple == 0 )
-                    printf( "    + " );
-
-                if ( strlen( (const char*)dev_sn ) > 0 )
-                {
-                    if ( optpar_simple == 0 )
-                    {
-                        if ( optpar_color > 0 )
-                        {
-                            printf( "\033[94m" );
-                        }
-
-                        printf( "Serial number =" );
-
-                        if ( optpar_color > 0 )
-                        {
-                            printf( "\033[93m" );
-                        }
-
-                        printf(" %s\n", (const char*)dev_sn );
-                    }
-                    else
-                        printf( "%s;", (const char*)dev_sn );
-                }
-                else
-                {
-                    if ( optpar_simple == 0 )
-                    {
-                        if ( optpar_color > 0 )
-                        {
-                            printf( "\033[91m" );
-                        }
-
-                        printf( "(SN not found)\n" );
-                    }
-                    else
-                        printf( ";" );
-                }
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[93m" );
-                }
-
-                if ( ( desc.bDeviceClass > 0 )
-                        || ( desc.bDeviceSubClass > 0 ) )
-                {
-                    if ( optpar_simple == 0 )
-                        printf( "    + " );
-
-                    prtUSBclass( desc.bDeviceClass, desc.bDeviceSubClass );
-                }
-                else
-                if ( optpar_simple == 1 )
-                {
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[94m" );
-                    }
-
-                    printf( "cls=" );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-
-                    printf( "none;" );
-                }
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[93m" );
-                }
-
-                if ( optpar_simple == 0 )
-                    printf( "    + " );
-
-                uint16_t l16bcdID = libusb_cpu_to_le16( desc.bcdUSB );
-                if ( optpar_simple == 0 )
-                {
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[94m" );
-                    }
-
-                    printf( "bcdID = " );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-
-                    printf( "%04X,", l16bcdID );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[94m" );
-                    }
-
-                    printf( " human readable = " );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-
-                    printf( "%s",
-                            bcd2human( l16bcdID ) );
-                    printf( "\n" );
-                }
-                else
-                {
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[94m" );
-                    }
-
-                    printf( "bcdID=" );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-
-                    printf( "%04X(", l16bcdID );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[97m" );
-                    }
-
-                    printf( "%s", bcd2human( l16bcdID ) );
-
-                    if ( optpar_color > 0 )
-                    {
-                        printf( "\033[93m" );
-                    }
-
-                    printf( ");" );
-                }
-
-                // get config
-                if ( desc.bNumConfigurations > 0 )
-                {
-                    for ( uint8_t cnt=0; cnt<desc.bNumConfigurations; cnt++ )
-                    {
-                        usberr = libusb_get_config_descriptor( device,
-                                                               cnt,
-                                                               &cfg );
-                        if ( usberr == 0 )
-                        {
-                            prtUSBConfig( device, dev, cnt, l16bcdID, cfg );
-                        }
-                        else
-                        {
-                            printf( "\n" );
-                        }
-                    }
-                }
-
-                if ( dev != NULL )
-                    libusb_close( dev );
-            }
+            render->watchbus( pf->bus );
+            render->treedev( pn );
         }
-    }
 
-    return devscnt;
+        usbtree_free( tree );
+    }
 }
 
-size_t treelistdevs()
+size_t watchdevs()
 {
-    libusb_device_handle* dev = NULL;
-    libusb_device** listdev = NULL;
-    size_t devscnt = libusb_get_device_list( libusbctx, &listdev );
-
-    if ( devscnt > 0 )
+    if ( libusb_has_capability( LIBUSB_CAP_HAS_HOTPLUG ) == 0 )
     {
-        for ( size_t cnt = 0; cnt<devscnt; cnt++ )
-        {
-            libusb_device* device = listdev[cnt];
-            libusb_device_descriptor desc = {0};
-            libusb_config_descriptor* cfg;
-            usbdevdevinfo* curDevInfo = NULL;
-
-            if ( libusb_get_device_descriptor( device, &desc ) == 0 )
-            {
-                uint8_t dev_bus = libusb_get_bus_number( device );
-                uint8_t dev_port = libusb_get_port_number( device );
-
-                if ( usbtree.size() == 0 )
-                {
-                    // first one
-                    alloc_append_businfo( &usbtree, 1 );
-                    usbtree[0]->bus = dev_bus;
-                    alloc_append_portdev( &usbtree, 0, 1 );
-                    curDevInfo = usbtree[0]->device[0];
-                }
-                else /// find same bus or not.
-                {
-                    bool foundBUS = false;
-                    for ( size_t itr=0; itr<usbtree.size(); itr++ )
-                    {
-                        if ( usbtree[itr]->bus == dev_bus )
-                        {
-                            foundBUS = true;
-                            alloc_append_portdev( &usbtree, itr, 1 );
-                            size_t cq = usbtree[itr]->device.size();
-                            if ( cq > 0 )
-                                cq--;
-                            curDevInfo = usbtree[itr]->device[cq];
-                            break;
-                        }
-                    }
+        fprintf( stderr, "hotplug is not supported on this platform.\n" );
+        return 0;
+    }
 
-                    if ( foundBUS == false )
-                    {
-                        alloc_append_businfo( &usbtree, 1 );
-                        alloc_append_portdev( &usbtree, usbtree.size()-1, 1 );
-                        size_t cq = usbtree.size();
-                        if ( cq > 0 )
-                            cq--;
-                        usbtree[cq]->bus = dev_bus;
-                        curDevInfo = usbtree[usbtree.size()-1]->device[0];
-                    }
-                }
+    libusb_hotplug_callback_handle hph;
+    int usberr = libusb_hotplug_register_callback( libusbctx,
+                                                   LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED
+                                                   | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                                   LIBUSB_HOTPLUG_ENUMERATE,
+                                                   LIBUSB_HOTPLUG_MATCH_ANY,
+                                                   LIBUSB_HOTPLUG_MATCH_ANY,
+                                                   LIBUSB_HOTPLUG_MATCH_ANY,
+                                                   watchcb, NULL, &hph );
+    if ( usberr != LIBUSB_SUCCESS )
+    {
+        fprintf( stderr, "failed to register hotplug callback, %s\n",
+                 libusb_error_name( usberr ) );
+        return 0;
+    }
 
-                if ( curDevInfo != NULL )
-                {
-                    curDevInfo->port = dev_port;
-                    curDevInfo->vid  = desc.idVendor;
-                    curDevInfo->pid  = desc.idProduct;
-                }
+    signal( SIGINT, watchsig );
+    signal( SIGTERM, watchsig );
 
-                // open device ..
-                int usberr = libusb_open( device, &dev );
-                if ( usberr == 0 )
-                {
-                    libusb_get_string_descriptor_ascii( dev,
-                                                        desc.iProduct,
-                                                        (uint8_t*)curDevInfo->product,
-                                                        SLEN_PRODUCT );
-
-                    libusb_get_string_descriptor_ascii( dev,
-                                                       desc.iManufacturer,
-                                                       (uint8_t*)curDevInfo->manufacturer,
-                                                       SLEN_MANUFACTURER );
-
-                    libusb_get_string_descriptor_ascii( dev,
-                                                        desc.iSerialNumber,
-                                                        (uint8_t*)curDevInfo->serialnumber,
-                                                        SLEN_SN );
-
-                    if ( strlen( curDevInfo->product ) == 0 )
-                    {
-                        snprintf( curDevInfo->product, SLEN_PRODUCT, "-" );
-                    }
-                    else
-                    {
-                        trimStrInner( curDevInfo->product );
-                    }
+    size_t events = 0;
 
-                    if ( strlen( curDevInfo->manufacturer ) == 0 )
-                    {
-                        snprintf( curDevInfo->manufacturer, SLEN_MANUFACTURER, "-" );
-                    }
-                    else
-                    {
-                        trimStrInner( curDevInfo->manufacturer );
-                    }
+    while( watchquit == 0 )
+    {
+        for ( size_t cnt=0; cnt<watchevts.size(); cnt++ )
+        {
+            libusb_device* device = watchevts[cnt].device;
+            bool arrived = ( watchevts[cnt].event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED );
 
-                    if ( strlen( curDevInfo->serialnumber ) == 0 )
-                    {
-                        snprintf( curDevInfo->serialnumber, SLEN_SN, "-" );
-                    }
-                    else
-                    {
-                        trimStrInner( curDevInfo->serialnumber );
-                    }
-                }
-                else
+            // left device keeps strings and configs read at arrival.
+            size_t known = watchknown.size();
+            for ( size_t itr=0; itr<watchknown.size(); itr++ )
+            {
+                if ( watchknown[itr].device == device )
                 {
-                    dev = NULL;
+                    known = itr;
+                    break;
                 }
-
-                putUSBClass( curDevInfo, desc.bDeviceClass, desc.bDeviceSubClass );
-                curDevInfo->bcd = libusb_cpu_to_le16( desc.bcdUSB );
-
-                if ( dev != NULL )
-                    libusb_close( dev );
             }
-        }
 
-        for( size_t cnt=0; cnt<usbtree.size(); cnt++ )
-        {
-            if ( optpar_color > 0 )
+            if ( arrived == true )
             {
-                printf( "\033[94m" );
-            }
-            printf( "Bus " );
+                if ( known < watchknown.size() )
+                {
+                    usbenum_freedev( watchknown[known] );
+                    libusb_unref_device( watchknown[known].device );
+                    watchknown.erase( watchknown.begin() + known );
+                }
 
-            if ( optpar_color > 0 )
-            {
-                printf( "\033[93m" );
+                usbdevfetch uf = usbdevfetch();
+                uf.device = libusb_ref_device( device );
+                usbenum_fetchdev( &enumopt, &uf, ( optpar_treeview == 0 ), false );
+                prtwatchdev( &uf, true );
+                watchknown.push_back( uf );
             }
-            printf( "%03u", usbtree[cnt]->bus );
-
-            if ( optpar_color > 0 )
+            else
+            if ( known < watchknown.size() )
             {
-                printf( "\033[95m" );
+                prtwatchdev( &watchknown[known], false );
+                usbenum_freedev( watchknown[known] );
+                libusb_unref_device( watchknown[known].device );
+                watchknown.erase( watchknown.begin() + known );
             }
-            printf( " : " );
-
-            if ( optpar_color > 0 )
+            else
             {
-                printf( "\033[92m" );
+                usbdevfetch uf = usbdevfetch();
+                uf.device = device;
+                usbenum_fetchdev( &enumopt, &uf, false, false );
+                prtwatchdev( &uf, false );
+                usbenum_freedev( uf );
             }
-            printf( "%zu devices\n", usbtree[cnt]->device.size() );
-
-            for( size_t itr=0; itr<usbtree[cnt]->device.size(); itr++ )
-            {
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[93m" );
-                }
-                printf( "  +-- " );
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[94m" );
-                }
-                printf( "Port " );
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[97m" );
-                }
-                printf( "%03u ", usbtree[cnt]->device[itr]->port );
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[92m" );
-                }
-                printf( "[%04X:%04X] ", usbtree[cnt]->device[itr]->vid,
-                                        usbtree[cnt]->device[itr]->pid );
-
-                // no need to decide color ...
-                printf( "%s, ", bcd2human( usbtree[cnt]->device[itr]->bcd ) );
-
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[93m" );
-                }
-                printf( "%s, ", usbtree[cnt]->device[itr]->classname );
+            libusb_unref_device( device );
+            events++;
+        }
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[96m" );
-                }
-                printf( "%s, ", usbtree[cnt]->device[itr]->serialnumber );
+        if ( watchevts.size() > 0 )
+        {
+            watchevts.clear();
+            ob_flush();
+        }
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[91m" );
-                }
-                printf( "%s, ", usbtree[cnt]->device[itr]->manufacturer );
+        // sleeps in libusb until any event, wakes up every second to check quit.
+        struct timeval tv = { 1, 0 };
+        libusb_handle_events_timeout_completed( libusbctx, &tv, NULL );
+    }
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[95m" );
-                }
-                printf( "%s", usbtree[cnt]->device[itr]->product );
+    libusb_hotplug_deregister_callback( libusbctx, hph );
 
-                if ( optpar_color > 0 )
-                {
-                    printf( "\033[0m" );
-                }
-                printf( "\n" );
-            }
-        }
+    for ( size_t cnt=0; cnt<watchevts.size(); cnt++ )
+    {
+        libusb_unref_device( watchevts[cnt].device );
+    }
+    watchevts.clear();
 
-        free_portdev( usbtree );
+    for ( size_t cnt=0; cnt<watchknown.size(); cnt++ )
+    {
+        usbenum_freedev( watchknown[cnt] );
+        libusb_unref_device( watchknown[cnt].device );
     }
+    watchknown.clear();
 
-    return devscnt;
+    return events;
 }
 
 void showHelp()
@@ -1494,7 +581,35 @@ void showHelp()
 "  -c,--color          display with xterm-color escape codes.\n"
 "  -r,--reftable       display reference table section with --simple.\n"
 "  -L,--lessinfo       display information lesser than normal case.\n"
-"  -t,--tree           display USB device tree ( not implemented )\n";
+"  -j,--jobs N         open and read devices with N workers in parallel.\n"
+"  -a,--async          read string descriptors of all devices at once.\n"
+"  --sysfs             read devices from linux sysfs, without opening device.\n"
+"  --sysfs-root PATH   use PATH as sysfs USB devices directory, implies --sysfs.\n"
+"  --cache[=FILE]      keep device strings in cache FILE, skips opening known devices.\n"
+"  --device-timeout MS give up strings of a device not answered in MS milliseconds.\n"
+"  --deadline MS       stop opening devices after MS milliseconds of whole run.\n"
+"  -w,--watch          keep running, display devices when arrived or left.\n"
+"  --format=FMT        output as FMT, one of text, json, ndjson, csv.\n"
+"  --fields=LIST       output only comma separated fields of LIST, in --format.\n"
+"                      devices are not opened unless a string field is in LIST.\n"
+"  --vid HEX, --pid HEX only devices of vendor or product id HEX.\n"
+"  --bus N             only devices on bus N.\n"
+"  --port-path P       only device at port chain P, as 1.4.2.\n"
+"  --class HEX         only devices of class HEX, in device or any interface.\n"
+"  --exists            print nothing, exit 0 when a device matched, 1 when not.\n"
+"  --stats[=json]      report timings of each phase and slowest devices to stderr.\n"
+"  --dump FILE         write enumerated devices to binary snapshot FILE.\n"
+"  --load FILE         display devices from snapshot FILE, without libusb.\n"
+"  --daemon[=SOCKET]   run as listusbd, serve devices kept updated by hotplug\n"
+"                      to clients at Unix SOCKET, as running named listusbd.\n"
+"  --from-daemon[=SOCKET] display devices served by listusbd, without libusb.\n"
+"  --prometheus FILE   write node_exporter textfile FILE of devices and buses,\n"
+"                      again every --interval SEC ( 60, 0 for once ).\n"
+"  --speed-audit       compare negotiated speed with BOS capability of each device,\n"
+"                      exit 1 when any device runs below its capability.\n"
+"  --bandwidth         report periodic bandwidth reserved of each bus and root port\n"
+"                      against USB limits, exit 1 when any is over.\n"
+"  -t,--tree           display USB devices as hub topology tree of each bus.\n";
 
     fprintf( stdout, shortusage, ME_STR );
 }
@@ -1507,30 +622,30 @@ void showVersion()
 
 int main( int argc, char** argv )
 {
-#ifdef __linux__
-    int s_euid = geteuid();
-    if ( s_euid > 10 )
-    {
-        fprintf( stderr, "WARNING: some linux not able to read correct USB information as normal user." );
-        fprintf( stderr, " Use `sudo` to run %s to correct information if some informations are displayed as empty.\n",
-                 ME_STR );
-    }
-#endif /// of __linux__
-
 #ifdef DEBUG_LIBUSB
     putenv( "LIBUSB_DEBUG=4" );
 #endif /// of DEBUG_LIBUSB
 
+    usbenum_defaults( &enumopt );
+
+    // same binary runs as daemon by name, as a link of listusbd.
+    const char* progname = strrchr( argv[0], '/' );
+    progname = progname != NULL ? progname + 1 : argv[0];
+    if ( strcmp( progname, DAEMON_NAME ) == 0 )
+    {
+        optpar_daemon = 1;
+    }
+
     // getopt
     for(;;)
     {
         int optidx = 0;
         int opt = getopt_long( argc, argv,
-                               " :hvsctrL",
+                               " :hvsctrLj:aw",
                                long_opts, &optidx );
         if ( opt >= 0 )
         {
-            switch( (char)opt )
+            switch( opt )
             {
                 default:
                 case 'h':
@@ -1560,12 +675,201 @@ int main( int argc, char** argv )
                 case 'L':
                     optpar_lessinfo = 1;
                     break;
+
+                case 'w':
+                    optpar_watch = 1;
+                    break;
+
+                case 'a':
+                    enumopt.async = true;
+                    break;
+
+                case OPT_SYSFSROOT:
+                    enumopt.sysfsroot = optarg;
+                    enumopt.sysfs = true;
+                    break;
+
+                case OPT_SYSFS:
+                    enumopt.sysfs = true;
+                    break;
+
+                case OPT_FORMAT:
+                    optpar_format = usbformat_byname( optarg );
+                    if ( optpar_format < 0 )
+                    {
+                        fprintf( stderr, "unknown format '%s', use one of text, json, ndjson, csv.\n",
+                                 optarg );
+                        return -1;
+                    }
+                    break;
+
+                case OPT_DUMP:
+                    optpar_dumpfile = optarg;
+                    break;
+
+                case OPT_LOAD:
+                    optpar_loadfile = optarg;
+                    break;
+
+                case OPT_PROMETHEUS:
+                    optpar_promfile = optarg;
+                    break;
+
+                case OPT_INTERVAL:
+                    optpar_interval = atoi( optarg );
+                    break;
+
+                case OPT_SPEEDAUDIT:
+                    optpar_speedaudit = 1;
+                    break;
+
+                case OPT_BANDWIDTH:
+                    optpar_bandwidth = 1;
+                    break;
+
+                case OPT_DAEMON:
+                case OPT_FROMDAEMON:
+                    if ( opt == OPT_DAEMON )
+                        optpar_daemon = 1;
+                    else
+                        optpar_fromdaemon = 1;
+
+                    if ( optarg != NULL )
+                        snprintf( optpar_sockpath, SOCKPATH_MAX, "%s", optarg );
+                    break;
+
+                case OPT_CACHE:
+                    optpar_cachefile = optarg;
+                    optpar_cache = 1;
+                    break;
+
+                case OPT_VID:
+                    filter.vid = strtoul( optarg, NULL, 16 );
+                    filter.flags |= USBFILTER_VID;
+                    break;
+
+                case OPT_PID:
+                    filter.pid = strtoul( optarg, NULL, 16 );
+                    filter.flags |= USBFILTER_PID;
+                    break;
+
+                case OPT_BUS:
+                    filter.bus = atoi( optarg );
+                    filter.flags |= USBFILTER_BUS;
+                    break;
+
+                case OPT_PORTPATH:
+                    if ( usbfilter_portpath( &filter, optarg ) == false )
+                    {
+                        fprintf( stderr, "wrong port path '%s', use as 1.4.2\n", optarg );
+                        return -1;
+                    }
+                    break;
+
+                case OPT_CLASS:
+                    filter.clsid = strtoul( optarg, NULL, 16 );
+                    filter.flags |= USBFILTER_CLASS;
+                    break;
+
+                case OPT_EXISTS:
+                    optpar_exists = 1;
+                    break;
+
+                case OPT_STATS:
+                    if ( ( optarg != NULL ) && ( strcmp( optarg, "json" ) == 0 ) )
+                    {
+                        optpar_statsjson = 1;
+                    }
+                    else
+                    if ( ( optarg != NULL ) && ( strcmp( optarg, "text" ) != 0 ) )
+                    {
+                        fprintf( stderr, "unknown stats format '%s', use text or json.\n", optarg );
+                        return -1;
+                    }
+                    optpar_stats = 1;
+                    break;
+
+                case OPT_FIELDS:
+                    optpar_fields = optarg;
+                    break;
+
+                case OPT_DEVTIMEOUT:
+                    enumopt.devtimeout = atoi( optarg );
+                    break;
+
+                case OPT_DEADLINE:
+                    enumopt.deadline = atoi( optarg );
+                    break;
+
+                case 'j':
+                    enumopt.jobs = atoi( optarg );
+                    if ( enumopt.jobs == 0 )
+                        enumopt.jobs = 1;
+                    break;
             }
         }
         else
             break;
     } /// of for( == )
 
+    if ( filter.flags != 0 )
+    {
+        enumopt.filter = &filter;
+    }
+
+    if ( ( ( optpar_daemon > 0 ) || ( optpar_fromdaemon > 0 ) )
+         && ( optpar_sockpath[0] == 0 ) )
+    {
+        usbdaemon_defaultpath( optpar_sockpath, SOCKPATH_MAX );
+    }
+
+    if ( optpar_daemon > 0 )
+    {
+        // daemon keeps every device of libusb, clients select and display.
+        enumopt.filter   = NULL;
+        enumopt.sysfs    = false;
+        optpar_loadfile  = NULL;
+        optpar_fromdaemon = 0;
+        optpar_watch     = 0;
+        // once for each device arrived, clients may audit speed.
+        enumopt.bos      = true;
+    }
+
+    if ( optpar_fields != NULL )
+    {
+        char errname[32] = {0};
+
+        if ( usbformat_fields( optpar_fields, &fields, errname, sizeof( errname ) ) == false )
+        {
+            fprintf( stderr, "unknown field '%s', use any of bus, port, address, port_path,"
+                             " vid, pid, speed, bcd_usb, bcd_device, class, subclass,"
+                             " protocol, configs, manufacturer, product, serial,"
+                             " max_power_ma.\n", errname );
+            return -1;
+        }
+    }
+
+    if ( ( optpar_watch > 0 ) && ( optpar_format != USBFORMAT_TEXT ) )
+    {
+        fprintf( stderr, "--watch displays as text, --format ignored.\n" );
+        optpar_format = USBFORMAT_TEXT;
+    }
+
+    if ( ( optpar_speedaudit > 0 ) && ( enumopt.sysfs == true ) )
+    {
+        fprintf( stderr, "--speed-audit reads BOS of opened devices, not in sysfs, capabilities are unknown.\n" );
+    }
+
+#ifdef __linux__
+    int s_euid = geteuid();
+    if ( ( s_euid > 10 ) && ( enumopt.sysfs == false ) && ( fromsnapshot() == false ) )
+    {
+        fprintf( stderr, "WARNING: some linux not able to read correct USB information as normal user." );
+        fprintf( stderr, " Use `sudo` to run %s or `--sysfs` to correct information if some informations are displayed as empty.\n",
+                 ME_STR );
+    }
+#endif /// of __linux__
+
     // check envs 
     const char* colParam = getenv( "LISTUSB_COLOR" );
     if ( colParam != nullptr )
@@ -1573,67 +877,189 @@ int main( int argc, char** argv )
         optpar_color = atoi( colParam );
     }
 
+    render = usbrender_select( optpar_simple > 0, optpar_color > 0,
+                               optpar_lessinfo > 0 );
+
     // continue to print something -
-    if ( optpar_simple == 0 )
+    if ( ( optpar_simple == 0 ) && ( optpar_format == USBFORMAT_TEXT )
+         && ( optpar_fields == NULL ) && ( optpar_exists == 0 ) && ( optpar_daemon == 0 )
+         && ( optpar_promfile == NULL ) )
     {
         if ( optpar_color > 0 )
         {
-            printf( "\033[97m" );
+            ob_puts( "\033[97m" );
         }
-        printf( "%s", ME_STR );
+        ob_puts( ME_STR );
         if ( optpar_color > 0 )
         {
-            printf( "\033[0m" );
+            ob_puts( "\033[0m" );
         }
-        printf( ", " );
+        ob_puts( ", " );
 
         if ( optpar_color > 0 )
         {
-            printf( "\033[96m" );
+            ob_puts( "\033[96m" );
         }
-        printf( "version %s", VERSION_STR );
+        ob_puts( "version " );
+        ob_puts( VERSION_STR );
         if ( optpar_color > 0 )
         {
-            printf( "\033[0m" );
+            ob_puts( "\033[0m" );
         }
-        printf( ", " );
+        ob_puts( ", " );
 
         if ( optpar_color > 0 )
         {
-            printf( "\033[94m" );
+            ob_puts( "\033[94m" );
         }
-        printf( "(C)Copyrighted 2023 Raphael Kim" );
+        ob_puts( "(C)Copyrighted 2023 Raphael Kim" );
         if ( optpar_color > 0 )
         {
-            printf( "\033[0m" );
+            ob_puts( "\033[0m" );
         }
-        printf( ", " );
+        ob_puts( ", " );
 
         if ( optpar_color > 0 )
         {
-            printf( "\033[93m" );
+            ob_puts( "\033[93m" );
         }
-        printf( "w/ libusb v%d.%d.%d", LIBUSB_MAJOR, LIBUSB_MINOR, LIBUSB_MICRO );
+        ob_puts( "w/ libusb v" );
+        ob_int( LIBUSB_MAJOR );
+        ob_putc( '.' );
+        ob_int( LIBUSB_MINOR );
+        ob_putc( '.' );
+        ob_int( LIBUSB_MICRO );
         if ( optpar_color > 0 )
         {
-            printf( "\033[0m" );
+            ob_puts( "\033[0m" );
+        }
+        ob_putc( '\n' );
+    }
+
+    if ( ( optpar_stats > 0 ) && ( optpar_watch == 0 ) && ( optpar_daemon == 0 ) )
+    {
+        enumopt.stats = usbstats_create();
+    }
+
+    uint64_t initt0 = usbstats_now();
+
+    // synthesized devices of usbmock, for benchmarks without USB hardware.
+    const char* mockParam = getenv( "LISTUSB_MOCK" );
+    if ( ( mockParam != nullptr ) && ( enumopt.sysfs == false ) && ( fromsnapshot() == false ) )
+    {
+        usbmockopt mockopt;
+        usbmock_defaults( &mockopt );
+
+        if ( usbmock_parse( mockParam, &mockopt ) == false )
+        {
+            ob_flush();
+            fprintf( stderr, "wrong LISTUSB_MOCK '%s', use as N[:latency_us[:hub,hid,storage,audio,cdc]]\n",
+                     mockParam );
+            return -1;
         }
-        printf( "\n" );
+
+        mockusb = usbmock_create( &mockopt );
+        enumopt.backend = usbmock_backend();
+        enumctx = usbmock_context( mockusb );
     }
 
+    // sysfs and snapshot file not require libusb.
+    if ( ( enumopt.sysfs == false ) && ( fromsnapshot() == false ) && ( mockusb == NULL ) )
+    {
 #if (LIBUSB_NANO>11780)
-    libusb_init_option lusbopt[1];
-    lusbopt[0].option = LIBUSB_OPTION_LOG_LEVEL;
-    lusbopt[0].value.ival = 0;
-    libusb_init_context( &libusbctx, lusbopt, 1 );
+        libusb_init_option lusbopt[1];
+        lusbopt[0].option = LIBUSB_OPTION_LOG_LEVEL;
+        lusbopt[0].value.ival = 0;
+        libusb_init_context( &libusbctx, lusbopt, 1 );
 #else
-    libusb_init( &libusbctx );
+        libusb_init( &libusbctx );
 #endif
+        enumctx = libusbctx;
+    }
+
+    if ( enumctx != NULL )
+        usbstats_add( enumopt.stats, USBSTAT_INIT, usbstats_now() - initt0 );
+
+    if ( ( optpar_cache > 0 ) && ( libusbctx != NULL ) )
+    {
+        enumopt.cache = usbcache_open( optpar_cachefile );
+    }
+
+    if ( ( optpar_daemon > 0 ) && ( libusbctx != NULL ) )
+    {
+        fprintf( stderr, "%s serving at %s\n", DAEMON_NAME, optpar_sockpath );
+
+        if ( usbdaemon_serve( libusbctx, &enumopt, optpar_sockpath ) == false )
+        {
+            fprintf( stderr, "cannot serve at %s\n", optpar_sockpath );
+            retcode = -1;
+        }
+
+        usbcache_close( enumopt.cache );
+
+        libusb_exit( libusbctx );
+        return retcode;
+    }
+    else
+    if ( optpar_daemon > 0 )
+    {
+        fprintf( stderr, "%s requires libusb, not available with LISTUSB_MOCK.\n", DAEMON_NAME );
+        usbmock_destroy( mockusb );
+        return -1;
+    }
 
-    if ( libusbctx != NULL )
+    if ( ( optpar_watch > 0 ) && ( libusbctx != NULL ) )
+    {
+        watchdevs();
+        ob_flush();
+
+        usbcache_close( enumopt.cache );
+
+        libusb_exit( libusbctx );
+        return 0;
+    }
+    else
+    if ( optpar_watch > 0 )
+    {
+        fprintf( stderr, "--watch requires libusb hotplug, not available with --sysfs, --load, --from-daemon or LISTUSB_MOCK.\n" );
+    }
+
+    if ( ( enumctx != NULL ) || ( enumopt.sysfs == true ) || ( fromsnapshot() == true ) )
     {
         size_t devs = 0;
+        uint64_t runt0 = usbstats_now();
 
+        // devs stays zero, formatted document has no footer.
+        if ( optpar_exists > 0 )
+        {
+            existdevs();
+        }
+        else
+        if ( optpar_promfile != NULL )
+        {
+            promdevs();
+        }
+        else
+        if ( optpar_speedaudit > 0 )
+        {
+            devs = auditdevs();
+        }
+        else
+        if ( optpar_bandwidth > 0 )
+        {
+            devs = budgetdevs();
+        }
+        else
+        if ( optpar_fields != NULL )
+        {
+            fielddevs();
+        }
+        else
+        if ( optpar_format != USBFORMAT_TEXT )
+        {
+            formatdevs();
+        }
+        else
         if ( optpar_treeview == 0 )
         {
             devs = listdevs();
@@ -1647,57 +1073,70 @@ int main( int argc, char** argv )
         {
             if ( optpar_color > 0 )
             {
-                printf( "\033[96m" );
+                ob_puts( "\033[96m" );
             }
 
-            printf( "total " );
+            ob_puts( "total " );
 
             if ( optpar_color > 0 )
             {
-                printf( "\033[93m" );
+                ob_puts( "\033[93m" );
             }
 
-            printf( "%zu", devs );
+            ob_dec( devs );
 
             if ( optpar_color > 0 )
             {
-                printf( "\033[96m" );
+                ob_puts( "\033[96m" );
             }
 
             if ( devs == 1 )
-                printf( " device found.\n" );
+                ob_puts( " device found.\n" );
             else
-                printf( " devices found.\n" );
+                ob_puts( " devices found.\n" );
 
             if ( optpar_color > 0 )
             {
-                printf( "\033[0m" );
+                ob_puts( "\033[0m" );
             }
         }
         else
-        if ( ( devs == 0 ) && ( optpar_lessinfo == 0 ) )
+        if ( ( devs == 0 ) && ( optpar_lessinfo == 0 )
+             && ( optpar_format == USBFORMAT_TEXT ) && ( optpar_fields == NULL )
+             && ( optpar_exists == 0 ) && ( optpar_promfile == NULL ) )
         {
             if ( optpar_color > 0 )
             {
-                printf( "\033[91m" );
+                ob_puts( "\033[91m" );
             }
 
-            printf( "no device found.\n" );
+            ob_puts( "no device found.\n" );
 
             if ( optpar_color > 0 )
             {
-                printf( "\033[0m" );
+                ob_puts( "\033[0m" );
             }
         }
 
-        fflush( stdout );
+        ob_flush();
 
-        libusb_exit( libusbctx );
+        // after output, so stderr never mixes into it on same terminal.
+        usbstats_add( enumopt.stats, USBSTAT_RUN, usbstats_now() - runt0 );
+        usbstats_write( enumopt.stats, stderr, optpar_statsjson > 0 );
+        usbstats_destroy( enumopt.stats );
+
+        usbcache_close( enumopt.cache );
+
+        if ( libusbctx != NULL )
+            libusb_exit( libusbctx );
+
+        usbmock_destroy( mockusb );
     }
     else
     {
+        ob_flush();
         fprintf( stderr, "libusb context should not initialized.\n" );
     }
 
-    return 0;
+    return retcode;
 }
@@ -0,0 +1,75 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include "outbuf.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+outbuf obuf = { NULL, 0, 0 };
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ob_grow( size_t need )
+{
+    // big enough to go out, keeps memory bounded for huge listing.
+    if ( obuf.size >= OB_FLUSHSZ )
+    {
+        ob_flush();
+    }
+
+    if ( obuf.size + need <= obuf.cap )
+        return;
+
+    size_t newcap = ( obuf.cap > 0 ) ? obuf.cap * 2 : OB_INITSZ;
+    while( newcap < obuf.size + need )
+        newcap *= 2;
+
+    char* newdata = (char*)realloc( obuf.data, newcap );
+    if ( newdata == NULL )
+    {
+        // out of memory, nothing to do but write out now.
+        ob_flush();
+        newdata = (char*)realloc( obuf.data, obuf.size + need );
+        if ( newdata == NULL )
+            abort();
+        newcap = obuf.size + need;
+    }
+
+    obuf.data = newdata;
+    obuf.cap  = newcap;
+}
+
+bool ob_flush( int fd )
+{
+    size_t pos = 0;
+
+    while( pos < obuf.size )
+    {
+        ssize_t wr = write( fd, obuf.data + pos, obuf.size - pos );
+        if ( wr < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            obuf.size = 0;
+            return false;
+        }
+
+        pos += wr;
+    }
+
+    obuf.size = 0;
+    return true;
+}
+
+void ob_reset()
+{
+    free( obuf.data );
+    obuf.data = NULL;
+    obuf.size = 0;
+    obuf.cap  = 0;
+}
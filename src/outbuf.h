@@ -0,0 +1,115 @@
+#ifndef __OUTBUF_H__
+#define __OUTBUF_H__
+
+#include <cstdint>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// One growable buffer for all stdout rendering, written out by ob_flush()
+// with write(). Buffer flushes by itself only when it grows over
+// OB_FLUSHSZ, so a listing usually goes out in a single write().
+
+#define OB_INITSZ           ( 64 * 1024 )
+#define OB_FLUSHSZ          ( 4 * 1024 * 1024 )
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _outbuf {
+    char*       data;
+    size_t      size;
+    size_t      cap;
+}outbuf;
+
+extern outbuf obuf;
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ob_grow( size_t need );
+bool ob_flush( int fd = 1 );
+void ob_reset();
+
+static inline void ob_write( const char* s, size_t len )
+{
+    if ( obuf.size + len > obuf.cap )
+        ob_grow( len );
+
+    memcpy( obuf.data + obuf.size, s, len );
+    obuf.size += len;
+}
+
+static inline void ob_puts( const char* s )
+{
+    ob_write( s, strlen( s ) );
+}
+
+static inline void ob_putc( char c )
+{
+    if ( obuf.size + 1 > obuf.cap )
+        ob_grow( 1 );
+
+    obuf.data[obuf.size++] = c;
+}
+
+// as "%0*X", uppercase.
+static inline void ob_hex( uint32_t v, unsigned digits )
+{
+    static const char hexs[] = "0123456789ABCDEF";
+    char   tmp[8];
+    size_t len = 0;
+
+    do
+    {
+        tmp[len++] = hexs[ v & 0x0F ];
+        v >>= 4;
+    }
+    while( ( v > 0 ) && ( len < sizeof( tmp ) ) );
+
+    while( ( len < digits ) && ( len < sizeof( tmp ) ) )
+        tmp[len++] = '0';
+
+    if ( obuf.size + len > obuf.cap )
+        ob_grow( len );
+
+    while( len > 0 )
+        obuf.data[obuf.size++] = tmp[--len];
+}
+
+// as "%*u" with pad ' ', "%0*u" with pad '0'.
+static inline void ob_dec( uint64_t v, unsigned width = 0, char pad = ' ' )
+{
+    char   tmp[24];
+    size_t len = 0;
+
+    do
+    {
+        tmp[len++] = (char)( '0' + ( v % 10 ) );
+        v /= 10;
+    }
+    while( v > 0 );
+
+    while( ( len < width ) && ( len < sizeof( tmp ) ) )
+        tmp[len++] = pad;
+
+    if ( obuf.size + len > obuf.cap )
+        ob_grow( len );
+
+    while( len > 0 )
+        obuf.data[obuf.size++] = tmp[--len];
+}
+
+// as "%d".
+static inline void ob_int( int64_t v )
+{
+    if ( v < 0 )
+    {
+        ob_putc( '-' );
+        ob_dec( (uint64_t)( -( v + 1 ) ) + 1 );
+    }
+    else
+    {
+        ob_dec( (uint64_t)v );
+    }
+}
+
+#endif /// of __OUTBUF_H__
@@ -0,0 +1,350 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <chrono>
+
+#include "usbasync.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define USBASYNC_DATASZ     255
+#define USBASYNC_BUFFSZ     ( LIBUSB_CONTROL_SETUP_SIZE + USBASYNC_DATASZ )
+#define USBASYNC_MAXERRORS  8       /// event handling failed in a row, gives up.
+#define USBASYNC_CANCELMS   2000    /// waits for cancelled transfers at most.
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _asyncengine asyncengine;
+
+typedef struct _asyncreq {
+    asyncengine*        engine;
+    usbdevfetch*        dev;
+    libusb_transfer*    xfer;
+    uint8_t*            dst;        /// NULL for LANGID request.
+    size_t              dstlen;
+    bool                orphan;     /// left in libusb, freed by its callback.
+    uint8_t             buff[USBASYNC_BUFFSZ];
+}asyncreq;
+
+struct _asyncengine {
+    unsigned            timeout;
+    bool                cancelled;
+    size_t              pending;
+    size_t              done;
+    vector< asyncreq* > reqs;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void LIBUSB_CALL usbasync_cb( libusb_transfer* xfer );
+
+static bool usbasync_submit( asyncengine* eng, usbdevfetch* pf,
+                             uint8_t idx, uint16_t langid,
+                             uint8_t* dst, size_t dstlen )
+{
+    if ( ( eng == NULL ) || ( pf == NULL ) || ( pf->handle == NULL ) )
+        return false;
+
+    asyncreq* req = new asyncreq;
+    if ( req == NULL )
+        return false;
+
+    memset( req, 0, sizeof( asyncreq ) );
+    req->engine = eng;
+    req->dev    = pf;
+    req->dst    = dst;
+    req->dstlen = dstlen;
+    req->xfer   = libusb_alloc_transfer( 0 );
+
+    if ( req->xfer != NULL )
+    {
+        libusb_fill_control_setup( req->buff,
+                                   LIBUSB_ENDPOINT_IN,
+                                   LIBUSB_REQUEST_GET_DESCRIPTOR,
+                                   (uint16_t)( ( LIBUSB_DT_STRING << 8 ) | idx ),
+                                   langid,
+                                   USBASYNC_DATASZ );
+
+        libusb_fill_control_transfer( req->xfer, pf->handle, req->buff,
+                                      usbasync_cb, req, eng->timeout );
+
+        if ( libusb_submit_transfer( req->xfer ) == 0 )
+        {
+            eng->reqs.push_back( req );
+            eng->pending++;
+            return true;
+        }
+
+        libusb_free_transfer( req->xfer );
+    }
+
+    pf->strerr = true;
+    delete req;
+    return false;
+}
+
+static void usbasync_submitstrings( asyncengine* eng, usbdevfetch* pf, uint16_t langid )
+{
+    // index 0 means no string, as same as libusb_get_string_descriptor_ascii().
+    if ( pf->desc.iProduct > 0 )
+    {
+        usbasync_submit( eng, pf, pf->desc.iProduct, langid,
+                         pf->product, SLEN_PRODUCT );
+    }
+
+    if ( pf->desc.iManufacturer > 0 )
+    {
+        usbasync_submit( eng, pf, pf->desc.iManufacturer, langid,
+                         pf->manufacturer, SLEN_MANUFACTURER );
+    }
+
+    if ( pf->desc.iSerialNumber > 0 )
+    {
+        usbasync_submit( eng, pf, pf->desc.iSerialNumber, langid,
+                         pf->serialnumber, SLEN_SN );
+    }
+
+    for ( size_t cnt=0; cnt<pf->config.size(); cnt++ )
+    {
+        const usbcfgfetch* pcf = &pf->config[cnt];
+        uint8_t dtype = 0;
+        uint8_t istr  = 0;
+
+        if ( pcf->cfg != NULL )
+        {
+            dtype = pcf->cfg->bDescriptorType;
+            istr  = pcf->cfg->iConfiguration;
+        }
+        else
+        if ( pcf->raw.size() >= LIBUSB_DT_CONFIG_SIZE )
+        {
+            dtype = pcf->raw[1];
+            istr  = pcf->raw[USBDESC_CFG_ISTR];
+        }
+
+        if ( ( dtype == LIBUSB_DT_STRING ) && ( istr > 0 ) )
+        {
+            usbasync_submit( eng, pf, istr, langid,
+                             pf->config[cnt].cfgstr, SLEN_CONFIG );
+        }
+    }
+}
+
+void usbasync_utf8( const uint8_t* data, int len, uint8_t* dst, size_t dstlen )
+{
+    size_t di  = 0;
+    int    end = data[0] < len ? data[0] : len;
+
+    if ( dstlen == 0 )
+        return;
+
+    for ( int si=2; si + 1 < end; si+=2 )
+    {
+        uint32_t cp = data[si] | ( data[si + 1] << 8 );
+
+        // most of strings are ASCII only.
+        if ( cp < 0x80 )
+        {
+            if ( di + 1 >= dstlen )
+                break;
+
+            dst[di++] = (uint8_t)cp;
+            continue;
+        }
+
+        if ( ( cp >= 0xD800 ) && ( cp < 0xE000 ) )
+        {
+            uint32_t lo = si + 3 < end ? data[si + 2] | ( data[si + 3] << 8 ) : 0;
+
+            // high surrogate followed by low one, others are unpaired.
+            if ( ( cp < 0xDC00 ) && ( lo >= 0xDC00 ) && ( lo < 0xE000 ) )
+            {
+                cp = 0x10000 + ( ( cp - 0xD800 ) << 10 ) + ( lo - 0xDC00 );
+                si += 2;
+            }
+            else
+            {
+                cp = 0xFFFD;
+            }
+        }
+
+        size_t n = cp < 0x800 ? 2 : ( cp < 0x10000 ? 3 : 4 );
+
+        // never cuts a character.
+        if ( di + n >= dstlen )
+            break;
+
+        switch( n )
+        {
+            case 2:
+                dst[di++] = 0xC0 | ( cp >> 6 );
+                break;
+
+            case 3:
+                dst[di++] = 0xE0 | ( cp >> 12 );
+                dst[di++] = 0x80 | ( ( cp >> 6 ) & 0x3F );
+                break;
+
+            default:
+                dst[di++] = 0xF0 | ( cp >> 18 );
+                dst[di++] = 0x80 | ( ( cp >> 12 ) & 0x3F );
+                dst[di++] = 0x80 | ( ( cp >> 6 ) & 0x3F );
+                break;
+        }
+
+        dst[di++] = 0x80 | ( cp & 0x3F );
+    }
+
+    dst[di] = 0;
+}
+
+static void LIBUSB_CALL usbasync_cb( libusb_transfer* xfer )
+{
+    asyncreq* req = (asyncreq*)xfer->user_data;
+
+    // engine and device are gone.
+    if ( req->orphan == true )
+    {
+        libusb_free_transfer( xfer );
+        delete req;
+        return;
+    }
+
+    asyncengine* eng = req->engine;
+    bool      read = false;
+
+    if ( ( xfer->status == LIBUSB_TRANSFER_COMPLETED )
+         && ( xfer->actual_length >= 2 ) )
+    {
+        const uint8_t* data = libusb_control_transfer_get_data( xfer );
+
+        if ( data[1] == LIBUSB_DT_STRING )
+        {
+            if ( req->dst == NULL )
+            {
+                if ( ( xfer->actual_length >= 4 ) && ( eng->cancelled == false ) )
+                {
+                    uint16_t langid = data[2] | ( data[3] << 8 );
+                    usbasync_submitstrings( eng, req->dev, langid );
+                    read = true;
+                }
+            }
+            else
+            {
+                usbasync_utf8( data, xfer->actual_length, req->dst, req->dstlen );
+                eng->done++;
+                read = true;
+            }
+        }
+    }
+    else
+    if ( ( xfer->status == LIBUSB_TRANSFER_TIMED_OUT )
+         || ( xfer->status == LIBUSB_TRANSFER_CANCELLED ) )
+    {
+        req->dev->timedout = true;
+    }
+
+    // LANGID of device without any string is not needed.
+    const libusb_device_descriptor* pd = &req->dev->desc;
+    if ( ( read == false )
+         && ( ( req->dst != NULL )
+              || ( ( pd->iProduct | pd->iManufacturer | pd->iSerialNumber ) > 0 ) ) )
+    {
+        req->dev->strerr = true;
+    }
+
+    libusb_free_transfer( xfer );
+    req->xfer = NULL;
+    eng->pending--;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t usbasync_fetchstrings( libusb_context* ctx, usbdevfetch* devs, size_t cnt,
+                              unsigned timeout, unsigned deadline )
+{
+    if ( ( ctx == NULL ) || ( devs == NULL ) || ( cnt == 0 ) )
+        return 0;
+
+    asyncengine eng;
+    eng.timeout   = timeout;
+    eng.cancelled = false;
+    eng.pending   = 0;
+    eng.done    = 0;
+
+    // LANGID first, each completion queues strings of its device.
+    for ( size_t itr=0; itr<cnt; itr++ )
+    {
+        usbasync_submit( &eng, &devs[itr], 0, 0, NULL, 0 );
+    }
+
+    chrono::steady_clock::time_point endtp = \
+        chrono::steady_clock::now() + chrono::milliseconds( deadline );
+    chrono::steady_clock::time_point canceltp = endtp;
+    unsigned errors = 0;
+
+    while( eng.pending > 0 )
+    {
+        // events never handled, or cancelled ones never completed.
+        if ( ( errors >= USBASYNC_MAXERRORS )
+             || ( ( eng.cancelled == true ) && ( chrono::steady_clock::now() >= canceltp ) ) )
+            break;
+
+        long waitus = 100 * 1000;
+
+        if ( ( deadline > 0 ) && ( eng.cancelled == false ) )
+        {
+            long leftus = (long)chrono::duration_cast< chrono::microseconds >(
+                              endtp - chrono::steady_clock::now() ).count();
+            if ( leftus < waitus )
+                waitus = leftus > 0 ? leftus : 0;
+        }
+
+        struct timeval tv = { 0, waitus };
+
+        int usberr = libusb_handle_events_timeout( ctx, &tv );
+        errors = usberr < 0 ? errors + 1 : 0;
+
+        if ( ( eng.cancelled == false )
+             && ( ( usberr < 0 )
+                  || ( ( deadline > 0 ) && ( chrono::steady_clock::now() >= endtp ) ) ) )
+        {
+            eng.cancelled = true;
+            canceltp = chrono::steady_clock::now()
+                       + chrono::milliseconds( USBASYNC_CANCELMS );
+
+            // let each transfer to be completed as cancelled.
+            for ( size_t itr=0; itr<eng.reqs.size(); itr++ )
+            {
+                if ( eng.reqs[itr]->xfer != NULL )
+                {
+                    libusb_cancel_transfer( eng.reqs[itr]->xfer );
+                }
+            }
+        }
+    }
+
+    for ( size_t itr=0; itr<eng.reqs.size(); itr++ )
+    {
+        asyncreq* req = eng.reqs[itr];
+
+        // still owned by libusb, failed here and freed when completed.
+        if ( req->xfer != NULL )
+        {
+            req->dev->timedout = true;
+            req->dev->strerr   = true;
+            req->orphan        = true;
+            continue;
+        }
+
+        delete req;
+    }
+
+    return eng.done;
+}
@@ -0,0 +1,28 @@
+#ifndef __USBASYNC_H__
+#define __USBASYNC_H__
+
+#include "usbfetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define USBASYNC_TIMEOUT_MS     1000
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reads manufacturer, product, serial number and configuration strings
+// of every opened device ( handle not NULL ) with asynchronous control
+// transfers. All requests are queued at once and completed in one event
+// loop, returns number of string descriptors read. Each transfer waits
+// timeout ms at most, any transfer left after deadline ms ( 0 for none )
+// is cancelled. Device of timed out or cancelled transfer is marked as
+// timedout. Event handling failing again and again, or cancelled ones
+// not completed in 2 seconds, stops waiting, transfers left are failed.
+size_t usbasync_fetchstrings( libusb_context* ctx, usbdevfetch* devs, size_t cnt,
+                              unsigned timeout = USBASYNC_TIMEOUT_MS,
+                              unsigned deadline = 0 );
+
+// UTF-16LE string descriptor to UTF-8, unpaired surrogate as U+FFFD.
+// Stops before a character not fitting in dst, always terminated.
+void   usbasync_utf8( const uint8_t* data, int len, uint8_t* dst, size_t dstlen );
+
+#endif /// of __USBASYNC_H__
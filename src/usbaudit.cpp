@@ -0,0 +1,188 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "outbuf.h"
+#include "usbaudit.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define AUDIT_SGR_RST       "\033[0m"
+#define AUDIT_SGR_LRED      "\033[91m"
+#define AUDIT_SGR_LGRN      "\033[92m"
+#define AUDIT_SGR_LYEL      "\033[93m"
+#define AUDIT_SGR_LCYN      "\033[96m"
+
+// indexed by libusb_speed, 6 of newer libusb is Gen2x2.
+static const char* auditspeeds[] = {
+    "unknown", "1.5 Mbps ( low )", "12 Mbps ( full )", "480 Mbps ( high )",
+    "5 Gbps ( Gen1x1 )", "10 Gbps ( Gen2x1 )", "20 Gbps ( Gen2x2 )"
+};
+
+#define AUDIT_SPEEDS        ( sizeof( auditspeeds ) / sizeof( const char* ) )
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void audit_sgr( bool color, const char* sgr )
+{
+    if ( color == true )
+        ob_puts( sgr );
+}
+
+static const char* audit_speedname( uint8_t speed )
+{
+    return speed < AUDIT_SPEEDS ? auditspeeds[speed] : auditspeeds[0];
+}
+
+// faster link of same device, as SuperSpeed half of USB 3 hub.
+static bool audit_companion( const usbsnapshot* snap, size_t idx )
+{
+    const snapdev* pd = &snap->devs[idx];
+
+    if ( pd->bos.hascontainer == false )
+        return false;
+
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* po = &snap->devs[cnt];
+
+        if ( ( cnt != idx ) && ( po->bos.hascontainer == true )
+             && ( po->speed > pd->speed )
+             && ( memcmp( po->bos.containerid, pd->bos.containerid,
+                          USBDESC_CONTAINERLEN ) == 0 ) )
+            return true;
+    }
+
+    return false;
+}
+
+static void audit_header( const usbsnapshot* snap, const snapdev* pd, bool color )
+{
+    audit_sgr( color, AUDIT_SGR_LCYN );
+    ob_puts( "Bus " );
+    ob_dec( pd->bus, 3, '0' );
+    ob_puts( ", Port " );
+
+    for ( uint8_t cnt=0; cnt<pd->depth; cnt++ )
+    {
+        if ( cnt > 0 )
+            ob_putc( '.' );
+        ob_dec( pd->portpath[cnt] );
+    }
+
+    ob_puts( " [" );
+    ob_hex( pd->desc.idVendor, 4 );
+    ob_putc( ':' );
+    ob_hex( pd->desc.idProduct, 4 );
+    ob_puts( "] " );
+    audit_sgr( color, AUDIT_SGR_RST );
+
+    const char* mf = usbsnap_str( snap, pd->manufacturer );
+    const char* pr = usbsnap_str( snap, pd->product );
+
+    ob_puts( mf );
+    if ( ( *mf != 0 ) && ( *pr != 0 ) )
+        ob_puts( ", " );
+    ob_puts( pr );
+    ob_putc( '\n' );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t usbaudit_speed( const usbsnapshot* snap, bool color )
+{
+    if ( snap == NULL )
+        return 0;
+
+    size_t audited = 0;
+    size_t below   = 0;
+    size_t unknown = 0;
+
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+
+        // root hub is host controller itself.
+        if ( ( pd->descerr != 0 ) || ( pd->depth == 0 ) )
+            continue;
+
+        audited++;
+        audit_header( snap, pd, color );
+
+        ob_puts( "    + negotiated " );
+        ob_puts( audit_speedname( pd->speed ) );
+
+        // SuperSpeed device has BOS, and bcdUSB of 2.10 at least.
+        if ( ( pd->bos.read == false ) && ( libusb_cpu_to_le16( pd->desc.bcdUSB ) < 0x0201 ) )
+        {
+            ob_puts( ", no SuperSpeed before USB 2.01\n" );
+            continue;
+        }
+
+        if ( pd->bos.read == false )
+        {
+            unknown++;
+            ob_puts( pd->opened == false ? ", capability unknown, not opened\n"
+                                         : ", capability unknown\n" );
+            continue;
+        }
+
+        // as USB 2.0 extension only, no speed of it is below high.
+        if ( pd->bos.capspeed == 0 )
+        {
+            ob_puts( ", no SuperSpeed in BOS, capable of high speed at most : " );
+            audit_sgr( color, AUDIT_SGR_LGRN );
+            ob_puts( "ok" );
+            audit_sgr( color, AUDIT_SGR_RST );
+            ob_putc( '\n' );
+            continue;
+        }
+
+        ob_puts( ", capable of " );
+        ob_puts( audit_speedname( pd->bos.capspeed ) );
+        ob_puts( " : " );
+
+        if ( ( pd->speed == LIBUSB_SPEED_UNKNOWN ) || ( pd->speed >= pd->bos.capspeed ) )
+        {
+            audit_sgr( color, AUDIT_SGR_LGRN );
+            ob_puts( pd->speed == LIBUSB_SPEED_UNKNOWN ? "speed unknown" : "ok" );
+        }
+        else
+        if ( audit_companion( snap, cnt ) == true )
+        {
+            audit_sgr( color, AUDIT_SGR_LGRN );
+            ob_puts( "ok, slower link of faster device of same container" );
+        }
+        else
+        {
+            below++;
+            audit_sgr( color, AUDIT_SGR_LRED );
+            ob_puts( "BELOW CAPABILITY" );
+        }
+
+        audit_sgr( color, AUDIT_SGR_RST );
+        ob_putc( '\n' );
+    }
+
+    audit_sgr( color, below > 0 ? AUDIT_SGR_LRED : AUDIT_SGR_LYEL );
+    ob_dec( below );
+    ob_puts( " of " );
+    ob_dec( audited );
+    ob_puts( audited == 1 ? " device" : " devices" );
+    ob_puts( " running below capability" );
+
+    if ( unknown > 0 )
+    {
+        ob_puts( ", " );
+        ob_dec( unknown );
+        ob_puts( " of unknown capability" );
+    }
+
+    ob_puts( ".\n" );
+    audit_sgr( color, AUDIT_SGR_RST );
+
+    return below;
+}
@@ -0,0 +1,20 @@
+#ifndef __USBAUDIT_H__
+#define __USBAUDIT_H__
+
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Link speed audit, negotiated speed of each device against highest speed
+// of its BOS ( SuperSpeed and SuperSpeedPlus capabilities, lanes ). bcdUSB
+// tells nothing here, USB 3 device linked at high speed reports 2.10.
+// Device of lower speed than its capability is flagged, unless another
+// device of same Container ID runs faster, as USB 2 half of USB 3 hub.
+// Device of BOS without speed capability, as of USB 2.0 extension only,
+// is capable of high speed at most, never below. Device of BOS not read
+// is of unknown capability. Root hubs are not audited. Returns devices
+// running below capability.
+
+size_t usbaudit_speed( const usbsnapshot* snap, bool color );
+
+#endif /// of __USBAUDIT_H__
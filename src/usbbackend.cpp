@@ -0,0 +1,25 @@
+#include "usbbackend.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+const usbbackend usbbackend_libusb = {
+    "libusb",
+    true,
+    libusb_get_device_list,
+    libusb_free_device_list,
+    libusb_ref_device,
+    libusb_unref_device,
+    libusb_get_device_descriptor,
+    libusb_get_bus_number,
+    libusb_get_port_number,
+    libusb_get_device_address,
+    libusb_get_device_speed,
+    libusb_get_port_numbers,
+    libusb_open,
+    libusb_close,
+    libusb_control_transfer,
+    libusb_get_config_descriptor,
+    libusb_free_config_descriptor,
+    NULL,
+    NULL
+};
@@ -0,0 +1,55 @@
+#ifndef __USBBACKEND_H__
+#define __USBBACKEND_H__
+
+#include <libusb.h>
+#include <cstdint>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// libusb calls used by enumeration, as same signatures of libusb. Another
+// backend ( usbmock ) gives its own objects through these opaque libusb
+// types, context of get_device_list() included. Asynchronous transfers
+// are only of libusb, async false makes enumeration read strings
+// synchronously. libusb gives config only as allocated tree, get_raw_config
+// is NULL for it, and get_active too, as libusb tells no alternate setting
+// of an interface not claimed.
+
+typedef struct _usbbackend {
+    const char* name;
+    bool        async;
+    ssize_t (LIBUSB_CALL *get_device_list)( libusb_context* ctx, libusb_device*** list );
+    void    (LIBUSB_CALL *free_device_list)( libusb_device** list, int unref );
+    libusb_device* (LIBUSB_CALL *ref_device)( libusb_device* dev );
+    void    (LIBUSB_CALL *unref_device)( libusb_device* dev );
+    int     (LIBUSB_CALL *get_device_descriptor)( libusb_device* dev,
+                                                  libusb_device_descriptor* desc );
+    uint8_t (LIBUSB_CALL *get_bus_number)( libusb_device* dev );
+    uint8_t (LIBUSB_CALL *get_port_number)( libusb_device* dev );
+    uint8_t (LIBUSB_CALL *get_device_address)( libusb_device* dev );
+    int     (LIBUSB_CALL *get_device_speed)( libusb_device* dev );
+    int     (LIBUSB_CALL *get_port_numbers)( libusb_device* dev, uint8_t* ports, int len );
+    int     (LIBUSB_CALL *open)( libusb_device* dev, libusb_device_handle** handle );
+    void    (LIBUSB_CALL *close)( libusb_device_handle* handle );
+    int     (LIBUSB_CALL *control_transfer)( libusb_device_handle* handle,
+                                             uint8_t reqtype, uint8_t req,
+                                             uint16_t value, uint16_t index,
+                                             unsigned char* data, uint16_t len,
+                                             unsigned int timeout );
+    int     (LIBUSB_CALL *get_config_descriptor)( libusb_device* dev, uint8_t idx,
+                                                  libusb_config_descriptor** cfg );
+    void    (LIBUSB_CALL *free_config_descriptor)( libusb_config_descriptor* cfg );
+    // raw config descriptor kept by backend, without device I/O. NULL when
+    // backend has none, config is read by get_config_descriptor() then.
+    int     (LIBUSB_CALL *get_raw_config)( libusb_device* dev, uint8_t idx,
+                                           const uint8_t** raw, size_t* len );
+    // active configuration value and current alternate setting of each
+    // interface number of it, without device I/O. NULL when backend has
+    // none, enumeration reads them of sysfs then.
+    int     (LIBUSB_CALL *get_active)( libusb_device* dev, uint8_t* cfgval,
+                                       uint8_t* alts, size_t altslen );
+}usbbackend;
+
+extern const usbbackend usbbackend_libusb;
+
+#endif /// of __USBBACKEND_H__
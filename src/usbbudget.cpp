@@ -0,0 +1,490 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "outbuf.h"
+#include "usbdesc.h"
+#include "usbbudget.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define BUDGET_SGR_RST      "\033[0m"
+#define BUDGET_SGR_LRED     "\033[91m"
+#define BUDGET_SGR_LGRN     "\033[92m"
+#define BUDGET_SGR_LYEL     "\033[93m"
+#define BUDGET_SGR_LCYN     "\033[96m"
+
+#define BW_FULL             0   /// 1 ms frame, low and full speed devices.
+#define BW_HIGH             1   /// 125 us microframe.
+#define BW_SUPER            2   /// 125 us bus interval, each link.
+#define BW_KINDS            3
+#define BW_NOKIND           -1
+
+// ns, as usb_calc_bus_time() of Linux for USB 2.0 5.11.3.
+#define BW_HOST_DELAY       1000
+#define BW_HUB_LS_SETUP     333
+#define BW_USB2_HOST_DELAY  5
+#define BW_BITTIME( _b_ )   ( 7 * 8 * (uint64_t)(_b_) / 6 )     /// worst bit stuffing.
+
+#define BW_NOALT            ( (size_t)-1 )
+#define BW_ROOTPORTS        256
+
+typedef struct _bwload {
+    uint64_t    ps[BW_KINDS];   /// per frame or microframe, averaged.
+}bwload;
+
+static const char* bwkinds[BW_KINDS] = {
+    "full speed frame", "high speed microframe", "SuperSpeed bus interval"
+};
+
+static const uint64_t bwlimits[BW_KINDS] = { 900000000, 100000000, 112500000 };  /// ps.
+static const uint32_t bwunits[BW_KINDS]  = { 1000, 125, 125 };          /// us.
+
+static const char* bwtypes[] = {
+    "control", "isochronous", "bulk", "interrupt"
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void budget_sgr( bool color, const char* sgr )
+{
+    if ( color == true )
+        ob_puts( sgr );
+}
+
+static int bw_kind( uint8_t speed )
+{
+    switch( speed )
+    {
+        case LIBUSB_SPEED_LOW:
+        case LIBUSB_SPEED_FULL:
+            return BW_FULL;
+
+        case LIBUSB_SPEED_HIGH:
+            return BW_HIGH;
+
+        case LIBUSB_SPEED_UNKNOWN:
+            return BW_NOKIND;
+    }
+
+    return BW_SUPER;
+}
+
+// one transaction of bytes.
+static uint64_t bw_usb2ns( uint8_t speed, bool isin, bool iso, uint32_t bytes )
+{
+    uint64_t bits = BW_BITTIME( bytes );
+
+    if ( speed == LIBUSB_SPEED_LOW )
+    {
+        if ( isin == true )
+            return 64060 + 2 * BW_HUB_LS_SETUP + BW_HOST_DELAY + 67667 * ( 31 + 10 * bits ) / 1000;
+
+        return 64107 + 2 * BW_HUB_LS_SETUP + BW_HOST_DELAY + 66700 * ( 31 + 10 * bits ) / 1000;
+    }
+
+    if ( speed == LIBUSB_SPEED_FULL )
+    {
+        uint64_t tmp = 8354 * ( 31 + 10 * bits ) / 1000;
+
+        if ( iso == true )
+            return ( isin == true ? 7268 : 6265 ) + BW_HOST_DELAY + tmp;
+
+        return 9107 + BW_HOST_DELAY + tmp;
+    }
+
+    return ( ( iso == true ? 38 : 55 ) * 8 * 2083 + 2083 * ( 3 + bits ) ) / 1000
+           + BW_USB2_HOST_DELAY;
+}
+
+// bytes of one interval in packets, at ps per byte of link.
+static uint64_t bw_ssns( uint8_t speed, uint32_t bytes, uint16_t maxpacket )
+{
+    uint64_t psbyte  = 2000;    /// 8b/10b of 5 Gbps.
+    uint64_t packets = maxpacket > 0 ? ( bytes + maxpacket - 1 ) / maxpacket : 1;
+
+    // 128b/132b of 10 Gbps, two lanes of Gen2x2.
+    if ( speed == LIBUSB_SPEED_SUPER_PLUS )
+        psbyte = 825;
+    else
+    if ( speed > LIBUSB_SPEED_SUPER_PLUS )
+        psbyte = 413;
+
+    return ( bytes + packets * USBDESC_SSPKTOVERHEAD ) * psbyte / 1000;
+}
+
+// ps per frame or microframe of kind, 0 for control and bulk. Averaged
+// in ps, endpoint of long interval is never rounded to nothing.
+static uint64_t bw_epps( uint8_t speed, const usbsnapshot* snap, const snapep* pe,
+                         usbdescep* pde )
+{
+    usbdesc_endpoint( speed, pe->bmAttributes, pe->wMaxPacketSize, pe->bInterval,
+                      usbsnap_bytes( snap, pe->extra ), pe->extralen, pde );
+
+    if ( ( pde->interval == 0 ) || ( pde->bytes == 0 ) )
+        return 0;
+
+    int      kind = bw_kind( speed );
+    bool     isin = ( ( pe->bEndpointAddress & LIBUSB_ENDPOINT_IN ) != 0 );
+    bool     iso  = ( pde->type == LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS );
+    uint64_t ns   = 0;
+
+    if ( kind == BW_SUPER )
+        ns = bw_ssns( speed, pde->bytes, pde->maxpacket );
+    else
+        ns = bw_usb2ns( speed, isin, iso, pde->maxpacket ) * pde->mult;
+
+    return ns * 1000 * bwunits[kind] / pde->interval;
+}
+
+static uint64_t bw_altps( const usbsnapshot* snap, uint8_t speed, const snapalt* pa )
+{
+    uint64_t ps = 0;
+
+    for ( uint32_t cnt=0; cnt<pa->bNumEndpoints; cnt++ )
+    {
+        usbdescep de;
+        ps += bw_epps( speed, snap, &snap->eps[pa->epfirst + cnt], &de );
+    }
+
+    return ps;
+}
+
+// configured one, or first one when not read.
+static const snapcfg* bw_config( const usbsnapshot* snap, const snapdev* pd )
+{
+    for ( uint32_t cnt=0; cnt<pd->cfgcount; cnt++ )
+    {
+        const snapcfg* pc = &snap->cfgs[pd->cfgfirst + cnt];
+
+        if ( pc->valid == false )
+            continue;
+
+        if ( ( pd->active == false ) || ( pc->bConfigurationValue == pd->actconfig ) )
+            return pc;
+    }
+
+    return NULL;
+}
+
+// current alternate setting, or largest one of budget when not read.
+static size_t bw_alt( const usbsnapshot* snap, const snapdev* pd, const snapif* pi )
+{
+    size_t   found = BW_NOALT;
+    uint64_t maxps = 0;
+
+    for ( uint32_t cnt=0; cnt<pi->altcount; cnt++ )
+    {
+        size_t idx = pi->altfirst + cnt;
+
+        if ( pi->curalt != ALT_UNKNOWN )
+        {
+            if ( snap->alts[idx].bAlternateSetting == pi->curalt )
+                return idx;
+            continue;
+        }
+
+        uint64_t ps = bw_altps( snap, pd->speed, &snap->alts[idx] );
+        if ( ( found == BW_NOALT ) || ( ps > maxps ) )
+        {
+            found = idx;
+            maxps = ps;
+        }
+    }
+
+    return found;
+}
+
+// rounded to 0.1 us.
+static void bw_us( uint64_t ps )
+{
+    uint64_t tenths = ( ps + 50000 ) / 100000;
+
+    ob_dec( tenths / 10 );
+    ob_putc( '.' );
+    ob_dec( tenths % 10 );
+    ob_puts( " us" );
+}
+
+static void bw_interval( uint32_t us )
+{
+    if ( ( us >= 1000 ) && ( ( us % 1000 ) == 0 ) )
+    {
+        ob_dec( us / 1000 );
+        ob_puts( " ms" );
+        return;
+    }
+
+    ob_dec( us );
+    ob_puts( " us" );
+}
+
+static void bw_header( const usbsnapshot* snap, const snapdev* pd, bool color )
+{
+    ob_puts( "    " );
+    budget_sgr( color, BUDGET_SGR_LCYN );
+    ob_puts( "Port " );
+
+    for ( uint8_t cnt=0; cnt<pd->depth; cnt++ )
+    {
+        if ( cnt > 0 )
+            ob_putc( '.' );
+        ob_dec( pd->portpath[cnt] );
+    }
+
+    ob_puts( " [" );
+    ob_hex( pd->desc.idVendor, 4 );
+    ob_putc( ':' );
+    ob_hex( pd->desc.idProduct, 4 );
+    ob_puts( "] " );
+    budget_sgr( color, BUDGET_SGR_RST );
+
+    const char* mf = usbsnap_str( snap, pd->manufacturer );
+    const char* pr = usbsnap_str( snap, pd->product );
+
+    ob_puts( mf );
+    if ( ( *mf != 0 ) && ( *pr != 0 ) )
+        ob_puts( ", " );
+    ob_puts( pr );
+
+    if ( pd->active == false )
+        ob_puts( " ( alternate settings not read, largest ones )" );
+
+    ob_putc( '\n' );
+}
+
+static void bw_epline( const snapalt* pa, const snapep* pe, const usbdescep* pde, uint64_t ps, int kind )
+{
+    ob_puts( "        + EP 0x" );
+    ob_hex( pe->bEndpointAddress, 2 );
+    ob_puts( ( pe->bEndpointAddress & LIBUSB_ENDPOINT_IN ) ? " IN " : " OUT " );
+    ob_puts( bwtypes[pde->type] );
+    ob_puts( ", " );
+    ob_dec( pde->bytes );
+    ob_puts( pde->bytes == 1 ? " byte" : " bytes" );
+
+    if ( ( kind == BW_SUPER ) && ( pde->companion == false ) && ( pde->mult * pde->burst > 1 ) )
+    {
+        ob_puts( " ( " );
+        ob_dec( pde->mult );
+        ob_puts( " x " );
+        ob_dec( pde->burst );
+        ob_puts( " x " );
+        ob_dec( pde->maxpacket );
+        ob_puts( " )" );
+    }
+    else
+    if ( ( kind == BW_HIGH ) && ( pde->mult > 1 ) )
+    {
+        ob_puts( " ( " );
+        ob_dec( pde->mult );
+        ob_puts( " x " );
+        ob_dec( pde->maxpacket );
+        ob_puts( " )" );
+    }
+
+    ob_puts( " every " );
+    bw_interval( pde->interval );
+    ob_puts( ", interface " );
+    ob_dec( pa->bInterfaceNumber );
+    if ( pa->bAlternateSetting > 0 )
+    {
+        ob_puts( " alt " );
+        ob_dec( pa->bAlternateSetting );
+    }
+    ob_puts( " : " );
+    bw_us( ps );
+    ob_puts( kind == BW_FULL ? " per frame\n"
+                             : kind == BW_HIGH ? " per microframe\n" : " per bus interval\n" );
+}
+
+// endpoints counted of device into load, false when none is periodic.
+static bool bw_device( const usbsnapshot* snap, const snapdev* pd, bwload* pl, bool color )
+{
+    int kind = bw_kind( pd->speed );
+    const snapcfg* pc = bw_config( snap, pd );
+
+    if ( ( kind == BW_NOKIND ) || ( pc == NULL ) )
+        return false;
+
+    bool shown = false;
+
+    for ( uint32_t x=0; x<pc->bNumInterfaces; x++ )
+    {
+        const snapif* pi = &snap->ifs[pc->iffirst + x];
+        size_t idx = bw_alt( snap, pd, pi );
+
+        if ( idx == BW_NOALT )
+            continue;
+
+        const snapalt* pa = &snap->alts[idx];
+
+        for ( uint32_t z=0; z<pa->bNumEndpoints; z++ )
+        {
+            const snapep* pe = &snap->eps[pa->epfirst + z];
+            usbdescep de;
+            uint64_t  ps = bw_epps( pd->speed, snap, pe, &de );
+
+            if ( de.interval == 0 )
+                continue;
+
+            if ( shown == false )
+            {
+                bw_header( snap, pd, color );
+                shown = true;
+            }
+
+            bw_epline( pa, pe, &de, ps, kind );
+            pl->ps[kind] += ps;
+        }
+    }
+
+    return shown;
+}
+
+// returns true when over limit.
+static bool bw_row( const char* name, uint32_t num, int kind, uint64_t ps, bool color )
+{
+    uint64_t limit = bwlimits[kind];
+    bool     over  = ( ps > limit );
+    uint64_t pml   = ( ps * 1000 + limit / 2 ) / limit;
+
+    ob_puts( "    + " );
+    ob_puts( name );
+    ob_putc( ' ' );
+    ob_dec( num );
+    ob_puts( ", " );
+    ob_puts( bwkinds[kind] );
+    ob_puts( " : " );
+    bw_us( ps );
+    ob_puts( " of " );
+    bw_us( limit );
+    ob_puts( " ( " );
+    ob_dec( pml / 10 );
+    ob_putc( '.' );
+    ob_dec( pml % 10 );
+    ob_puts( " % ), " );
+
+    if ( over == true )
+    {
+        budget_sgr( color, BUDGET_SGR_LRED );
+        ob_puts( "OVER by " );
+        bw_us( ps - limit );
+    }
+    else
+    {
+        budget_sgr( color, pml >= 900 ? BUDGET_SGR_LYEL : BUDGET_SGR_LGRN );
+        bw_us( limit - ps );
+        ob_puts( " left" );
+    }
+
+    budget_sgr( color, BUDGET_SGR_RST );
+    ob_putc( '\n' );
+
+    return over;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t usbbudget_bandwidth( const usbsnapshot* snap, bool color )
+{
+    if ( snap == NULL )
+        return 0;
+
+    bool buses[256] = {0};
+
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        buses[ snap->devs[cnt].bus ] = true;
+    }
+
+    size_t over    = 0;
+    size_t periods = 0;
+
+    for ( size_t bus=0; bus<256; bus++ )
+    {
+        if ( buses[bus] == false )
+            continue;
+
+        bwload ports[BW_ROOTPORTS];
+        bwload total;
+        memset( ports, 0, sizeof( ports ) );
+        memset( &total, 0, sizeof( bwload ) );
+
+        budget_sgr( color, BUDGET_SGR_LCYN );
+        ob_puts( "Bus " );
+        ob_dec( bus, 3, '0' );
+        budget_sgr( color, BUDGET_SGR_RST );
+        ob_putc( '\n' );
+
+        bool any = false;
+
+        for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+        {
+            const snapdev* pd = &snap->devs[cnt];
+
+            // root hub is host controller itself.
+            if ( ( pd->bus != bus ) || ( pd->descerr != 0 ) || ( pd->depth == 0 ) )
+                continue;
+
+            bwload dl;
+            memset( &dl, 0, sizeof( bwload ) );
+
+            if ( bw_device( snap, pd, &dl, color ) == false )
+                continue;
+
+            any = true;
+
+            uint8_t rp = pd->portpath[0];
+
+            for ( int kind=0; kind<BW_KINDS; kind++ )
+            {
+                ports[rp].ps[kind] += dl.ps[kind];
+                total.ps[kind]     += dl.ps[kind];
+            }
+        }
+
+        if ( any == false )
+        {
+            ob_puts( "    no periodic endpoints.\n" );
+            continue;
+        }
+
+        for ( size_t rp=1; rp<BW_ROOTPORTS; rp++ )
+        {
+            for ( int kind=0; kind<BW_KINDS; kind++ )
+            {
+                if ( ports[rp].ps[kind] == 0 )
+                    continue;
+
+                periods++;
+                if ( bw_row( "root port", rp, kind, ports[rp].ps[kind], color ) == true )
+                    over++;
+            }
+        }
+
+        // SuperSpeed is routed, no bus shares it.
+        for ( int kind=0; kind<BW_SUPER; kind++ )
+        {
+            if ( total.ps[kind] == 0 )
+                continue;
+
+            periods++;
+            if ( bw_row( "bus", bus, kind, total.ps[kind], color ) == true )
+                over++;
+        }
+    }
+
+    budget_sgr( color, over > 0 ? BUDGET_SGR_LRED : BUDGET_SGR_LYEL );
+    ob_dec( over );
+    ob_puts( " of " );
+    ob_dec( periods );
+    ob_puts( periods == 1 ? " budget" : " budgets" );
+    ob_puts( " over periodic limit.\n" );
+    budget_sgr( color, BUDGET_SGR_RST );
+
+    return over;
+}
@@ -0,0 +1,20 @@
+#ifndef __USBBUDGET_H__
+#define __USBBUDGET_H__
+
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Periodic bandwidth budget, bus time reserved by interrupt and
+// isochronous endpoints of current alternate settings ( largest one of
+// each interface when not read ), spread over their intervals as host
+// schedules them. Time of each transaction is of USB 2.0 5.11.3 for low,
+// full and high speed, and of payload with packet framing at link rate
+// for SuperSpeed. Budgets are of USB spec periodic limits : 90% of full
+// speed frame, 80% of high speed microframe and 90% of SuperSpeed bus
+// interval. Each root port is its own budget on xHCI, whole bus is one
+// on EHCI and OHCI, both are shown. Returns budgets over limit.
+
+size_t usbbudget_bandwidth( const usbsnapshot* snap, bool color );
+
+#endif /// of __USBBUDGET_H__
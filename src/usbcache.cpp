@@ -0,0 +1,389 @@
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /// of _WIN32
+
+#include "usbcache.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define CACHE_MAGIC         "LUSBCACH"
+#define CACHE_VERSION       2       /// 2 : strings as UTF-8, not ASCII.
+#define CACHE_PATHMAX       512
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _cachehdr {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    entsize;
+    uint32_t    count;
+    uint32_t    reserved;
+}cachehdr;
+
+typedef struct _cacheent {
+    uint8_t                     bus;
+    uint8_t                     devnum;
+    uint8_t                     depth;
+    uint8_t                     portpath[MAX_PORTDEPTH];
+    libusb_device_descriptor    desc;
+    char                        manufacturer[SLEN_MANUFACTURER];
+    char                        product[SLEN_PRODUCT];
+    char                        serialnumber[SLEN_SN];
+}cacheent;
+
+struct _usbcache {
+    uint8_t*                            map;
+    size_t                              mapsz;
+    const cacheent*                     ents;
+    size_t                              count;
+    unordered_map< uint64_t, size_t >   index;
+    char                                path[CACHE_PATHMAX];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t cache_key( uint8_t bus, uint8_t devnum, uint8_t depth,
+                           const uint8_t* portpath, uint16_t vid, uint16_t pid )
+{
+    // FNV-1a over location and identity, full compare done at hit.
+    uint64_t h = 0xCBF29CE484222325ULL;
+    uint8_t  k[6 + MAX_PORTDEPTH] = {0};
+
+    k[0] = bus;
+    k[1] = devnum;
+    k[2] = vid & 0xFF;
+    k[3] = vid >> 8;
+    k[4] = pid & 0xFF;
+    k[5] = pid >> 8;
+    memcpy( &k[6], portpath, depth < MAX_PORTDEPTH ? depth : MAX_PORTDEPTH );
+
+    for ( size_t cnt=0; cnt<sizeof( k ); cnt++ )
+    {
+        h ^= k[cnt];
+        h *= 0x100000001B3ULL;
+    }
+
+    return h ^ depth;
+}
+
+static bool cache_match( const cacheent* pe, const usbdevfetch* pf )
+{
+    if ( ( pe->bus != pf->bus ) || ( pe->devnum != pf->devnum )
+         || ( pe->depth != pf->depth ) )
+        return false;
+
+    if ( memcmp( pe->portpath, pf->portpath, pf->depth ) != 0 )
+        return false;
+
+    return ( memcmp( &pe->desc, &pf->desc, sizeof( libusb_device_descriptor ) ) == 0 );
+}
+
+bool usbcache_rundir( char* path, size_t len )
+{
+    const char* rtdir = getenv( "XDG_RUNTIME_DIR" );
+
+    if ( ( rtdir != NULL ) && ( rtdir[0] != 0 ) )
+    {
+        snprintf( path, len, "%s", rtdir );
+        return true;
+    }
+
+#ifndef _WIN32
+    // any user may make it first, used only when it is ours and private.
+    snprintf( path, len, "/tmp/listusb-%u", (unsigned)getuid() );
+    mkdir( path, 0700 );
+
+    struct stat st;
+    if ( ( lstat( path, &st ) == 0 ) && ( S_ISDIR( st.st_mode ) )
+         && ( st.st_uid == getuid() ) && ( ( st.st_mode & 0077 ) == 0 ) )
+        return true;
+#endif
+
+    path[0] = 0;
+    return false;
+}
+
+void usbcache_defaultpath( char* path, size_t len )
+{
+#ifndef _WIN32
+    char dir[CACHE_PATHMAX] = {0};
+
+    // no cache rather than one of other user.
+    if ( usbcache_rundir( dir, CACHE_PATHMAX ) == false )
+    {
+        path[0] = 0;
+        return;
+    }
+
+    snprintf( path, len, "%s/listusb.cache", dir );
+#else
+    snprintf( path, len, "listusb.cache" );
+#endif
+}
+
+#ifndef _WIN32
+
+static void cache_unmap( usbcache* uc )
+{
+    if ( uc->map != NULL )
+    {
+        munmap( uc->map, uc->mapsz );
+        uc->map = NULL;
+    }
+
+    uc->mapsz = 0;
+    uc->ents  = NULL;
+    uc->count = 0;
+    uc->index.clear();
+}
+
+static void cache_map( usbcache* uc )
+{
+    cache_unmap( uc );
+
+    // missing cache file is not an error, will be created at update.
+    if ( uc->path[0] == 0 )
+        return;
+
+    int fd = open( uc->path, O_RDONLY | O_NOFOLLOW );
+    if ( fd < 0 )
+        return;
+
+    // strings of file written by other user are never shown.
+    struct stat st;
+    if ( ( fstat( fd, &st ) == 0 ) && ( S_ISREG( st.st_mode ) )
+         && ( st.st_uid == getuid() ) && ( ( st.st_mode & ( S_IWGRP | S_IWOTH ) ) == 0 )
+         && ( st.st_size >= (off_t)sizeof( cachehdr ) ) )
+    {
+        void* pm = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+        if ( pm != MAP_FAILED )
+        {
+            uc->map   = (uint8_t*)pm;
+            uc->mapsz = st.st_size;
+        }
+    }
+
+    close( fd );
+
+    if ( uc->map != NULL )
+    {
+        const cachehdr* ph = (const cachehdr*)uc->map;
+
+        // any mismatch makes whole cache to be rebuilt.
+        if ( ( memcmp( ph->magic, CACHE_MAGIC, 8 ) == 0 )
+             && ( ph->version == CACHE_VERSION )
+             && ( ph->entsize == sizeof( cacheent ) )
+             && ( sizeof( cachehdr ) + (size_t)ph->count * sizeof( cacheent ) <= uc->mapsz ) )
+        {
+            uc->ents  = (const cacheent*)( uc->map + sizeof( cachehdr ) );
+            uc->count = ph->count;
+
+            for ( size_t cnt=0; cnt<uc->count; cnt++ )
+            {
+                const cacheent* pe = &uc->ents[cnt];
+                uint64_t k = cache_key( pe->bus, pe->devnum, pe->depth, pe->portpath,
+                                        pe->desc.idVendor, pe->desc.idProduct );
+                uc->index[k] = cnt;
+            }
+        }
+    }
+}
+
+usbcache* usbcache_open( const char* path )
+{
+    usbcache* uc = new usbcache();
+
+    if ( path == NULL )
+        usbcache_defaultpath( uc->path, CACHE_PATHMAX );
+    else
+        snprintf( uc->path, CACHE_PATHMAX, "%s", path );
+
+    cache_map( uc );
+
+    return uc;
+}
+
+// entry of same device, NULL when none.
+static const cacheent* cache_find( const usbcache* uc, const usbdevfetch* pf )
+{
+    if ( uc->count == 0 )
+        return NULL;
+
+    uint64_t k = cache_key( pf->bus, pf->devnum, pf->depth, pf->portpath,
+                            pf->desc.idVendor, pf->desc.idProduct );
+
+    unordered_map< uint64_t, size_t >::const_iterator it = uc->index.find( k );
+    if ( it == uc->index.end() )
+        return NULL;
+
+    const cacheent* pe = &uc->ents[it->second];
+    if ( cache_match( pe, pf ) == false )
+        return NULL;
+
+    return pe;
+}
+
+bool usbcache_lookup( const usbcache* uc, usbdevfetch* pf )
+{
+    if ( ( uc == NULL ) || ( pf == NULL ) )
+        return false;
+
+    const cacheent* pe = cache_find( uc, pf );
+    if ( pe == NULL )
+        return false;
+
+    memcpy( pf->manufacturer, pe->manufacturer, SLEN_MANUFACTURER );
+    memcpy( pf->product, pe->product, SLEN_PRODUCT );
+    memcpy( pf->serialnumber, pe->serialnumber, SLEN_SN );
+    pf->manufacturer[SLEN_MANUFACTURER - 1] = 0;
+    pf->product[SLEN_PRODUCT - 1] = 0;
+    pf->serialnumber[SLEN_SN - 1] = 0;
+
+    return true;
+}
+
+bool usbcache_update( usbcache* uc, const usbfetchlist& ufl )
+{
+    if ( ( uc == NULL ) || ( uc->path[0] == 0 ) )
+        return false;
+
+    // cache keeps only currently connected devices,
+    // anything unplugged or re-plugged is dropped here.
+    vector< cacheent > ents;
+    size_t hits = 0;
+
+    for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+    {
+        const usbdevfetch* pf = &ufl[cnt];
+
+        if ( pf->descerr != 0 )
+            continue;
+
+        // strings not fully read are never stored, entry read before
+        // stays for device not read this time, as not reached by deadline.
+        if ( ( pf->opened == false ) || ( pf->timedout == true ) || ( pf->strerr == true ) )
+        {
+            const cacheent* pe = cache_find( uc, pf );
+            if ( pe != NULL )
+            {
+                ents.push_back( *pe );
+                hits++;
+            }
+            continue;
+        }
+
+        if ( pf->fromcache == true )
+            hits++;
+
+        cacheent ent;
+        memset( &ent, 0, sizeof( cacheent ) );
+        ent.bus    = pf->bus;
+        ent.devnum = pf->devnum;
+        ent.depth  = pf->depth;
+        memcpy( ent.portpath, pf->portpath, MAX_PORTDEPTH );
+        memcpy( &ent.desc, &pf->desc, sizeof( libusb_device_descriptor ) );
+        memcpy( ent.manufacturer, pf->manufacturer, SLEN_MANUFACTURER );
+        memcpy( ent.product, pf->product, SLEN_PRODUCT );
+        memcpy( ent.serialnumber, pf->serialnumber, SLEN_SN );
+        ents.push_back( ent );
+    }
+
+    // nothing changed, no need to write.
+    if ( ( hits == ents.size() ) && ( hits == uc->count ) )
+        return true;
+
+    // writes new file and replaces old one, other process may still
+    // have old one mapped.
+    // new name of mkstemp(), never a file made by other user.
+    char tmppath[CACHE_PATHMAX + 32] = {0};
+    snprintf( tmppath, sizeof( tmppath ), "%s.XXXXXX", uc->path );
+
+    int fd = mkstemp( tmppath );
+    if ( fd < 0 )
+        return false;
+
+    size_t newsz = sizeof( cachehdr ) + ents.size() * sizeof( cacheent );
+    bool   retb  = false;
+
+    if ( ftruncate( fd, newsz ) == 0 )
+    {
+        void* pm = mmap( NULL, newsz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+        if ( pm != MAP_FAILED )
+        {
+            cachehdr* ph = (cachehdr*)pm;
+            memcpy( ph->magic, CACHE_MAGIC, 8 );
+            ph->version  = CACHE_VERSION;
+            ph->entsize  = sizeof( cacheent );
+            ph->count    = ents.size();
+            ph->reserved = 0;
+
+            if ( ents.size() > 0 )
+            {
+                memcpy( (uint8_t*)pm + sizeof( cachehdr ), ents.data(),
+                        ents.size() * sizeof( cacheent ) );
+            }
+
+            munmap( pm, newsz );
+            retb = true;
+        }
+    }
+
+    close( fd );
+
+    if ( ( retb == false ) || ( rename( tmppath, uc->path ) != 0 ) )
+    {
+        unlink( tmppath );
+        return false;
+    }
+
+    // same handle may be used for next enumeration.
+    cache_map( uc );
+
+    return true;
+}
+
+void usbcache_close( usbcache* uc )
+{
+    if ( uc != NULL )
+    {
+        cache_unmap( uc );
+        delete uc;
+    }
+}
+
+#else /// of _WIN32
+
+usbcache* usbcache_open( const char* path )
+{
+    return NULL;
+}
+
+bool usbcache_lookup( const usbcache* uc, usbdevfetch* pf )
+{
+    return false;
+}
+
+bool usbcache_update( usbcache* uc, const usbfetchlist& ufl )
+{
+    return false;
+}
+
+void usbcache_close( usbcache* uc )
+{
+}
+
+#endif /// of _WIN32
@@ -0,0 +1,28 @@
+#ifndef __USBCACHE_H__
+#define __USBCACHE_H__
+
+#include "usbfetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Persistent, memory-mapped cache of device strings. Each entry is keyed
+// by bus, port path, device address and whole device descriptor, so a
+// re-plugged device ( new address ) never hits an old entry. Strings of
+// a device timed out or failed to be read are never stored, entry read
+// before is kept instead. File of other user, or writable by others,
+// is never read.
+// Lookup may be called from many threads, open, update and close not.
+
+typedef struct _usbcache usbcache;
+
+usbcache* usbcache_open( const char* path = NULL );
+bool usbcache_lookup( const usbcache* uc, usbdevfetch* pf );
+bool usbcache_update( usbcache* uc, const usbfetchlist& ufl );
+void usbcache_close( usbcache* uc );
+// XDG_RUNTIME_DIR, or /tmp/listusb-<uid> made as private directory.
+// False when it is not a directory of this user only, left empty.
+bool usbcache_rundir( char* path, size_t len );
+// listusb.cache of usbcache_rundir(), empty for none.
+void usbcache_defaultpath( char* path, size_t len );
+
+#endif /// of __USBCACHE_H__
@@ -0,0 +1,389 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#endif /// of _WIN32
+
+#include "usbdaemon.h"
+#include "usbdump.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define DAEMON_BACKLOG      64
+#define DAEMON_RECVTIMEOUT  2       /// seconds a client waits for image.
+#define DAEMON_SENDTIMEOUT  5       /// seconds a sender waits for a client.
+#define DAEMON_MAXSENDERS   64      /// clients served at once.
+#define DAEMON_READSZ       65536
+#define DAEMON_PATHMAX      512
+
+typedef shared_ptr< const vector< uint8_t > >  daemonimage;
+
+typedef struct _daemonevt {
+    libusb_device*          device;
+    libusb_hotplug_event    event;
+}daemonevt;
+
+typedef struct _daemonstate {
+    libusb_context*         ctx;
+    const usbenumopt*       opt;
+    usbfetchlist            known;      /// device referenced, libusb order.
+    vector< daemonevt >     events;
+    mutex                   imagelock;
+    daemonimage             image;
+    uint64_t                retryat;    /// usbstats_now() to read stale records, or 0.
+}daemonstate;
+
+static volatile sig_atomic_t    daemonquit = 0;
+static atomic< unsigned >       daemonsenders( 0 );
+
+////////////////////////////////////////////////////////////////////////////////
+
+void usbdaemon_defaultpath( char* path, size_t len )
+{
+    char dir[DAEMON_PATHMAX] = {0};
+
+    // same private directory as cache, none when it is not ours.
+    if ( usbcache_rundir( dir, DAEMON_PATHMAX ) == true )
+    {
+        snprintf( path, len, "%s/%s", dir, USBDAEMON_SOCKNAME );
+    }
+    else
+    {
+#ifndef _WIN32
+        path[0] = 0;
+#else
+        snprintf( path, len, USBDAEMON_SOCKNAME );
+#endif
+    }
+}
+
+#ifndef _WIN32
+
+static void daemonsig( int signo )
+{
+    daemonquit = 1;
+}
+
+static int LIBUSB_CALL daemoncb( libusb_context* ctx, libusb_device* device,
+                                 libusb_hotplug_event event, void* user_data )
+{
+    // no device I/O in callback, handled by daemon_sync().
+    daemonstate* pds = (daemonstate*)user_data;
+
+    daemonevt evt;
+    evt.device = libusb_ref_device( device );
+    evt.event  = event;
+    pds->events.push_back( evt );
+
+    return 0;
+}
+
+// known records follow libusb device list, only new devices are read.
+static void daemon_sync( daemonstate* pds )
+{
+    // arrived again may be same libusb_device, read it as new.
+    for ( size_t cnt=0; cnt<pds->events.size(); cnt++ )
+    {
+        usbenum_syncdrop( pds->known, pds->events[cnt].device );
+        libusb_unref_device( pds->events[cnt].device );
+    }
+    pds->events.clear();
+
+    usbenum_sync( pds->ctx, pds->opt, pds->known );
+
+    pds->retryat = usbenum_syncretry( pds->opt, pds->known );
+
+    usbsnapshot snap;
+    usbsnap_build( snap, pds->known );
+
+    vector< uint8_t >* pimg = new vector< uint8_t >();
+    usbdump_encode( &snap, *pimg );
+
+    lock_guard< mutex > guard( pds->imagelock );
+    pds->image = daemonimage( pimg );
+}
+
+static bool daemon_sendall( int fd, const uint8_t* p, size_t len )
+{
+    while( len > 0 )
+    {
+        ssize_t wr = send( fd, p, len, 0 );
+        if ( wr < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            return false;
+        }
+
+        p   += wr;
+        len -= wr;
+    }
+
+    return true;
+}
+
+// each client by its own sender, one not reading never blocks others.
+static void daemon_send( int cfd, daemonimage img )
+{
+    struct timeval tv = { DAEMON_SENDTIMEOUT, 0 };
+    setsockopt( cfd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof( tv ) );
+
+    if ( img )
+        daemon_sendall( cfd, img->data(), img->size() );
+
+    close( cfd );
+    daemonsenders--;
+}
+
+static int daemon_listen( const char* path )
+{
+    struct sockaddr_un sa;
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sun_family = AF_UNIX;
+
+    if ( strlen( path ) >= sizeof( sa.sun_path ) )
+        return -1;
+
+    strcpy( sa.sun_path, path );
+
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 )
+        return -1;
+
+    // socket left by a daemon not quit cleanly.
+    unlink( path );
+
+    if ( ( bind( fd, (struct sockaddr*)&sa, sizeof( sa ) ) != 0 )
+         || ( listen( fd, DAEMON_BACKLOG ) != 0 ) )
+    {
+        close( fd );
+        return -1;
+    }
+
+    return fd;
+}
+
+bool usbdaemon_serve( libusb_context* ctx, const usbenumopt* opt, const char* path )
+{
+    if ( ( ctx == NULL ) || ( opt == NULL ) || ( path == NULL ) || ( path[0] == 0 ) )
+        return false;
+
+    int lfd = daemon_listen( path );
+    if ( lfd < 0 )
+        return false;
+
+    daemonstate ds;
+    ds.ctx   = ctx;
+    ds.opt   = opt;
+    ds.retryat = 0;
+
+    libusb_hotplug_callback_handle hph;
+    bool hotplug = false;
+
+    if ( libusb_has_capability( LIBUSB_CAP_HAS_HOTPLUG ) != 0 )
+    {
+        int usberr = libusb_hotplug_register_callback( ctx,
+                                                       LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED
+                                                       | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+                                                       (libusb_hotplug_flag)0,
+                                                       LIBUSB_HOTPLUG_MATCH_ANY,
+                                                       LIBUSB_HOTPLUG_MATCH_ANY,
+                                                       LIBUSB_HOTPLUG_MATCH_ANY,
+                                                       daemoncb, &ds, &hph );
+        hotplug = ( usberr == LIBUSB_SUCCESS );
+    }
+
+    // first clients already get every device.
+    daemon_sync( &ds );
+
+    daemonquit = 0;
+    signal( SIGINT, daemonsig );
+    signal( SIGTERM, daemonsig );
+    signal( SIGPIPE, SIG_IGN );
+
+    thread events( [&]()
+    {
+        while( daemonquit == 0 )
+        {
+            // sleeps in libusb until any event, wakes up every second to check quit.
+            struct timeval tv = { 1, 0 };
+            libusb_handle_events_timeout_completed( ctx, &tv, NULL );
+
+            // device busy or stalled at arrival gets no more event,
+            // read again only a few times after arrival.
+            bool retry = ( ds.retryat != 0 ) && ( usbstats_now() >= ds.retryat );
+
+            if ( ( hotplug == false ) || ( ds.events.size() > 0 ) || ( retry == true ) )
+            {
+                daemon_sync( &ds );
+            }
+        }
+    } );
+
+    while( daemonquit == 0 )
+    {
+        struct pollfd pfd = { lfd, POLLIN, 0 };
+        if ( poll( &pfd, 1, 1000 ) <= 0 )
+            continue;
+
+        int cfd = accept( lfd, NULL, NULL );
+        if ( cfd < 0 )
+            continue;
+
+        // too many clients not reading, refused as no daemon.
+        if ( daemonsenders >= DAEMON_MAXSENDERS )
+        {
+            close( cfd );
+            continue;
+        }
+
+        daemonimage img;
+        {
+            lock_guard< mutex > guard( ds.imagelock );
+            img = ds.image;
+        }
+
+        daemonsenders++;
+        thread( daemon_send, cfd, img ).detach();
+    }
+
+    events.join();
+
+    // senders end by their send timeout at most.
+    while( daemonsenders > 0 )
+        usleep( 10000 );
+
+    if ( hotplug == true )
+        libusb_hotplug_deregister_callback( ctx, hph );
+
+    for ( size_t cnt=0; cnt<ds.events.size(); cnt++ )
+    {
+        libusb_unref_device( ds.events[cnt].device );
+    }
+
+    usbenum_syncfree( ds.known );
+
+    close( lfd );
+    unlink( path );
+
+    return true;
+}
+
+// daemon of this user, or of root, never a socket bound by other user.
+static bool daemon_trusted( int fd )
+{
+    uid_t uid = (uid_t)-1;
+
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t    credlen = sizeof( cred );
+
+    if ( getsockopt( fd, SOL_SOCKET, SO_PEERCRED, &cred, &credlen ) != 0 )
+        return false;
+
+    uid = cred.uid;
+#else
+    gid_t gid;
+
+    if ( getpeereid( fd, &uid, &gid ) != 0 )
+        return false;
+#endif
+
+    return ( uid == getuid() ) || ( uid == 0 );
+}
+
+bool usbdaemon_fetch( const char* path, usbsnapshot& snap )
+{
+    usbsnap_clear( snap );
+
+    if ( ( path == NULL ) || ( path[0] == 0 ) )
+        return false;
+
+    struct sockaddr_un sa;
+    memset( &sa, 0, sizeof( sa ) );
+    sa.sun_family = AF_UNIX;
+
+    if ( strlen( path ) >= sizeof( sa.sun_path ) )
+        return false;
+
+    strcpy( sa.sun_path, path );
+
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 )
+        return false;
+
+    struct timeval tv = { DAEMON_RECVTIMEOUT, 0 };
+    setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof( tv ) );
+
+    if ( ( connect( fd, (struct sockaddr*)&sa, sizeof( sa ) ) != 0 )
+         || ( daemon_trusted( fd ) == false ) )
+    {
+        close( fd );
+        return false;
+    }
+
+    // image ends with connection closed by daemon.
+    vector< uint8_t > buff;
+    size_t            got = 0;
+    bool              retb = true;
+
+    for(;;)
+    {
+        buff.resize( got + DAEMON_READSZ );
+
+        ssize_t rd = recv( fd, buff.data() + got, DAEMON_READSZ, 0 );
+        if ( rd < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            retb = false;
+            break;
+        }
+
+        if ( rd == 0 )
+            break;
+
+        got += rd;
+    }
+
+    close( fd );
+
+    if ( retb == false )
+        return false;
+
+    return usbdump_decode( buff.data(), got, snap );
+}
+
+#else /// of _WIN32
+
+bool usbdaemon_serve( libusb_context* ctx, const usbenumopt* opt, const char* path )
+{
+    return false;
+}
+
+bool usbdaemon_fetch( const char* path, usbsnapshot& snap )
+{
+    return false;
+}
+
+#endif /// of _WIN32
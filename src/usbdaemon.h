@@ -0,0 +1,29 @@
+#ifndef __USBDAEMON_H__
+#define __USBDAEMON_H__
+
+#include "usbenum.h"
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// listusbd, one libusb context shared by every listusb client. Devices
+// are read once when arrived, hotplug events ( or a poll every second
+// without hotplug ) keep snapshot same as libusb device list. Snapshot is
+// kept encoded as usbdump image, so a client connected to Unix socket
+// only gets whole image and connection closed, then renders any view
+// as with --load. Each client is sent by its own thread, a client not
+// reading is dropped after a few seconds, never delaying others.
+
+#define USBDAEMON_SOCKNAME  "listusbd.sock"
+
+// listusbd.sock of usbcache_rundir(), empty when it is not private.
+void usbdaemon_defaultpath( char* path, size_t len );
+
+// serves until SIGINT or SIGTERM, false when socket cannot be made.
+bool usbdaemon_serve( libusb_context* ctx, const usbenumopt* opt, const char* path );
+
+// snapshot of daemon at path, false when none answered, or daemon is
+// not run by this user or root.
+bool usbdaemon_fetch( const char* path, usbsnapshot& snap );
+
+#endif /// of __USBDAEMON_H__
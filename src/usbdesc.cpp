@@ -0,0 +1,360 @@
+#include <cstring>
+
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t usbdesc_nextstd( const uint8_t* raw, size_t pos, size_t len )
+{
+    // skips class specific descriptors until interface, endpoint or config.
+    while( pos + 2 <= len )
+    {
+        uint8_t dt = raw[pos + 1];
+
+        if ( ( raw[pos] < 2 ) || ( dt == LIBUSB_DT_INTERFACE )
+             || ( dt == LIBUSB_DT_ENDPOINT ) || ( dt == LIBUSB_DT_CONFIG ) )
+            break;
+
+        pos += raw[pos];
+    }
+
+    if ( pos > len )
+        pos = len;
+
+    return pos;
+}
+
+// view of standard descriptor at pos, extra until next standard one.
+static void desc_view( usbdesciter* it, size_t pos, usbdescview* pv )
+{
+    size_t start = pos + it->raw[pos];
+    if ( start > it->len )
+        start = it->len;
+
+    size_t next = usbdesc_nextstd( it->raw, start, it->len );
+
+    pv->data     = &it->raw[pos];
+    pv->avail    = it->len - pos;
+    pv->extra    = next > start ? &it->raw[start] : NULL;
+    pv->extralen = next - start;
+
+    it->pos = next;
+}
+
+bool usbdesc_config( usbdesciter* it, const uint8_t* raw, size_t len, usbdescview* pcfg )
+{
+    if ( ( it == NULL ) || ( raw == NULL ) || ( pcfg == NULL ) )
+        return false;
+
+    if ( ( len < LIBUSB_DT_CONFIG_SIZE ) || ( raw[1] != LIBUSB_DT_CONFIG ) )
+        return false;
+
+    size_t tlen = usbdesc_u16( &raw[2] );
+
+    it->raw = raw;
+    it->len = len > tlen ? tlen : len;
+    it->pos = 0;
+
+    desc_view( it, 0, pcfg );
+
+    return true;
+}
+
+bool usbdesc_next( usbdesciter* it, usbdescview* pv )
+{
+    if ( ( it == NULL ) || ( pv == NULL ) )
+        return false;
+
+    if ( ( it->pos + 2 > it->len ) || ( it->raw[it->pos] < 2 ) )
+        return false;
+
+    desc_view( it, it->pos, pv );
+
+    return true;
+}
+
+bool usbdesc_nextextra( const usbdescview* pv, size_t* off, const uint8_t** desc )
+{
+    if ( ( pv == NULL ) || ( off == NULL ) || ( desc == NULL ) )
+        return false;
+
+    if ( ( *off + 2 > pv->extralen ) || ( pv->extra[*off] < 2 ) )
+        return false;
+
+    *desc = &pv->extra[*off];
+    *off += pv->extra[*off];
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define BOS_DT_CAPABILITY   0x10
+#define BOS_CAP_SS          0x03
+#define BOS_CAP_CONTAINER   0x04
+#define BOS_CAP_SSP         0x0A
+#define BOS_SPEED_X2        6       /// LIBUSB_SPEED_SUPER_PLUS_X2.
+
+// highest of wSpeedsSupported bits, low, full, high and 5 Gbps.
+static uint8_t bos_ssspeed( uint16_t speeds )
+{
+    for ( int bit=3; bit>=0; bit-- )
+    {
+        if ( speeds & ( 1 << bit ) )
+            return LIBUSB_SPEED_LOW + bit;
+    }
+
+    return 0;
+}
+
+// lane speed of each sublink attribute, as mantissa and exponent of b/s.
+// Gen2x2 is lane count above one with 10 Gbps lanes, or attribute of
+// 20 Gbps as some devices report whole link.
+static uint8_t bos_sspspeed( const uint8_t* cap, uint8_t len )
+{
+    if ( len < 12 )
+        return 0;
+
+    uint32_t attrs = cap[4] | ( cap[5] << 8 ) | ( cap[6] << 16 ) | ( (uint32_t)cap[7] << 24 );
+    uint16_t funcs = usbdesc_u16( &cap[8] );
+    size_t   ssac  = ( attrs & 0x1F ) + 1;
+    uint8_t  lanes = ( funcs >> 8 ) & 0x0F;
+    uint8_t  lanetx = ( funcs >> 12 ) & 0x0F;
+    uint64_t maxbps = 0;
+
+    if ( lanetx > lanes )
+        lanes = lanetx;
+
+    for ( size_t cnt=0; ( cnt<ssac ) && ( 12 + cnt * 4 + 4 <= len ); cnt++ )
+    {
+        const uint8_t* pa = &cap[12 + cnt * 4];
+        uint8_t  lse = ( pa[0] >> 4 ) & 0x03;
+        uint64_t bps = usbdesc_u16( &pa[2] );
+
+        for ( uint8_t e=0; e<lse; e++ )
+            bps *= 1000;
+
+        if ( bps > maxbps )
+            maxbps = bps;
+    }
+
+    if ( ( maxbps >= 20000000000ULL ) || ( ( maxbps >= 10000000000ULL ) && ( lanes > 1 ) ) )
+        return BOS_SPEED_X2;
+
+    if ( maxbps >= 10000000000ULL )
+        return LIBUSB_SPEED_SUPER_PLUS;
+
+    if ( maxbps >= 5000000000ULL )
+        return LIBUSB_SPEED_SUPER;
+
+    return 0;
+}
+
+bool usbdesc_bos( const uint8_t* raw, size_t len, usbdescbos* pbos )
+{
+    if ( ( raw == NULL ) || ( pbos == NULL ) )
+        return false;
+
+    memset( pbos, 0, sizeof( usbdescbos ) );
+
+    if ( ( len < LIBUSB_DT_BOS_SIZE ) || ( raw[1] != LIBUSB_DT_BOS ) )
+        return false;
+
+    pbos->read = true;
+
+    size_t tlen = usbdesc_u16( &raw[2] );
+    if ( len > tlen )
+        len = tlen;
+
+    size_t pos = raw[0];
+
+    while( ( pos + 3 <= len ) && ( raw[pos] >= 3 ) && ( pos + raw[pos] <= len ) )
+    {
+        const uint8_t* cap = &raw[pos];
+        uint8_t speed = 0;
+
+        if ( cap[1] == BOS_DT_CAPABILITY )
+        {
+            switch( cap[2] )
+            {
+                case BOS_CAP_SS:
+                    if ( cap[0] >= 6 )
+                        speed = bos_ssspeed( usbdesc_u16( &cap[4] ) );
+                    break;
+
+                case BOS_CAP_SSP:
+                    speed = bos_sspspeed( cap, cap[0] );
+                    break;
+
+                case BOS_CAP_CONTAINER:
+                    if ( cap[0] >= 4 + USBDESC_CONTAINERLEN )
+                    {
+                        memcpy( pbos->containerid, &cap[4], USBDESC_CONTAINERLEN );
+                        pbos->hascontainer = true;
+                    }
+                    break;
+            }
+        }
+
+        if ( speed > pbos->capspeed )
+            pbos->capspeed = speed;
+
+        pos += cap[0];
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define EP_FRAMEUS          1000
+#define EP_UFRAMEUS         125
+
+// bytes of one ( micro )frame or bus interval and overhead of one bulk
+// packet at link, by libusb_speed. Low speed has no bulk.
+typedef struct _eplink {
+    uint32_t    framebytes;
+    uint32_t    overhead;
+    uint32_t    frames;         /// per second.
+}eplink;
+
+static const eplink eplinks[] = {
+    { 0, 0, 0 },
+    { 0, 0, 0 },
+    { 1500, 13, 1000 },
+    { 7500, 55, 8000 },
+    { 62500, USBDESC_SSPKTOVERHEAD, 8000 },     /// 8b/10b of 5 Gbps.
+    { 151515, USBDESC_SSPKTOVERHEAD, 8000 },    /// 128b/132b of 10 Gbps.
+    { 303030, USBDESC_SSPKTOVERHEAD, 8000 }     /// two lanes of it.
+};
+
+#define EP_LINKS            ( sizeof( eplinks ) / sizeof( eplink ) )
+
+// 2^(bInterval-1) of frames or microframes.
+static uint32_t ep_exponent( uint8_t binterval, uint32_t unitus )
+{
+    if ( binterval < 1 )
+        binterval = 1;
+    else
+    if ( binterval > 16 )
+        binterval = 16;
+
+    return unitus << ( binterval - 1 );
+}
+
+static uint32_t ep_frames( uint8_t binterval )
+{
+    uint32_t frames = 1;
+
+    while( frames * 2 <= binterval )
+        frames *= 2;
+
+    return frames * EP_FRAMEUS;
+}
+
+// companion follows endpoint, isochronous one of SuperSpeedPlus after it.
+static void ep_companion( const uint8_t* extra, size_t extralen, usbdescep* pep )
+{
+    usbdescview v = { NULL, 0, extra, extralen };
+    size_t off = 0;
+    const uint8_t* cs = NULL;
+    bool sspiso = false;
+
+    while( usbdesc_nextextra( &v, &off, &cs ) == true )
+    {
+        if ( off > extralen )
+            break;
+
+        if ( ( cs[1] == USBDESC_DT_SSEPCOMP ) && ( cs[0] >= 6 ) )
+        {
+            pep->companion = true;
+            pep->burst     = cs[2] + 1;
+
+            if ( pep->type == LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS )
+                pep->mult = ( cs[3] & 0x03 ) + 1;
+            else
+            if ( ( pep->type == LIBUSB_ENDPOINT_TRANSFER_TYPE_BULK ) && ( ( cs[3] & 0x1F ) > 0 ) )
+                pep->streams = 1 << ( cs[3] & 0x1F );
+
+            if ( pep->bytes > 0 )
+                pep->bytes = usbdesc_u16( &cs[4] );
+
+            sspiso = ( ( cs[3] & 0x80 ) != 0 );
+        }
+        else
+        if ( ( cs[1] == USBDESC_DT_SSPISOCOMP ) && ( cs[0] >= 8 ) && ( sspiso == true ) )
+        {
+            pep->bytes = cs[4] | ( cs[5] << 8 ) | ( cs[6] << 16 ) | ( (uint32_t)cs[7] << 24 );
+        }
+    }
+}
+
+void usbdesc_endpoint( uint8_t speed, uint8_t attr, uint16_t maxpkt, uint8_t binterval,
+                       const uint8_t* extra, size_t extralen, usbdescep* pep )
+{
+    if ( pep == NULL )
+        return;
+
+    memset( pep, 0, sizeof( usbdescep ) );
+
+    pep->type      = attr & 0x03;
+    pep->maxpacket = maxpkt & 0x07FF;
+    pep->mult      = 1;
+    pep->burst     = 1;
+
+    bool periodic = ( pep->type == LIBUSB_ENDPOINT_TRANSFER_TYPE_INTERRUPT )
+                    || ( pep->type == LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS );
+
+    if ( speed >= LIBUSB_SPEED_SUPER )
+    {
+        if ( periodic == true )
+        {
+            pep->interval = ep_exponent( binterval, EP_UFRAMEUS );
+            pep->bytes    = pep->maxpacket;
+        }
+
+        ep_companion( extra, extralen, pep );
+
+        if ( ( periodic == true ) && ( pep->companion == false ) )
+            pep->bytes = pep->maxpacket * pep->burst * pep->mult;
+    }
+    else
+    if ( speed == LIBUSB_SPEED_HIGH )
+    {
+        // 3 of bits 12:11 is reserved.
+        uint8_t more = ( maxpkt >> 11 ) & 0x03;
+        if ( periodic == true )
+        {
+            pep->mult     = more < 3 ? more + 1 : 3;
+            pep->interval = ep_exponent( binterval, EP_UFRAMEUS );
+            pep->bytes    = pep->maxpacket * pep->mult;
+        }
+    }
+    else
+    if ( periodic == true )
+    {
+        if ( pep->type == LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS )
+            pep->interval = ep_exponent( binterval, EP_FRAMEUS );
+        else
+            pep->interval = ep_frames( binterval );
+
+        pep->bytes = pep->maxpacket;
+    }
+}
+
+uint64_t usbdesc_epmaxrate( uint8_t speed, const usbdescep* pep )
+{
+    if ( pep == NULL )
+        return 0;
+
+    if ( pep->interval > 0 )
+        return (uint64_t)pep->bytes * 1000000 / pep->interval;
+
+    if ( ( pep->type != LIBUSB_ENDPOINT_TRANSFER_TYPE_BULK ) || ( pep->maxpacket == 0 ) )
+        return 0;
+
+    const eplink* pl = &eplinks[ speed < EP_LINKS ? speed : EP_LINKS - 1 ];
+    uint64_t packets = pl->framebytes / ( pep->maxpacket + pl->overhead );
+
+    return packets * pep->maxpacket * pl->frames;
+}
@@ -0,0 +1,112 @@
+#ifndef __USBDESC_H__
+#define __USBDESC_H__
+
+#include <libusb.h>
+#include <cstdint>
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Zero-copy views over raw configuration descriptor bytes, wTotalLength
+// blob of GET_DESCRIPTOR or of sysfs `descriptors` file. Nothing is
+// allocated or copied, every view points into blob. Standard descriptors
+// are grouped as libusb does : class specific descriptors following one
+// ( IAD included ) are its extra, walked by usbdesc_nextextra().
+
+#define USBDESC_DT_IAD      0x0B
+#define USBDESC_DT_SSEPCOMP     0x30    /// SuperSpeed endpoint companion.
+#define USBDESC_DT_SSPISOCOMP   0x31    /// SuperSpeedPlus isochronous one.
+#define USBDESC_SSPKTOVERHEAD   32      /// header, CRCs and framing of SS packet.
+#define USBDESC_CONTAINERLEN    16
+
+typedef struct _usbdescview {
+    const uint8_t*  data;       /// standard descriptor.
+    size_t          avail;      /// bytes of blob from data.
+    const uint8_t*  extra;      /// class specific descriptors after it.
+    size_t          extralen;
+}usbdescview;
+
+typedef struct _usbdesciter {
+    const uint8_t*  raw;
+    size_t          len;        /// clipped to wTotalLength.
+    size_t          pos;        /// next standard descriptor.
+}usbdesciter;
+
+// offset of next interface, endpoint or config descriptor from pos.
+size_t usbdesc_nextstd( const uint8_t* raw, size_t pos, size_t len );
+
+// view of config descriptor, iterator placed after its extra. False when
+// raw is not a config descriptor.
+bool   usbdesc_config( usbdesciter* it, const uint8_t* raw, size_t len, usbdescview* pcfg );
+// next interface or endpoint ( or config ) descriptor, as placed in blob.
+// Fields are read only after avail is checked for size of descriptor.
+bool   usbdesc_next( usbdesciter* it, usbdescview* pv );
+// each class specific descriptor in extra of view, from *off.
+bool   usbdesc_nextextra( const usbdescview* pv, size_t* off, const uint8_t** desc );
+
+// BOS of device, highest speed of its SuperSpeed and SuperSpeedPlus
+// capabilities as libusb_speed ( 6 for Gen2x2, LIBUSB_SPEED_SUPER_PLUS_X2
+// of newer libusb ), and Container ID shared by every link of one device,
+// as both halves of USB 3 hub. read tells BOS without any speed
+// capability, as of USB 2.0 extension only, from BOS not read.
+typedef struct _usbdescbos {
+    bool            read;       /// set by usbdesc_bos() of valid BOS.
+    uint8_t         capspeed;   /// 0 when no speed capability.
+    bool            hascontainer;
+    uint8_t         containerid[USBDESC_CONTAINERLEN];
+}usbdescbos;
+
+bool   usbdesc_bos( const uint8_t* raw, size_t len, usbdescbos* pbos );
+
+// Endpoint as host schedules it at speed of device ( libusb_speed ), of
+// its fields and SuperSpeed endpoint companion in extra. Interval is of
+// bInterval as USB 2.0 9.6.6, full and low speed interrupt one rounded
+// down to power of 2 as hosts do. Bytes are of one service interval :
+// packet, high speed one times transactions, or wBytesPerInterval of
+// companion for SuperSpeed ( packet times burst times mult without it ).
+typedef struct _usbdescep {
+    uint8_t         type;       /// LIBUSB_ENDPOINT_TRANSFER_TYPE_*.
+    uint16_t        maxpacket;  /// bytes of one packet, bits 10:0.
+    uint8_t         mult;       /// transactions of high speed, bursts of SS isochronous.
+    uint8_t         burst;      /// packets of one SuperSpeed burst.
+    bool            companion;  /// SuperSpeed endpoint companion read.
+    uint32_t        streams;    /// of SuperSpeed bulk, 0 for none.
+    uint32_t        bytes;      /// bytes per interval, 0 for control and bulk.
+    uint32_t        interval;   /// us, 0 for control and bulk.
+}usbdescep;
+
+void   usbdesc_endpoint( uint8_t speed, uint8_t attr, uint16_t maxpkt, uint8_t binterval,
+                         const uint8_t* extra, size_t extralen, usbdescep* pep );
+// theoretical bytes per second of endpoint : reserved ones of periodic,
+// and of whole ( micro )frames for bulk, as many packets as fit with
+// protocol overhead of USB 2.0 5.8.4, or SuperSpeed packets at link rate.
+// 0 for control, and bulk of low speed.
+uint64_t usbdesc_epmaxrate( uint8_t speed, const usbdescep* pep );
+
+static inline uint8_t usbdesc_type( const usbdescview* pv )
+{
+    return pv->data[1];
+}
+
+static inline uint16_t usbdesc_u16( const uint8_t* p )
+{
+    return p[0] | ( p[1] << 8 );
+}
+
+// fields of standard descriptors, as offsets of USB 2.0 chapter 9.
+#define USBDESC_CFG_NUMIFS  4
+#define USBDESC_CFG_VALUE   5
+#define USBDESC_CFG_ISTR    6
+#define USBDESC_CFG_POWER   8
+#define USBDESC_IF_NUMBER   2
+#define USBDESC_IF_ALT      3
+#define USBDESC_IF_NUMEPS   4
+#define USBDESC_IF_CLASS    5
+#define USBDESC_IF_SUBCLASS 6
+#define USBDESC_IF_PROTOCOL 7
+#define USBDESC_EP_ADDRESS  2
+#define USBDESC_EP_ATTR     3
+#define USBDESC_EP_MAXPKT   4
+#define USBDESC_EP_INTERVAL 6
+
+#endif /// of __USBDESC_H__
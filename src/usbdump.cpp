@@ -0,0 +1,598 @@
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /// of _WIN32
+
+#include "usbdump.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define DUMP_MAGIC          "LUSBSNAP"
+#define DUMP_VERSION        3
+#define DUMP_VERSION1       1       /// devices without BOS, still read.
+#define DUMP_VERSION2       2       /// without active config, still read.
+#define DUMP_ENDIAN         0x01020304
+#define DUMP_PATHMAX        512
+#define DUMP_ALIGN( _x_ )   ( ( (_x_) + 7 ) & ~( (uint64_t)7 ) )
+
+#define DUMP_SECT_DEV       0
+#define DUMP_SECT_CFG       1
+#define DUMP_SECT_IF        2
+#define DUMP_SECT_ALT       3
+#define DUMP_SECT_EP        4
+#define DUMP_SECT_POOL      5
+#define DUMP_SECTS          6
+
+// flags of dumpdev, earlier files have only DUMPDEV_OPENED as 0 or 1,
+// so their speed reads as unknown.
+#define DUMPDEV_OPENED      0x01
+#define DUMPDEV_TIMEDOUT    0x02
+#define DUMPDEV_ACTIVE      0x04    /// since version 3.
+#define DUMPDEV_BOSREAD     0x08    /// BOS read, even without capability.
+#define DUMPDEV_SPEEDSHIFT  4
+#define DUMPDEV_SPEEDMASK   0x70
+
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma pack(push, 1)
+
+typedef struct _dumpsect {
+    uint64_t    offset;
+    uint32_t    count;
+    uint32_t    entsize;
+}dumpsect;
+
+typedef struct _dumphdr {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    endian;
+    uint32_t    hdrsize;
+    uint32_t    reserved;
+    dumpsect    sect[DUMP_SECTS];
+}dumphdr;
+
+typedef struct _dumpdev {
+    int32_t     descerr;
+    uint8_t     flags;          /// DUMPDEV_*.
+    uint8_t     bus;
+    uint8_t     port;
+    uint8_t     devnum;
+    uint8_t     depth;
+    uint8_t     portpath[MAX_PORTDEPTH];
+    // device descriptor, as libusb_device_descriptor.
+    uint8_t     bLength;
+    uint8_t     bDescriptorType;
+    uint16_t    bcdUSB;
+    uint8_t     bDeviceClass;
+    uint8_t     bDeviceSubClass;
+    uint8_t     bDeviceProtocol;
+    uint8_t     bMaxPacketSize0;
+    uint16_t    idVendor;
+    uint16_t    idProduct;
+    uint16_t    bcdDevice;
+    uint8_t     iManufacturer;
+    uint8_t     iProduct;
+    uint8_t     iSerialNumber;
+    uint8_t     bNumConfigurations;
+    uint32_t    manufacturer;
+    uint32_t    product;
+    uint32_t    serialnumber;
+    uint32_t    cfgfirst;
+    uint32_t    cfgcount;
+    // BOS, since version 2.
+    uint8_t     capspeed;
+    uint8_t     hascontainer;
+    uint8_t     containerid[USBDESC_CONTAINERLEN];
+    // since version 3.
+    uint8_t     actconfig;
+}dumpdev;
+
+typedef struct _dumpcfg {
+    uint8_t     valid;
+    uint8_t     bNumInterfaces;
+    uint8_t     bConfigurationValue;
+    uint8_t     MaxPower;
+    uint32_t    cfgstr;
+    uint32_t    extra;
+    uint32_t    extralen;
+    uint32_t    iffirst;
+}dumpcfg;
+
+typedef struct _dumpif {
+    uint32_t    altfirst;
+    uint32_t    altcount;
+    uint8_t     curalt;         /// since version 3.
+}dumpif;
+
+typedef struct _dumpalt {
+    uint8_t     bInterfaceNumber;
+    uint8_t     bAlternateSetting;
+    uint8_t     bInterfaceClass;
+    uint8_t     bInterfaceSubClass;
+    uint8_t     bInterfaceProtocol;
+    uint8_t     bNumEndpoints;
+    uint32_t    epfirst;
+}dumpalt;
+
+typedef struct _dumpep {
+    uint8_t     bEndpointAddress;
+    uint8_t     bmAttributes;
+    uint16_t    wMaxPacketSize;
+    uint8_t     bInterval;
+    uint32_t    extra;
+    uint32_t    extralen;
+}dumpep;
+
+#pragma pack(pop)
+
+#define DUMPDEV_V1SIZE      offsetof( dumpdev, capspeed )
+#define DUMPDEV_V2SIZE      offsetof( dumpdev, actconfig )
+#define DUMPIF_V2SIZE       offsetof( dumpif, curalt )
+
+static const uint32_t dump_entsize[DUMP_SECTS] = {
+    sizeof( dumpdev ),
+    sizeof( dumpcfg ),
+    sizeof( dumpif ),
+    sizeof( dumpalt ),
+    sizeof( dumpep ),
+    1
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// entries of earlier versions end before fields added later.
+static uint32_t dump_verentsize( uint32_t version, size_t sect )
+{
+    if ( ( sect == DUMP_SECT_DEV ) && ( version == DUMP_VERSION1 ) )
+        return DUMPDEV_V1SIZE;
+
+    if ( ( sect == DUMP_SECT_DEV ) && ( version == DUMP_VERSION2 ) )
+        return DUMPDEV_V2SIZE;
+
+    if ( ( sect == DUMP_SECT_IF ) && ( version < DUMP_VERSION ) )
+        return DUMPIF_V2SIZE;
+
+    return dump_entsize[sect];
+}
+
+static bool dump_checkhdr( const dumphdr* ph, size_t mapsz )
+{
+    if ( ( memcmp( ph->magic, DUMP_MAGIC, 8 ) != 0 )
+         || ( ph->version < DUMP_VERSION1 ) || ( ph->version > DUMP_VERSION )
+         || ( ph->endian != DUMP_ENDIAN )
+         || ( ph->hdrsize != sizeof( dumphdr ) ) )
+        return false;
+
+    for ( size_t cnt=0; cnt<DUMP_SECTS; cnt++ )
+    {
+        const dumpsect* ps = &ph->sect[cnt];
+
+        // offset first, size against what is left never wraps.
+        if ( ( ps->entsize != dump_verentsize( ph->version, cnt ) )
+             || ( ps->offset < sizeof( dumphdr ) ) || ( ps->offset > mapsz )
+             || ( (uint64_t)ps->count * ps->entsize > mapsz - ps->offset ) )
+            return false;
+    }
+
+    // every string offset ends in pool.
+    const dumpsect* pp = &ph->sect[DUMP_SECT_POOL];
+    if ( ( pp->count == 0 )
+         || ( *( (const char*)ph + pp->offset + pp->count - 1 ) != 0 ) )
+        return false;
+
+    return true;
+}
+
+static bool dump_checkrange( uint32_t first, uint32_t count, uint32_t max )
+{
+    return ( (uint64_t)first + count <= max );
+}
+
+bool usbdump_encode( const usbsnapshot* snap, vector< uint8_t >& buff )
+{
+    buff.clear();
+
+    if ( snap == NULL )
+        return false;
+
+    uint32_t counts[DUMP_SECTS] = {
+        (uint32_t)snap->devs.size(),
+        (uint32_t)snap->cfgs.size(),
+        (uint32_t)snap->ifs.size(),
+        (uint32_t)snap->alts.size(),
+        (uint32_t)snap->eps.size(),
+        (uint32_t)snap->pool.size()
+    };
+
+    // empty snapshot still has empty string.
+    if ( counts[DUMP_SECT_POOL] == 0 )
+        counts[DUMP_SECT_POOL] = 1;
+
+    dumphdr hdr;
+    memset( &hdr, 0, sizeof( dumphdr ) );
+    memcpy( hdr.magic, DUMP_MAGIC, 8 );
+    hdr.version = DUMP_VERSION;
+    hdr.endian  = DUMP_ENDIAN;
+    hdr.hdrsize = sizeof( dumphdr );
+
+    uint64_t filesz = DUMP_ALIGN( sizeof( dumphdr ) );
+
+    for ( size_t cnt=0; cnt<DUMP_SECTS; cnt++ )
+    {
+        hdr.sect[cnt].offset  = filesz;
+        hdr.sect[cnt].count   = counts[cnt];
+        hdr.sect[cnt].entsize = dump_entsize[cnt];
+        filesz = DUMP_ALIGN( filesz + (uint64_t)counts[cnt] * dump_entsize[cnt] );
+    }
+
+    buff.assign( filesz, 0 );
+    memcpy( buff.data(), &hdr, sizeof( dumphdr ) );
+
+    dumpdev* pdd = (dumpdev*)&buff[ hdr.sect[DUMP_SECT_DEV].offset ];
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+        const libusb_device_descriptor& desc = pd->desc;
+
+        pdd[cnt].descerr            = pd->descerr;
+        pdd[cnt].flags              = ( pd->opened ? DUMPDEV_OPENED : 0 )
+                                      | ( pd->timedout ? DUMPDEV_TIMEDOUT : 0 )
+                                      | ( pd->active ? DUMPDEV_ACTIVE : 0 )
+                                      | ( pd->bos.read ? DUMPDEV_BOSREAD : 0 )
+                                      | ( ( pd->speed << DUMPDEV_SPEEDSHIFT ) & DUMPDEV_SPEEDMASK );
+        pdd[cnt].bus                = pd->bus;
+        pdd[cnt].port               = pd->port;
+        pdd[cnt].devnum             = pd->devnum;
+        pdd[cnt].depth              = pd->depth;
+        memcpy( pdd[cnt].portpath, pd->portpath, MAX_PORTDEPTH );
+        pdd[cnt].bLength            = desc.bLength;
+        pdd[cnt].bDescriptorType    = desc.bDescriptorType;
+        pdd[cnt].bcdUSB             = desc.bcdUSB;
+        pdd[cnt].bDeviceClass       = desc.bDeviceClass;
+        pdd[cnt].bDeviceSubClass    = desc.bDeviceSubClass;
+        pdd[cnt].bDeviceProtocol    = desc.bDeviceProtocol;
+        pdd[cnt].bMaxPacketSize0    = desc.bMaxPacketSize0;
+        pdd[cnt].idVendor           = desc.idVendor;
+        pdd[cnt].idProduct          = desc.idProduct;
+        pdd[cnt].bcdDevice          = desc.bcdDevice;
+        pdd[cnt].iManufacturer      = desc.iManufacturer;
+        pdd[cnt].iProduct           = desc.iProduct;
+        pdd[cnt].iSerialNumber      = desc.iSerialNumber;
+        pdd[cnt].bNumConfigurations = desc.bNumConfigurations;
+        pdd[cnt].manufacturer       = pd->manufacturer;
+        pdd[cnt].product            = pd->product;
+        pdd[cnt].serialnumber       = pd->serialnumber;
+        pdd[cnt].cfgfirst           = pd->cfgfirst;
+        pdd[cnt].cfgcount           = pd->cfgcount;
+        pdd[cnt].capspeed           = pd->bos.capspeed;
+        pdd[cnt].hascontainer       = pd->bos.hascontainer ? 1 : 0;
+        memcpy( pdd[cnt].containerid, pd->bos.containerid, USBDESC_CONTAINERLEN );
+        pdd[cnt].actconfig          = pd->actconfig;
+    }
+
+    dumpcfg* pdc = (dumpcfg*)&buff[ hdr.sect[DUMP_SECT_CFG].offset ];
+    for ( size_t cnt=0; cnt<snap->cfgs.size(); cnt++ )
+    {
+        const snapcfg* pc = &snap->cfgs[cnt];
+
+        pdc[cnt].valid               = pc->valid ? 1 : 0;
+        pdc[cnt].bNumInterfaces      = pc->bNumInterfaces;
+        pdc[cnt].bConfigurationValue = pc->bConfigurationValue;
+        pdc[cnt].MaxPower            = pc->MaxPower;
+        pdc[cnt].cfgstr              = pc->cfgstr;
+        pdc[cnt].extra               = pc->extra;
+        pdc[cnt].extralen            = pc->extralen;
+        pdc[cnt].iffirst             = pc->iffirst;
+    }
+
+    dumpif* pdi = (dumpif*)&buff[ hdr.sect[DUMP_SECT_IF].offset ];
+    for ( size_t cnt=0; cnt<snap->ifs.size(); cnt++ )
+    {
+        pdi[cnt].altfirst = snap->ifs[cnt].altfirst;
+        pdi[cnt].altcount = snap->ifs[cnt].altcount;
+        pdi[cnt].curalt   = snap->ifs[cnt].curalt;
+    }
+
+    dumpalt* pda = (dumpalt*)&buff[ hdr.sect[DUMP_SECT_ALT].offset ];
+    for ( size_t cnt=0; cnt<snap->alts.size(); cnt++ )
+    {
+        const snapalt* pa = &snap->alts[cnt];
+
+        pda[cnt].bInterfaceNumber   = pa->bInterfaceNumber;
+        pda[cnt].bAlternateSetting  = pa->bAlternateSetting;
+        pda[cnt].bInterfaceClass    = pa->bInterfaceClass;
+        pda[cnt].bInterfaceSubClass = pa->bInterfaceSubClass;
+        pda[cnt].bInterfaceProtocol = pa->bInterfaceProtocol;
+        pda[cnt].bNumEndpoints      = pa->bNumEndpoints;
+        pda[cnt].epfirst            = pa->epfirst;
+    }
+
+    dumpep* pde = (dumpep*)&buff[ hdr.sect[DUMP_SECT_EP].offset ];
+    for ( size_t cnt=0; cnt<snap->eps.size(); cnt++ )
+    {
+        const snapep* pe = &snap->eps[cnt];
+
+        pde[cnt].bEndpointAddress = pe->bEndpointAddress;
+        pde[cnt].bmAttributes     = pe->bmAttributes;
+        pde[cnt].wMaxPacketSize   = pe->wMaxPacketSize;
+        pde[cnt].bInterval        = pe->bInterval;
+        pde[cnt].extra            = pe->extra;
+        pde[cnt].extralen         = pe->extralen;
+    }
+
+    if ( snap->pool.size() > 0 )
+    {
+        memcpy( &buff[ hdr.sect[DUMP_SECT_POOL].offset ],
+                snap->pool.data(), snap->pool.size() );
+    }
+
+    return true;
+}
+
+bool usbdump_decode( const uint8_t* data, size_t len, usbsnapshot& snap )
+{
+    usbsnap_clear( snap );
+
+    if ( ( data == NULL ) || ( len < sizeof( dumphdr ) ) )
+        return false;
+
+    const uint8_t* pbase = data;
+    const dumphdr* ph    = (const dumphdr*)data;
+    bool           retb  = dump_checkhdr( ph, len );
+
+    if ( retb == true )
+    {
+        const dumpsect* sect = ph->sect;
+        uint32_t poolsz = sect[DUMP_SECT_POOL].count;
+
+        snap.devs.resize( sect[DUMP_SECT_DEV].count );
+        snap.cfgs.resize( sect[DUMP_SECT_CFG].count );
+        snap.ifs.resize( sect[DUMP_SECT_IF].count );
+        snap.alts.resize( sect[DUMP_SECT_ALT].count );
+        snap.eps.resize( sect[DUMP_SECT_EP].count );
+        snap.pool.assign( (const char*)pbase + sect[DUMP_SECT_POOL].offset,
+                          (const char*)pbase + sect[DUMP_SECT_POOL].offset + poolsz );
+
+        // by entsize, earlier versions end before BOS or active config.
+        const uint8_t* pdevs = pbase + sect[DUMP_SECT_DEV].offset;
+        for ( size_t cnt=0; ( cnt<snap.devs.size() ) && ( retb == true ); cnt++ )
+        {
+            snapdev* pd = &snap.devs[cnt];
+            libusb_device_descriptor& desc = pd->desc;
+
+            dumpdev dd;
+            memset( &dd, 0, sizeof( dumpdev ) );
+            memcpy( &dd, pdevs + cnt * sect[DUMP_SECT_DEV].entsize,
+                    sect[DUMP_SECT_DEV].entsize );
+            const dumpdev* pdd = &dd;
+
+            pd->descerr                 = pdd->descerr;
+            pd->opened                  = ( ( pdd->flags & DUMPDEV_OPENED ) != 0 );
+            pd->timedout                = ( ( pdd->flags & DUMPDEV_TIMEDOUT ) != 0 );
+            pd->active                  = ( ( pdd->flags & DUMPDEV_ACTIVE ) != 0 );
+            pd->speed                   = ( pdd->flags & DUMPDEV_SPEEDMASK ) >> DUMPDEV_SPEEDSHIFT;
+            pd->bus                     = pdd->bus;
+            pd->port                    = pdd->port;
+            pd->devnum                  = pdd->devnum;
+            pd->depth                   = pdd->depth;
+            memcpy( pd->portpath, pdd->portpath, MAX_PORTDEPTH );
+            desc.bLength                = pdd->bLength;
+            desc.bDescriptorType        = pdd->bDescriptorType;
+            desc.bcdUSB                 = pdd->bcdUSB;
+            desc.bDeviceClass           = pdd->bDeviceClass;
+            desc.bDeviceSubClass        = pdd->bDeviceSubClass;
+            desc.bDeviceProtocol        = pdd->bDeviceProtocol;
+            desc.bMaxPacketSize0        = pdd->bMaxPacketSize0;
+            desc.idVendor               = pdd->idVendor;
+            desc.idProduct              = pdd->idProduct;
+            desc.bcdDevice              = pdd->bcdDevice;
+            desc.iManufacturer          = pdd->iManufacturer;
+            desc.iProduct               = pdd->iProduct;
+            desc.iSerialNumber          = pdd->iSerialNumber;
+            desc.bNumConfigurations     = pdd->bNumConfigurations;
+            pd->manufacturer            = pdd->manufacturer;
+            pd->product                 = pdd->product;
+            pd->serialnumber            = pdd->serialnumber;
+            pd->cfgfirst                = pdd->cfgfirst;
+            pd->cfgcount                = pdd->cfgcount;
+            pd->bos.capspeed            = pdd->capspeed;
+            pd->bos.hascontainer        = ( pdd->hascontainer != 0 );
+            memcpy( pd->bos.containerid, pdd->containerid, USBDESC_CONTAINERLEN );
+            // files before the flag had BOS read when anything of it is.
+            pd->bos.read                = ( ( pdd->flags & DUMPDEV_BOSREAD ) != 0 )
+                                          || ( pdd->capspeed != 0 ) || ( pdd->hascontainer != 0 );
+            pd->actconfig               = pdd->actconfig;
+
+            retb = ( pd->depth <= MAX_PORTDEPTH )
+                   && ( pd->manufacturer < poolsz )
+                   && ( pd->product < poolsz )
+                   && ( pd->serialnumber < poolsz )
+                   && dump_checkrange( pd->cfgfirst, pd->cfgcount, snap.cfgs.size() );
+        }
+
+        const dumpcfg* pdc = (const dumpcfg*)( pbase + sect[DUMP_SECT_CFG].offset );
+        for ( size_t cnt=0; ( cnt<snap.cfgs.size() ) && ( retb == true ); cnt++ )
+        {
+            snapcfg* pc = &snap.cfgs[cnt];
+
+            pc->valid               = ( pdc[cnt].valid != 0 );
+            pc->bNumInterfaces      = pdc[cnt].bNumInterfaces;
+            pc->bConfigurationValue = pdc[cnt].bConfigurationValue;
+            pc->MaxPower            = pdc[cnt].MaxPower;
+            pc->cfgstr              = pdc[cnt].cfgstr;
+            pc->extra               = pdc[cnt].extra;
+            pc->extralen            = pdc[cnt].extralen;
+            pc->iffirst             = pdc[cnt].iffirst;
+
+            retb = ( pc->cfgstr < poolsz )
+                   && dump_checkrange( pc->extra, pc->extralen, poolsz )
+                   && dump_checkrange( pc->iffirst, pc->bNumInterfaces, snap.ifs.size() );
+        }
+
+        const uint8_t* pifs = pbase + sect[DUMP_SECT_IF].offset;
+        for ( size_t cnt=0; ( cnt<snap.ifs.size() ) && ( retb == true ); cnt++ )
+        {
+            dumpif di;
+            di.curalt = ALT_UNKNOWN;
+            memcpy( &di, pifs + cnt * sect[DUMP_SECT_IF].entsize, sect[DUMP_SECT_IF].entsize );
+
+            snap.ifs[cnt].altfirst = di.altfirst;
+            snap.ifs[cnt].altcount = di.altcount;
+            snap.ifs[cnt].curalt   = di.curalt;
+
+            retb = dump_checkrange( di.altfirst, di.altcount, snap.alts.size() );
+        }
+
+        const dumpalt* pda = (const dumpalt*)( pbase + sect[DUMP_SECT_ALT].offset );
+        for ( size_t cnt=0; ( cnt<snap.alts.size() ) && ( retb == true ); cnt++ )
+        {
+            snapalt* pa = &snap.alts[cnt];
+
+            pa->bInterfaceNumber   = pda[cnt].bInterfaceNumber;
+            pa->bAlternateSetting  = pda[cnt].bAlternateSetting;
+            pa->bInterfaceClass    = pda[cnt].bInterfaceClass;
+            pa->bInterfaceSubClass = pda[cnt].bInterfaceSubClass;
+            pa->bInterfaceProtocol = pda[cnt].bInterfaceProtocol;
+            pa->bNumEndpoints      = pda[cnt].bNumEndpoints;
+            pa->epfirst            = pda[cnt].epfirst;
+
+            retb = dump_checkrange( pa->epfirst, pa->bNumEndpoints, snap.eps.size() );
+        }
+
+        const dumpep* pde = (const dumpep*)( pbase + sect[DUMP_SECT_EP].offset );
+        for ( size_t cnt=0; ( cnt<snap.eps.size() ) && ( retb == true ); cnt++ )
+        {
+            snapep* pe = &snap.eps[cnt];
+
+            pe->bEndpointAddress = pde[cnt].bEndpointAddress;
+            pe->bmAttributes     = pde[cnt].bmAttributes;
+            pe->wMaxPacketSize   = pde[cnt].wMaxPacketSize;
+            pe->bInterval        = pde[cnt].bInterval;
+            pe->extra            = pde[cnt].extra;
+            pe->extralen         = pde[cnt].extralen;
+
+            retb = dump_checkrange( pe->extra, pe->extralen, poolsz );
+        }
+    }
+
+    if ( retb == false )
+        usbsnap_clear( snap );
+
+    return retb;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WIN32
+
+static bool dump_writeall( int fd, const uint8_t* p, size_t len )
+{
+    while( len > 0 )
+    {
+        ssize_t wr = write( fd, p, len );
+        if ( wr < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+
+            return false;
+        }
+
+        p   += wr;
+        len -= wr;
+    }
+
+    return true;
+}
+
+bool usbdump_write( const char* path, const usbsnapshot* snap )
+{
+    if ( path == NULL )
+        return false;
+
+    vector< uint8_t > buff;
+    if ( usbdump_encode( snap, buff ) == false )
+        return false;
+
+    // never leaves half written file, and new name of mkstemp() as
+    // usbcache, never follows a link left in shared directory.
+    char tmppath[DUMP_PATHMAX + 32] = {0};
+    snprintf( tmppath, sizeof( tmppath ), "%s.XXXXXX", path );
+
+    int fd = mkstemp( tmppath );
+    if ( fd < 0 )
+        return false;
+
+    bool retb = ( fchmod( fd, 0644 ) == 0 )
+                && dump_writeall( fd, buff.data(), buff.size() );
+    close( fd );
+
+    if ( ( retb == false ) || ( rename( tmppath, path ) != 0 ) )
+    {
+        unlink( tmppath );
+        return false;
+    }
+
+    return true;
+}
+
+bool usbdump_read( const char* path, usbsnapshot& snap )
+{
+    usbsnap_clear( snap );
+
+    if ( path == NULL )
+        return false;
+
+    int fd = open( path, O_RDONLY );
+    if ( fd < 0 )
+        return false;
+
+    struct stat st;
+    void*  pm    = MAP_FAILED;
+    size_t mapsz = 0;
+
+    if ( ( fstat( fd, &st ) == 0 ) && ( st.st_size >= (off_t)sizeof( dumphdr ) ) )
+    {
+        mapsz = st.st_size;
+        pm = mmap( NULL, mapsz, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
+
+    close( fd );
+
+    if ( pm == MAP_FAILED )
+        return false;
+
+    bool retb = usbdump_decode( (const uint8_t*)pm, mapsz, snap );
+
+    munmap( pm, mapsz );
+
+    return retb;
+}
+
+#else /// of _WIN32
+
+bool usbdump_write( const char* path, const usbsnapshot* snap )
+{
+    return false;
+}
+
+bool usbdump_read( const char* path, usbsnapshot& snap )
+{
+    return false;
+}
+
+#endif /// of _WIN32
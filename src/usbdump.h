@@ -0,0 +1,24 @@
+#ifndef __USBDUMP_H__
+#define __USBDUMP_H__
+
+#include <vector>
+
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Binary snapshot file, written by --dump and read back by --load.
+// Header is followed by six sections ( devices, configs, interfaces,
+// alt.settings, endpoints, string pool ), each one an array of fixed
+// size packed records at 8 bytes aligned offset, so whole file can be
+// used as mapped. Version 1 ( devices without BOS ) and 2 ( without
+// active config ) files are still read, other versions or byte order
+// are refused.
+// Same image is encoded in memory for listusbd clients.
+
+bool usbdump_write( const char* path, const usbsnapshot* snap );
+bool usbdump_read( const char* path, usbsnapshot& snap );
+bool usbdump_encode( const usbsnapshot* snap, std::vector< uint8_t >& buff );
+bool usbdump_decode( const uint8_t* data, size_t len, usbsnapshot& snap );
+
+#endif /// of __USBDUMP_H__
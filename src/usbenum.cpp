@@ -0,0 +1,791 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <unordered_map>
+
+#include "usbenum.h"
+#include "usbasync.h"
+#include "usbsysfs.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define ENUM_XFER_TIMEOUT   1000    /// as libusb_get_string_descriptor_ascii().
+#define ENUM_STRBUFSZ       255
+#define ENUM_BOSBUFSZ       512
+#define ENUM_MAXIFS         32
+#define ENUM_SYNCRETRIES    3       /// reads again of a stale record, after arrival.
+#define ENUM_SYNCRETRYMS    1000    /// wait to first read again, doubled each time.
+
+typedef chrono::steady_clock::time_point    enumtime;
+
+typedef struct _enumbudget {
+    enumtime    devend;
+    enumtime    runend;
+    unsigned    xfermax;    /// ms of one transfer.
+    bool        devlimit;
+    bool        runlimit;
+}enumbudget;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void budget_init( enumbudget* pb, const usbenumopt* opt, const enumtime* runend )
+{
+    pb->devlimit = ( opt->devtimeout > 0 );
+    pb->runlimit = ( runend != NULL );
+    pb->xfermax  = pb->devlimit ? opt->devtimeout : ENUM_XFER_TIMEOUT;
+    pb->devend   = chrono::steady_clock::now() + chrono::milliseconds( opt->devtimeout );
+
+    if ( runend != NULL )
+        pb->runend = *runend;
+}
+
+// ms for next transfer, 0 when budget is over. Never 0 for libusb,
+// which means no timeout.
+static unsigned budget_left( const enumbudget* pb )
+{
+    long long left = pb->xfermax;
+    enumtime  now  = chrono::steady_clock::now();
+
+    if ( pb->devlimit == true )
+    {
+        long long devleft = \
+            chrono::duration_cast< chrono::milliseconds >( pb->devend - now ).count();
+        if ( devleft < left )
+            left = devleft;
+    }
+
+    if ( pb->runlimit == true )
+    {
+        long long runleft = \
+            chrono::duration_cast< chrono::milliseconds >( pb->runend - now ).count();
+        if ( runleft < left )
+            left = runleft;
+    }
+
+    return left > 0 ? (unsigned)left : 0;
+}
+
+// one string descriptor, stops reading the device after a timeout.
+static int enum_readstr( usbdevfetch* pf, libusb_device_handle* dev, const enumbudget* pb,
+                         uint8_t idx, uint16_t langid, uint8_t* buff )
+{
+    if ( pf->timedout == true )
+        return LIBUSB_ERROR_TIMEOUT;
+
+    unsigned timeout = budget_left( pb );
+    if ( timeout == 0 )
+    {
+        pf->timedout = true;
+        return LIBUSB_ERROR_TIMEOUT;
+    }
+
+    int ret = pf->backend->control_transfer( dev,
+                                             LIBUSB_ENDPOINT_IN,
+                                             LIBUSB_REQUEST_GET_DESCRIPTOR,
+                                             (uint16_t)( ( LIBUSB_DT_STRING << 8 ) | idx ),
+                                             langid,
+                                             buff,
+                                             ENUM_STRBUFSZ,
+                                             timeout );
+    if ( ret == LIBUSB_ERROR_TIMEOUT )
+        pf->timedout = true;
+
+    return ret;
+}
+
+// as libusb_get_string_descriptor_ascii(), but LANGID is read once by
+// caller, each transfer waits only for what is left of budget, and
+// string is kept as UTF-8.
+static void enum_getstring( usbdevfetch* pf, libusb_device_handle* dev, const enumbudget* pb,
+                            uint16_t langid, uint8_t idx, uint8_t* dst, size_t dstlen )
+{
+    // index 0 means no string.
+    if ( idx == 0 )
+        return;
+
+    uint8_t buff[ENUM_STRBUFSZ];
+
+    int ret = enum_readstr( pf, dev, pb, idx, langid, buff );
+    if ( ( ret >= 2 ) && ( buff[1] == LIBUSB_DT_STRING ) && ( buff[0] <= ret ) )
+    {
+        usbasync_utf8( buff, ret, dst, dstlen );
+        return;
+    }
+
+    pf->strerr = true;
+}
+
+static bool enum_getlangid( usbdevfetch* pf, libusb_device_handle* dev, const enumbudget* pb,
+                            uint16_t* langid )
+{
+    uint8_t buff[ENUM_STRBUFSZ];
+
+    int ret = enum_readstr( pf, dev, pb, 0, 0, buff );
+    if ( ret < 4 )
+        return false;
+
+    *langid = buff[2] | ( buff[3] << 8 );
+    return true;
+}
+
+// BOS of USB 2.01 and later, header first for wTotalLength.
+static void enum_getbos( usbdevfetch* pf, libusb_device_handle* dev, const enumbudget* pb )
+{
+    if ( ( pf->timedout == true ) || ( libusb_cpu_to_le16( pf->desc.bcdUSB ) < 0x0201 ) )
+        return;
+
+    uint8_t  buff[ENUM_BOSBUFSZ];
+    uint16_t rdlen = LIBUSB_DT_BOS_SIZE;
+
+    for ( int cnt=0; cnt<2; cnt++ )
+    {
+        unsigned timeout = budget_left( pb );
+        if ( timeout == 0 )
+        {
+            pf->timedout = true;
+            return;
+        }
+
+        int ret = pf->backend->control_transfer( dev,
+                                                 LIBUSB_ENDPOINT_IN,
+                                                 LIBUSB_REQUEST_GET_DESCRIPTOR,
+                                                 (uint16_t)( LIBUSB_DT_BOS << 8 ),
+                                                 0,
+                                                 buff,
+                                                 rdlen,
+                                                 timeout );
+        if ( ret == LIBUSB_ERROR_TIMEOUT )
+            pf->timedout = true;
+
+        if ( ( ret < LIBUSB_DT_BOS_SIZE ) || ( buff[1] != LIBUSB_DT_BOS ) )
+            return;
+
+        uint16_t tlen = buff[2] | ( buff[3] << 8 );
+        if ( tlen > sizeof( buff ) )
+            tlen = sizeof( buff );
+
+        if ( ( cnt > 0 ) || ( tlen <= rdlen ) )
+        {
+            usbdesc_bos( buff, ret, &pf->bos );
+            return;
+        }
+
+        rdlen = tlen;
+    }
+}
+
+void usbenum_defaults( usbenumopt* opt )
+{
+    if ( opt == NULL )
+        return;
+
+    opt->jobs       = 1;
+    opt->async      = false;
+    opt->sysfs      = false;
+    opt->sysfsroot  = USBSYSFS_ROOT;
+    opt->cache      = NULL;
+    opt->strings    = true;
+    opt->filter     = NULL;
+    opt->maxmatch   = 0;
+    opt->backend    = &usbbackend_libusb;
+    opt->devtimeout = 0;
+    opt->deadline   = 0;
+    opt->stats      = NULL;
+    opt->bos        = false;
+    opt->active     = false;
+}
+
+// of backend, or of sysfs as libusb tells nothing of alternate settings.
+static void enum_getactive( const usbenumopt* opt, const usbbackend* be, usbdevfetch* pf )
+{
+    if ( be->get_active == NULL )
+    {
+        usbsysfs_readactive( opt->sysfsroot, pf );
+        return;
+    }
+
+    uint8_t cfgval = 0;
+    uint8_t alts[ENUM_MAXIFS];
+
+    if ( be->get_active( pf->device, &cfgval, alts, ENUM_MAXIFS ) != 0 )
+        return;
+
+    pf->active    = true;
+    pf->actconfig = cfgval;
+    pf->curalts.assign( alts, alts + ENUM_MAXIFS );
+}
+
+// steps of fetchdev() timed into record, only with stats.
+static void timestep( const usbenumopt* opt, usbdevfetch* pf, int step, uint64_t* t0 )
+{
+    if ( opt->stats == NULL )
+        return;
+
+    uint64_t now = usbstats_now();
+
+    pf->times.usecs[step] = (uint32_t)( now - *t0 );
+    pf->times.mask |= ( 1 << step );
+    *t0 = now;
+}
+
+static void fetchdev( const usbenumopt* opt, usbdevfetch* pf,
+                      bool withconfig, bool keepopen, const enumtime* runend )
+{
+    const usbbackend* be = opt->backend != NULL ? opt->backend : &usbbackend_libusb;
+    libusb_device_handle* dev = NULL;
+    enumbudget budget;
+    uint16_t   langid = 0;
+    bool       haslangid = false;
+    uint64_t   devt0 = opt->stats != NULL ? usbstats_now() : 0;
+    uint64_t   stept0 = devt0;
+
+    pf->skipped = true;
+    pf->backend = be;
+    pf->descerr = be->get_device_descriptor( pf->device, &pf->desc );
+    if ( pf->descerr != 0 )
+    {
+        // kept as before when nothing filtered.
+        pf->skipped = ( opt->filter != NULL );
+        return;
+    }
+
+    pf->bus    = be->get_bus_number( pf->device );
+    pf->port   = be->get_port_number( pf->device );
+    pf->devnum = be->get_device_address( pf->device );
+    pf->speed  = be->get_device_speed( pf->device );
+
+    int depth = be->get_port_numbers( pf->device, pf->portpath, MAX_PORTDEPTH );
+    if ( depth > 0 )
+        pf->depth = depth;
+
+    if ( opt->filter != NULL )
+    {
+        // libusb keeps config descriptors, no device I/O on most platforms.
+        // raw one of backend is only looked, nothing allocated.
+        libusb_config_descriptor* fcfg = NULL;
+        const uint8_t* fraw = NULL;
+        size_t frawlen = 0;
+        if ( usbfilter_needconfig( opt->filter, &pf->desc ) == true )
+        {
+            if ( ( be->get_raw_config == NULL )
+                 || ( be->get_raw_config( pf->device, 0, &fraw, &frawlen ) != 0 ) )
+            {
+                fraw = NULL;
+                be->get_config_descriptor( pf->device, 0, &fcfg );
+            }
+        }
+
+        bool matched = usbfilter_fetched( opt->filter, pf, fcfg, fraw, frawlen );
+
+        if ( fcfg != NULL )
+            be->free_config_descriptor( fcfg );
+
+        if ( matched == false )
+            return;
+    }
+
+    pf->skipped = false;
+
+    budget_init( &budget, opt, runend );
+    if ( opt->stats != NULL )
+        stept0 = usbstats_now();
+
+    // known device not need to be opened.
+    if ( opt->strings == false )
+    {
+        // no strings, nothing to open.
+    }
+    else
+    if ( ( opt->bos == false ) && ( usbcache_lookup( opt->cache, pf ) == true ) )
+    {
+        pf->opened    = true;
+        pf->fromcache = true;
+    }
+    else
+    if ( budget_left( &budget ) == 0 )
+    {
+        // out of time before even started, left as not opened.
+        pf->timedout = true;
+    }
+    else
+    if ( ( pf->openerr = be->open( pf->device, &dev ) ) == 0 )
+    {
+        pf->opened = true;
+        timestep( opt, pf, FETCHTIME_OPEN, &stept0 );
+
+        // strings will be read later by async engine.
+        if ( keepopen == false )
+        {
+            haslangid = enum_getlangid( pf, dev, &budget, &langid );
+        }
+
+        if ( ( keepopen == false ) && ( haslangid == false )
+             && ( ( pf->desc.iProduct | pf->desc.iManufacturer | pf->desc.iSerialNumber ) > 0 ) )
+        {
+            pf->strerr = true;
+        }
+
+        if ( haslangid == true )
+        {
+            enum_getstring( pf, dev, &budget, langid, pf->desc.iProduct,
+                            pf->product, SLEN_PRODUCT );
+            enum_getstring( pf, dev, &budget, langid, pf->desc.iManufacturer,
+                            pf->manufacturer, SLEN_MANUFACTURER );
+            enum_getstring( pf, dev, &budget, langid, pf->desc.iSerialNumber,
+                            pf->serialnumber, SLEN_SN );
+        }
+
+        // BOS is not kept by libusb, read as strings are.
+        if ( opt->bos == true )
+            enum_getbos( pf, dev, &budget );
+
+        if ( keepopen == false )
+            timestep( opt, pf, FETCHTIME_STRINGS, &stept0 );
+    }
+    else
+    {
+        dev = NULL;
+        timestep( opt, pf, FETCHTIME_OPEN, &stept0 );
+    }
+
+    // get config
+    if ( ( withconfig == true ) && ( pf->desc.bNumConfigurations > 0 ) )
+    {
+        if ( opt->stats != NULL )
+            stept0 = usbstats_now();
+
+        pf->config.resize( pf->desc.bNumConfigurations );
+
+        for ( uint8_t cnt=0; cnt<pf->desc.bNumConfigurations; cnt++ )
+        {
+            usbcfgfetch* pcf = &pf->config[cnt];
+
+            const uint8_t* raw = NULL;
+            size_t rawlen = 0;
+
+            if ( ( be->get_raw_config != NULL )
+                 && ( be->get_raw_config( pf->device, cnt, &raw, &rawlen ) == 0 )
+                 && ( rawlen >= LIBUSB_DT_CONFIG_SIZE ) )
+            {
+                // one copy of blob, no tree.
+                pcf->cfg = NULL;
+                pcf->raw.assign( raw, raw + rawlen );
+
+                if ( ( haslangid == true ) && ( raw[1] == LIBUSB_DT_STRING ) )
+                {
+                    enum_getstring( pf, dev, &budget, langid, raw[USBDESC_CFG_ISTR],
+                                    pcf->cfgstr, SLEN_CONFIG );
+                }
+                continue;
+            }
+
+            int usberr = be->get_config_descriptor( pf->device,
+                                                    cnt,
+                                                    &pcf->cfg );
+            if ( usberr != 0 )
+            {
+                pcf->cfg = NULL;
+            }
+            else
+            if ( ( haslangid == true )
+                 && ( pcf->cfg->bDescriptorType == LIBUSB_DT_STRING ) )
+            {
+                enum_getstring( pf, dev, &budget, langid, pcf->cfg->iConfiguration,
+                                pcf->cfgstr, SLEN_CONFIG );
+            }
+        }
+
+        timestep( opt, pf, FETCHTIME_CONFIG, &stept0 );
+    }
+
+    if ( opt->active == true )
+        enum_getactive( opt, be, pf );
+
+    if ( dev != NULL )
+    {
+        if ( keepopen == true )
+            pf->handle = dev;
+        else
+            be->close( dev );
+    }
+
+    timestep( opt, pf, FETCHTIME_DEVICE, &devt0 );
+}
+
+void usbenum_fetchdev( const usbenumopt* opt, usbdevfetch* pf,
+                       bool withconfig, bool keepopen )
+{
+    fetchdev( opt, pf, withconfig, keepopen, NULL );
+}
+
+// removes skipped records, and any over maxmatch.
+static void compactlist( const usbenumopt* opt, usbfetchlist& ufl )
+{
+    size_t kept = 0;
+
+    for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+    {
+        bool keep = ( ufl[cnt].skipped == false )
+                    && ( ( opt->maxmatch == 0 ) || ( kept < opt->maxmatch ) );
+
+        if ( keep == false )
+        {
+            usbenum_freedev( ufl[cnt] );
+            continue;
+        }
+
+        if ( kept != cnt )
+            ufl[kept] = ufl[cnt];
+        kept++;
+    }
+
+    ufl.resize( kept );
+}
+
+static void fetchlist( libusb_context* ctx, const usbenumopt* opt, usbfetchlist& ufl,
+                       libusb_device** listdev, size_t devscnt, bool withconfig )
+{
+    const usbbackend* be = opt->backend != NULL ? opt->backend : &usbbackend_libusb;
+    enumtime  runendtp = chrono::steady_clock::now() + chrono::milliseconds( opt->deadline );
+    enumtime* runend   = opt->deadline > 0 ? &runendtp : NULL;
+
+    // value initialized, all descriptor and string fields are zero.
+    ufl.clear();
+    ufl.resize( devscnt );
+
+    // not read by early stop of maxmatch stays skipped.
+    for ( size_t cnt=0; cnt<devscnt; cnt++ )
+    {
+        ufl[cnt].device  = listdev[cnt];
+        ufl[cnt].skipped = true;
+    }
+
+    atomic< size_t > matched( 0 );
+
+    bool   keepopen = opt->async && be->async;
+    size_t jobs = opt->jobs;
+    if ( jobs > devscnt )
+        jobs = devscnt;
+
+    if ( jobs <= 1 )
+    {
+        for ( size_t cnt=0; cnt<devscnt; cnt++ )
+        {
+            if ( ( opt->maxmatch > 0 ) && ( matched >= opt->maxmatch ) )
+                break;
+
+            fetchdev( opt, &ufl[cnt], withconfig, keepopen, runend );
+            if ( ufl[cnt].skipped == false )
+                matched++;
+        }
+    }
+    else
+    {
+        // each worker takes next device index, so result order is
+        // always same as libusb device list.
+        atomic< size_t > nextdev( 0 );
+        vector< thread > workers;
+
+        for ( size_t cnt=0; cnt<jobs; cnt++ )
+        {
+            workers.push_back( thread( [&]()
+            {
+                size_t idx = 0;
+                while( ( idx = nextdev++ ) < devscnt )
+                {
+                    if ( ( opt->maxmatch > 0 ) && ( matched >= opt->maxmatch ) )
+                        break;
+
+                    fetchdev( opt, &ufl[idx], withconfig, keepopen, runend );
+                    if ( ufl[idx].skipped == false )
+                        matched++;
+                }
+            } ) );
+        }
+
+        for ( size_t cnt=0; cnt<workers.size(); cnt++ )
+        {
+            workers[cnt].join();
+        }
+    }
+
+    if ( keepopen == true )
+    {
+        // all devices are read at once, so whole batch gets budget of
+        // one device, or what is left of run.
+        enumbudget budget;
+        budget_init( &budget, opt, runend );
+
+        unsigned left = budget_left( &budget );
+        if ( left > 0 )
+        {
+            uint64_t t0 = usbstats_now();
+            usbasync_fetchstrings( ctx, ufl.data(), devscnt, budget.xfermax,
+                                   ( budget.devlimit || budget.runlimit ) ? left : 0 );
+            usbstats_add( opt->stats, USBSTAT_ASYNC, usbstats_now() - t0 );
+        }
+
+        for ( size_t cnt=0; cnt<devscnt; cnt++ )
+        {
+            if ( ufl[cnt].handle != NULL )
+            {
+                if ( left == 0 )
+                    ufl[cnt].timedout = true;
+
+                be->close( ufl[cnt].handle );
+                ufl[cnt].handle = NULL;
+            }
+        }
+    }
+}
+
+size_t usbenum_fetchdevs( libusb_context* ctx, const usbenumopt* opt,
+                          usbfetchlist& ufl, bool withconfig, int* listerr )
+{
+    uint64_t enumt0 = usbstats_now();
+
+    if ( listerr != NULL )
+        *listerr = 0;
+
+    if ( opt->sysfs == true )
+    {
+        usbsysfs_fetchdevs( opt->sysfsroot, ufl, withconfig, listerr );
+        usbstats_add( opt->stats, USBSTAT_DEVLIST, usbstats_now() - enumt0 );
+
+        if ( opt->active == true )
+        {
+            for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+                usbsysfs_readactive( opt->sysfsroot, &ufl[cnt] );
+        }
+
+        // sysfs has configs only with withconfig, for class of interfaces.
+        for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+        {
+            usbdevfetch* pf = &ufl[cnt];
+            const usbcfgfetch* pcf = pf->config.size() > 0 ? &pf->config[0] : NULL;
+            pf->skipped = !usbfilter_fetched( opt->filter, pf,
+                                              pcf != NULL ? pcf->cfg : NULL,
+                                              pcf != NULL ? pcf->raw.data() : NULL,
+                                              pcf != NULL ? pcf->raw.size() : 0 );
+        }
+
+        compactlist( opt, ufl );
+        usbstats_add( opt->stats, USBSTAT_ENUM, usbstats_now() - enumt0 );
+        return ufl.size();
+    }
+
+    const usbbackend* be = opt->backend != NULL ? opt->backend : &usbbackend_libusb;
+    libusb_device** listdev = NULL;
+    ssize_t devscnt = be->get_device_list( ctx, &listdev );
+    usbstats_add( opt->stats, USBSTAT_DEVLIST, usbstats_now() - enumt0 );
+
+    if ( ( devscnt < 0 ) && ( listerr != NULL ) )
+        *listerr = (int)devscnt;
+
+    if ( devscnt > 0 )
+    {
+        fetchlist( ctx, opt, ufl, listdev, devscnt, withconfig );
+        usbstats_collect( opt->stats, ufl );
+
+        // devices not opened or not matched would drop cached entries.
+        if ( ( opt->strings == true ) && ( opt->filter == NULL ) )
+            usbcache_update( opt->cache, ufl );
+
+        // fetched records keep nothing of libusb device.
+        for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+        {
+            ufl[cnt].device = NULL;
+        }
+    }
+
+    if ( listdev != NULL )
+        be->free_device_list( listdev, 1 );
+
+    compactlist( opt, ufl );
+    usbstats_add( opt->stats, USBSTAT_ENUM, usbstats_now() - enumt0 );
+
+    return ufl.size();
+}
+
+void usbenum_freedev( usbdevfetch& uf )
+{
+    for ( size_t itr=0; itr<uf.config.size(); itr++ )
+    {
+        if ( uf.config[itr].cfg != NULL )
+        {
+            if ( uf.fromsysfs == true )
+                usbsysfs_freeconfig( uf.config[itr].cfg );
+            else
+            if ( uf.backend != NULL )
+                uf.backend->free_config_descriptor( uf.config[itr].cfg );
+            else
+                libusb_free_config_descriptor( uf.config[itr].cfg );
+            uf.config[itr].cfg = NULL;
+        }
+    }
+
+    uf.config.clear();
+}
+
+void usbenum_free( usbfetchlist& ufl )
+{
+    for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+    {
+        usbenum_freedev( ufl[cnt] );
+    }
+
+    ufl.clear();
+}
+
+static void syncunref( usbdevfetch& uf )
+{
+    usbenum_freedev( uf );
+
+    if ( ( uf.device != NULL ) && ( uf.backend != NULL ) )
+        uf.backend->unref_device( uf.device );
+
+    uf.device = NULL;
+}
+
+bool usbenum_syncstale( const usbenumopt* opt, const usbdevfetch* pf )
+{
+    if ( ( opt == NULL ) || ( pf == NULL ) )
+        return false;
+
+    // only around arrival, never read again for ever.
+    if ( pf->retries >= ENUM_SYNCRETRIES )
+        return false;
+
+    if ( pf->descerr != 0 )
+        return true;
+
+    // not matched by filter is never opened.
+    if ( ( pf->skipped == true ) || ( opt->strings == false ) )
+        return false;
+
+    // permission is not given by waiting.
+    if ( pf->opened == false )
+        return ( pf->openerr != LIBUSB_ERROR_ACCESS );
+
+    // strings failed again by read again will fail every time.
+    if ( ( pf->timedout == true ) || ( pf->strerr == true ) )
+        return ( pf->retries == 0 );
+
+    return false;
+}
+
+uint64_t usbenum_syncretry( const usbenumopt* opt, const usbfetchlist& known )
+{
+    uint64_t retryat = 0;
+
+    for ( size_t cnt=0; cnt<known.size(); cnt++ )
+    {
+        const usbdevfetch* pf = &known[cnt];
+
+        if ( usbenum_syncstale( opt, pf ) == false )
+            continue;
+
+        if ( ( retryat == 0 ) || ( pf->retryat < retryat ) )
+            retryat = pf->retryat;
+    }
+
+    return retryat;
+}
+
+size_t usbenum_sync( libusb_context* ctx, const usbenumopt* opt, usbfetchlist& known )
+{
+    const usbbackend* be = opt->backend != NULL ? opt->backend : &usbbackend_libusb;
+    libusb_device** listdev = NULL;
+    ssize_t devscnt = be->get_device_list( ctx, &listdev );
+    if ( devscnt < 0 )
+        return 0;
+
+    unordered_map< libusb_device*, size_t > index;
+    for ( size_t cnt=0; cnt<known.size(); cnt++ )
+    {
+        index[ known[cnt].device ] = cnt;
+    }
+
+    usbfetchlist synced;
+    size_t       fetched = 0;
+    uint64_t     now = usbstats_now();
+
+    synced.reserve( devscnt );
+
+    for ( ssize_t cnt=0; cnt<devscnt; cnt++ )
+    {
+        unordered_map< libusb_device*, size_t >::iterator it = index.find( listdev[cnt] );
+        usbdevfetch uf = usbdevfetch();
+
+        if ( it != index.end() )
+        {
+            usbdevfetch* pk = &known[ it->second ];
+
+            if ( ( usbenum_syncstale( opt, pk ) == false ) || ( now < pk->retryat ) )
+            {
+                synced.push_back( *pk );
+                pk->device = NULL;
+                continue;
+            }
+
+            // read again, as busy or stalled at arrival, keeps reference.
+            uf.device  = pk->device;
+            uf.retries = pk->retries + 1;
+            pk->device = NULL;
+            usbenum_freedev( *pk );
+        }
+        else
+        {
+            uf.device = be->ref_device( listdev[cnt] );
+        }
+
+        fetchdev( opt, &uf, true, false, NULL );
+        uf.retryat = usbstats_now() + ( (uint64_t)ENUM_SYNCRETRYMS * 1000 << uf.retries );
+        synced.push_back( uf );
+        fetched++;
+    }
+
+    // left devices, moved records have no device.
+    for ( size_t cnt=0; cnt<known.size(); cnt++ )
+    {
+        if ( known[cnt].device != NULL )
+            syncunref( known[cnt] );
+    }
+
+    known.swap( synced );
+    be->free_device_list( listdev, 1 );
+
+    return fetched;
+}
+
+void usbenum_syncdrop( usbfetchlist& known, libusb_device* device )
+{
+    for ( size_t cnt=0; cnt<known.size(); cnt++ )
+    {
+        if ( known[cnt].device == device )
+        {
+            syncunref( known[cnt] );
+            known.erase( known.begin() + cnt );
+            return;
+        }
+    }
+}
+
+void usbenum_syncfree( usbfetchlist& known )
+{
+    for ( size_t cnt=0; cnt<known.size(); cnt++ )
+    {
+        syncunref( known[cnt] );
+    }
+
+    known.clear();
+}
@@ -0,0 +1,78 @@
+#ifndef __USBENUM_H__
+#define __USBENUM_H__
+
+#include "usbfetch.h"
+#include "usbcache.h"
+#include "usbfilter.h"
+#include "usbstats.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Options of one enumeration, replaces former optpar_* globals so that
+// many enumerations with different options may live in one process.
+// Without strings only what libusb already knows is read. Devices not
+// matched by filter are never opened and left out of result, maxmatch
+// stops enumeration after as many matched devices.
+// A device not answered in devtimeout ms is abandoned and marked as
+// timedout, devices not read until deadline ms are not opened at all.
+// With stats, each step of device read is timed into record, and phases
+// and records are added to stats by usbenum_fetchdevs().
+// With bos, BOS descriptor is read from every opened device of USB 2.01
+// or later, so cached devices are opened too. With active, configuration
+// value and current alternate settings are read without device I/O.
+
+typedef struct _usbenumopt {
+    uint32_t        jobs;       /// parallel device readers, 1 for serial.
+    bool            async;      /// strings by asynchronous transfers.
+    bool            sysfs;      /// linux sysfs instead of opening devices.
+    const char*     sysfsroot;
+    usbcache*       cache;      /// NULL for no string cache.
+    bool            strings;    /// false never opens device, no control transfer.
+    const usbfilter* filter;    /// NULL for all devices.
+    uint32_t        maxmatch;   /// 0 for all matched devices.
+    const usbbackend* backend;  /// libusb or usbmock, context of it to fetchdevs.
+    unsigned        devtimeout; /// ms of each device, 0 for libusb default.
+    unsigned        deadline;   /// ms of whole enumeration, 0 for none.
+    usbstats*       stats;      /// NULL for no timings.
+    bool            bos;        /// BOS of each opened device, speed capability.
+    bool            active;     /// active config and alternate settings.
+}usbenumopt;
+
+////////////////////////////////////////////////////////////////////////////////
+
+void   usbenum_defaults( usbenumopt* opt );
+
+// Reads one device of pf->device, keepopen leaves handle opened for
+// later asynchronous string read. Only devtimeout applies here. Device
+// not matched by filter has only descriptor and numbers, as skipped.
+void   usbenum_fetchdev( const usbenumopt* opt, usbdevfetch* pf,
+                         bool withconfig, bool keepopen );
+
+// Enumerates every device of ctx ( not used with sysfs ) into ufl.
+// Device list of libusb is released before return, so pf->device of
+// each record is NULL. Returns number of devices, listerr gets libusb
+// error of device list ( or sysfs not read ), 0 for no error.
+size_t usbenum_fetchdevs( libusb_context* ctx, const usbenumopt* opt,
+                          usbfetchlist& ufl, bool withconfig, int* listerr = NULL );
+
+void   usbenum_freedev( usbdevfetch& uf );
+void   usbenum_free( usbfetchlist& ufl );
+
+// Keeps known records same as device list of ctx, in its order, for a
+// process enumerating again and again. Only devices new in list are
+// read, with configs, and each record keeps its device referenced until
+// it left list, is dropped or freed by usbenum_syncfree(). Records not
+// matched by filter stay as skipped. Known records of usbenum_syncstale()
+// are read again. Returns number of devices read.
+size_t usbenum_sync( libusb_context* ctx, const usbenumopt* opt, usbfetchlist& known );
+// record to be read again : descriptor error, or strings wanted but not
+// opened other than by permission, or timed out or failed only at
+// arrival. Read again a few times with growing wait, then never.
+bool   usbenum_syncstale( const usbenumopt* opt, const usbdevfetch* pf );
+// usbstats_now() of next record to be read again, 0 for none.
+uint64_t usbenum_syncretry( const usbenumopt* opt, const usbfetchlist& known );
+// record of device read again by next sync, as re-plugged.
+void   usbenum_syncdrop( usbfetchlist& known, libusb_device* device );
+void   usbenum_syncfree( usbfetchlist& known );
+
+#endif /// of __USBENUM_H__
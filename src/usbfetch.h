@@ -0,0 +1,75 @@
+#ifndef __USBFETCH_H__
+#define __USBFETCH_H__
+
+#include <libusb.h>
+#include <cstdint>
+#include <vector>
+
+#include "usbbackend.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define SLEN_MANUFACTURER   128
+#define SLEN_PRODUCT        128
+#define SLEN_SN             64
+#define SLEN_CLASS          64
+#define SLEN_CONFIG         64
+#define MAX_PORTDEPTH       7
+#define ALT_UNKNOWN         0xFF    /// current alternate setting not read.
+
+// steps of reading one device, timed only when enumerated with stats.
+#define FETCHTIME_OPEN      0
+#define FETCHTIME_STRINGS   1
+#define FETCHTIME_CONFIG    2
+#define FETCHTIME_DEVICE    3
+#define FETCHTIME_MAX       4
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _usbcfgfetch {
+    libusb_config_descriptor*   cfg;
+    std::vector< uint8_t >      raw;        /// wTotalLength bytes, instead of cfg.
+    uint8_t                     cfgstr[SLEN_CONFIG];
+}usbcfgfetch;
+
+typedef struct _usbfetchtime {
+    uint32_t                    usecs[FETCHTIME_MAX];
+    uint8_t                     mask;       /// bit of each timed step.
+}usbfetchtime;
+
+typedef struct _usbdevfetch {
+    libusb_device*              device;
+    libusb_device_handle*       handle;
+    const usbbackend*           backend;    /// of device, frees config.
+    libusb_device_descriptor    desc;
+    int                         descerr;
+    int                         openerr;    /// of open, 0 when opened or not tried.
+    bool                        opened;
+    bool                        fromsysfs;  /// config freed by usbsysfs.
+    bool                        fromcache;  /// strings from usbcache.
+    bool                        timedout;   /// strings abandoned by time budget.
+    bool                        strerr;     /// a string descriptor failed to be read.
+    bool                        skipped;    /// not matched by filter, or not read.
+    uint8_t                     bus;
+    uint8_t                     port;
+    uint8_t                     devnum;
+    uint8_t                     speed;      /// libusb_speed.
+    uint8_t                     depth;
+    uint8_t                     portpath[MAX_PORTDEPTH];
+    uint8_t                     manufacturer[SLEN_MANUFACTURER];
+    uint8_t                     product[SLEN_PRODUCT];
+    uint8_t                     serialnumber[SLEN_SN];
+    usbdescbos                  bos;        /// read only by enumeration with bos.
+    bool                        active;     /// actconfig and curalts were read.
+    uint8_t                     actconfig;  /// bConfigurationValue, 0 for unconfigured.
+    std::vector< uint8_t >      curalts;    /// by interface number, ALT_UNKNOWN for none.
+    usbfetchtime                times;
+    uint8_t                     retries;    /// reads again by usbenum_sync().
+    uint64_t                    retryat;    /// usbstats_now() of next read again.
+    std::vector< usbcfgfetch >  config;
+}usbdevfetch;
+
+typedef std::vector< usbdevfetch >  usbfetchlist;
+
+#endif /// of __USBFETCH_H__
@@ -0,0 +1,184 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "usbfilter.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// everything but class of interfaces.
+static bool filter_device( const usbfilter* pfl, const libusb_device_descriptor* desc,
+                           uint8_t bus, const uint8_t* portpath, uint8_t depth )
+{
+    if ( ( pfl->flags & USBFILTER_VID ) && ( desc->idVendor != pfl->vid ) )
+        return false;
+
+    if ( ( pfl->flags & USBFILTER_PID ) && ( desc->idProduct != pfl->pid ) )
+        return false;
+
+    if ( ( pfl->flags & USBFILTER_BUS ) && ( bus != pfl->bus ) )
+        return false;
+
+    if ( pfl->flags & USBFILTER_PORTPATH )
+    {
+        if ( ( depth != pfl->depth )
+             || ( memcmp( portpath, pfl->portpath, depth ) != 0 ) )
+            return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool usbfilter_portpath( usbfilter* pfl, const char* str )
+{
+    if ( ( pfl == NULL ) || ( str == NULL ) )
+        return false;
+
+    uint8_t depth = 0;
+
+    while( *str != 0 )
+    {
+        char* endp = NULL;
+        unsigned long port = strtoul( str, &endp, 10 );
+
+        if ( ( endp == str ) || ( port == 0 ) || ( port > 255 )
+             || ( depth >= MAX_PORTDEPTH ) )
+            return false;
+
+        pfl->portpath[depth++] = (uint8_t)port;
+
+        str = endp;
+        if ( *str == '.' )
+            str++;
+        else
+        if ( *str != 0 )
+            return false;
+    }
+
+    if ( depth == 0 )
+        return false;
+
+    pfl->depth  = depth;
+    pfl->flags |= USBFILTER_PORTPATH;
+
+    return true;
+}
+
+bool usbfilter_needconfig( const usbfilter* pfl, const libusb_device_descriptor* desc )
+{
+    if ( ( pfl == NULL ) || ( ( pfl->flags & USBFILTER_CLASS ) == 0 ) )
+        return false;
+
+    if ( desc->bDeviceClass == pfl->clsid )
+        return false;
+
+    return ( desc->bDeviceClass == LIBUSB_CLASS_PER_INTERFACE )
+           || ( desc->bDeviceClass == LIBUSB_CLASS_MISCELLANEOUS );
+}
+
+static bool filter_rawclass( const usbfilter* pfl, const uint8_t* raw, size_t rawlen )
+{
+    usbdesciter it;
+    usbdescview v;
+
+    if ( usbdesc_config( &it, raw, rawlen, &v ) == false )
+        return false;
+
+    uint8_t numifs = v.data[USBDESC_CFG_NUMIFS];
+
+    while( usbdesc_next( &it, &v ) == true )
+    {
+        if ( v.avail < LIBUSB_DT_INTERFACE_SIZE )
+            break;
+
+        if ( usbdesc_type( &v ) != LIBUSB_DT_INTERFACE )
+            continue;
+
+        if ( v.data[USBDESC_IF_NUMBER] >= numifs )
+            break;
+
+        if ( v.data[USBDESC_IF_CLASS] == pfl->clsid )
+            return true;
+    }
+
+    return false;
+}
+
+bool usbfilter_fetched( const usbfilter* pfl, const usbdevfetch* pf,
+                        const libusb_config_descriptor* cfg,
+                        const uint8_t* raw, size_t rawlen )
+{
+    if ( pfl == NULL )
+        return true;
+
+    if ( filter_device( pfl, &pf->desc, pf->bus, pf->portpath, pf->depth ) == false )
+        return false;
+
+    if ( ( pfl->flags & USBFILTER_CLASS ) == 0 )
+        return true;
+
+    if ( pf->desc.bDeviceClass == pfl->clsid )
+        return true;
+
+    if ( usbfilter_needconfig( pfl, &pf->desc ) == false )
+        return false;
+
+    if ( cfg == NULL )
+        return ( raw != NULL ) && filter_rawclass( pfl, raw, rawlen );
+
+    for ( uint8_t x=0; x<cfg->bNumInterfaces; x++ )
+    {
+        const libusb_interface* pif = &cfg->interface[x];
+
+        for ( int y=0; y<pif->num_altsetting; y++ )
+        {
+            if ( pif->altsetting[y].bInterfaceClass == pfl->clsid )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool usbfilter_snapdev( const usbfilter* pfl, const usbsnapshot* snap, size_t idx )
+{
+    if ( pfl == NULL )
+        return true;
+
+    const snapdev* pd = &snap->devs[idx];
+
+    if ( filter_device( pfl, &pd->desc, pd->bus, pd->portpath, pd->depth ) == false )
+        return false;
+
+    if ( ( pfl->flags & USBFILTER_CLASS ) == 0 )
+        return true;
+
+    if ( pd->desc.bDeviceClass == pfl->clsid )
+        return true;
+
+    if ( ( pd->cfgcount == 0 ) || ( usbfilter_needconfig( pfl, &pd->desc ) == false ) )
+        return false;
+
+    const snapcfg* pcf = &snap->cfgs[pd->cfgfirst];
+    if ( pcf->valid == false )
+        return false;
+
+    for ( size_t x=0; x<pcf->bNumInterfaces; x++ )
+    {
+        const snapif* pif = &snap->ifs[pcf->iffirst + x];
+
+        for ( size_t y=0; y<pif->altcount; y++ )
+        {
+            if ( snap->alts[pif->altfirst + y].bInterfaceClass == pfl->clsid )
+                return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef __USBFILTER_H__
+#define __USBFILTER_H__
+
+#include "usbfetch.h"
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Device selection of --vid, --pid, --bus, --port-path and --class.
+// Everything is matched on device descriptor and bus and port numbers,
+// known by libusb before a device is opened. Class matches device class,
+// or any interface class of first config for per-interface devices.
+
+#define USBFILTER_VID       0x01
+#define USBFILTER_PID       0x02
+#define USBFILTER_BUS       0x04
+#define USBFILTER_PORTPATH  0x08
+#define USBFILTER_CLASS     0x10
+
+typedef struct _usbfilter {
+    uint32_t    flags;      /// USBFILTER_* to be matched, 0 matches all.
+    uint16_t    vid;
+    uint16_t    pid;
+    uint8_t     bus;
+    uint8_t     clsid;
+    uint8_t     depth;
+    uint8_t     portpath[MAX_PORTDEPTH];
+}usbfilter;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// "1.4.2" as --fields port_path, false when not a port chain.
+bool usbfilter_portpath( usbfilter* pfl, const char* str );
+
+// NULL filter matches all. cfg may be NULL, interfaces are then of raw
+// config descriptor, or only device class is compared without both.
+bool usbfilter_fetched( const usbfilter* pfl, const usbdevfetch* pf,
+                        const libusb_config_descriptor* cfg,
+                        const uint8_t* raw = NULL, size_t rawlen = 0 );
+bool usbfilter_snapdev( const usbfilter* pfl, const usbsnapshot* snap, size_t idx );
+
+// true when class may be only in interfaces, needs config to be decided.
+bool usbfilter_needconfig( const usbfilter* pfl, const libusb_device_descriptor* desc );
+
+#endif /// of __USBFILTER_H__
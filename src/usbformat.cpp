@@ -0,0 +1,810 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "outbuf.h"
+#include "usbformat.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char* eptransfer[] = {
+    "control", "isochronous", "bulk", "interrupt"
+};
+
+static const char* epsync[] = {
+    "none", "async", "adaptive", "sync"
+};
+
+static const char* epusage[] = {
+    "data", "feedback", "implicit", "reserved"
+};
+
+static const char* speednames[] = {
+    "", "1.5", "12", "480", "5000", "10000", "20000"
+};
+
+#define FIELD_BUS           0
+#define FIELD_PORT          1
+#define FIELD_ADDRESS       2
+#define FIELD_PORTPATH      3
+#define FIELD_VID           4
+#define FIELD_PID           5
+#define FIELD_SPEED         6
+#define FIELD_BCDUSB        7
+#define FIELD_BCDDEVICE     8
+#define FIELD_CLASS         9
+#define FIELD_SUBCLASS      10
+#define FIELD_PROTOCOL      11
+#define FIELD_CONFIGS       12
+#define FIELD_MANUFACTURER  13
+#define FIELD_PRODUCT       14
+#define FIELD_SERIAL        15
+#define FIELD_MAXPOWER      16
+
+typedef struct _fielddef {
+    const char* name;
+    uint32_t    needs;
+    bool        quoted;     /// put in quotes by json, strings quote by themselves.
+}fielddef;
+
+// indexed by FIELD_*.
+static const fielddef fielddefs[] = {
+    { "bus",            0,                  false },
+    { "port",           0,                  false },
+    { "address",        0,                  false },
+    { "port_path",      0,                  true },
+    { "vid",            0,                  true },
+    { "pid",            0,                  true },
+    { "speed",          0,                  true },
+    { "bcd_usb",        0,                  true },
+    { "bcd_device",     0,                  true },
+    { "class",          0,                  false },
+    { "subclass",       0,                  false },
+    { "protocol",       0,                  false },
+    { "configs",        0,                  false },
+    { "manufacturer",   USBFIELD_NEEDSTR,   false },
+    { "product",        USBFIELD_NEEDSTR,   false },
+    { "serial",         USBFIELD_NEEDSTR,   false },
+    { "max_power_ma",   USBFIELD_NEEDCFG,   false },
+    { NULL, 0, false }
+};
+
+static const char* csvheader = \
+"bus,port,address,port_path,vid,pid,bcd_usb,bcd_device,"
+"class,subclass,protocol,manufacturer,product,serial,"
+"config,config_value,config_name,max_power_ma,"
+"interface,alt_setting,if_class,if_subclass,if_protocol,"
+"ep_address,ep_direction,ep_transfer,ep_sync,ep_usage,"
+"ep_max_packet_size,ep_interval\n";
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void js_str( const char* s )
+{
+    static const char hexs[] = "0123456789abcdef";
+
+    ob_putc( '"' );
+
+    for ( ; *s != 0; s++ )
+    {
+        uint8_t c = (uint8_t)*s;
+
+        if ( ( c == '"' ) || ( c == '\\' ) )
+        {
+            ob_putc( '\\' );
+            ob_putc( (char)c );
+        }
+        else
+        if ( c < 0x20 )
+        {
+            ob_puts( "\\u00" );
+            ob_putc( hexs[ c >> 4 ] );
+            ob_putc( hexs[ c & 0x0F ] );
+        }
+        else
+        {
+            ob_putc( (char)c );
+        }
+    }
+
+    ob_putc( '"' );
+}
+
+static void js_key( const char* k )
+{
+    ob_putc( '"' );
+    ob_puts( k );
+    ob_puts( "\":" );
+}
+
+static void js_hexstr( uint32_t v, unsigned digits )
+{
+    ob_putc( '"' );
+    ob_hex( v, digits );
+    ob_putc( '"' );
+}
+
+static void js_bytes( const uint8_t* p, size_t len )
+{
+    ob_putc( '"' );
+    for ( size_t cnt=0; cnt<len; cnt++ )
+    {
+        ob_hex( p[cnt], 2 );
+    }
+    ob_putc( '"' );
+}
+
+static void prtportpath( const snapdev* pd, char sep )
+{
+    for ( size_t cnt=0; cnt<pd->depth; cnt++ )
+    {
+        if ( cnt > 0 )
+            ob_putc( sep );
+        ob_dec( pd->portpath[cnt] );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void js_endpoint( const usbsnapshot* snap, uint8_t speed, const snapep* pep )
+{
+    const uint8_t* extra = usbsnap_bytes( snap, pep->extra );
+    usbdescep de;
+
+    usbdesc_endpoint( speed, pep->bmAttributes, pep->wMaxPacketSize, pep->bInterval,
+                      extra, pep->extralen, &de );
+
+    ob_putc( '{' );
+    js_key( "address" );
+    js_hexstr( pep->bEndpointAddress, 2 );
+    ob_putc( ',' );
+    js_key( "direction" );
+    ob_puts( ( pep->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK ) ? "\"in\"" : "\"out\"" );
+    ob_putc( ',' );
+    js_key( "attributes" );
+    ob_dec( pep->bmAttributes );
+    ob_putc( ',' );
+    js_key( "transfer" );
+    js_str( eptransfer[ pep->bmAttributes & 0x03 ] );
+    ob_putc( ',' );
+    js_key( "sync" );
+    js_str( epsync[ ( pep->bmAttributes >> 2 ) & 0x03 ] );
+    ob_putc( ',' );
+    js_key( "usage" );
+    js_str( epusage[ ( pep->bmAttributes >> 4 ) & 0x03 ] );
+    ob_putc( ',' );
+    js_key( "max_packet_size" );
+    ob_dec( pep->wMaxPacketSize );
+    ob_putc( ',' );
+    js_key( "interval" );
+    ob_dec( pep->bInterval );
+    ob_putc( ',' );
+    js_key( "interval_us" );
+    ob_dec( de.interval );
+    ob_putc( ',' );
+    js_key( "bytes_per_interval" );
+    ob_dec( de.bytes );
+    ob_putc( ',' );
+    js_key( "mult" );
+    ob_dec( de.mult );
+    ob_putc( ',' );
+    js_key( "max_burst" );
+    ob_dec( de.burst );
+    ob_putc( ',' );
+    js_key( "streams" );
+    ob_dec( de.streams );
+    ob_putc( ',' );
+    js_key( "max_bytes_per_sec" );
+    ob_dec( usbdesc_epmaxrate( speed, &de ) );
+    ob_putc( ',' );
+    js_key( "extra" );
+    js_bytes( extra, pep->extralen );
+    ob_putc( '}' );
+}
+
+static void js_altsetting( const usbsnapshot* snap, uint8_t speed, const snapalt* pas )
+{
+    ob_putc( '{' );
+    js_key( "alt_setting" );
+    ob_dec( pas->bAlternateSetting );
+    ob_putc( ',' );
+    js_key( "class" );
+    ob_dec( pas->bInterfaceClass );
+    ob_putc( ',' );
+    js_key( "subclass" );
+    ob_dec( pas->bInterfaceSubClass );
+    ob_putc( ',' );
+    js_key( "protocol" );
+    ob_dec( pas->bInterfaceProtocol );
+    ob_putc( ',' );
+    js_key( "endpoints" );
+    ob_putc( '[' );
+    for ( size_t cnt=0; cnt<pas->bNumEndpoints; cnt++ )
+    {
+        if ( cnt > 0 )
+            ob_putc( ',' );
+        js_endpoint( snap, speed, &snap->eps[pas->epfirst + cnt] );
+    }
+    ob_puts( "]}" );
+}
+
+static void js_config( const usbsnapshot* snap, const snapdev* pd, size_t idx )
+{
+    const snapcfg* pcf = &snap->cfgs[pd->cfgfirst + idx];
+
+    ob_putc( '{' );
+    js_key( "index" );
+    ob_dec( idx );
+
+    if ( pcf->valid == false )
+    {
+        ob_putc( '}' );
+        return;
+    }
+
+    ob_putc( ',' );
+    js_key( "value" );
+    ob_dec( pcf->bConfigurationValue );
+    ob_putc( ',' );
+    js_key( "name" );
+    js_str( usbsnap_str( snap, pcf->cfgstr ) );
+    ob_putc( ',' );
+    js_key( "max_power_ma" );
+    ob_dec( usbsnap_maxpower( pd, pcf ) );
+    ob_putc( ',' );
+    js_key( "extra" );
+    js_bytes( usbsnap_bytes( snap, pcf->extra ), pcf->extralen );
+    ob_putc( ',' );
+    js_key( "interfaces" );
+    ob_putc( '[' );
+    for ( size_t x=0; x<pcf->bNumInterfaces; x++ )
+    {
+        const snapif* pif = &snap->ifs[pcf->iffirst + x];
+
+        if ( x > 0 )
+            ob_putc( ',' );
+
+        ob_putc( '{' );
+        js_key( "interface" );
+        ob_dec( x );
+        ob_putc( ',' );
+        js_key( "alt_settings" );
+        ob_putc( '[' );
+        for ( size_t y=0; y<pif->altcount; y++ )
+        {
+            if ( y > 0 )
+                ob_putc( ',' );
+            js_altsetting( snap, pd->speed, &snap->alts[pif->altfirst + y] );
+        }
+        ob_puts( "]}" );
+    }
+    ob_puts( "]}" );
+}
+
+static void js_device( const usbsnapshot* snap, const snapdev* pd )
+{
+    const libusb_device_descriptor& desc = pd->desc;
+
+    ob_putc( '{' );
+    js_key( "bus" );
+    ob_dec( pd->bus );
+    ob_putc( ',' );
+    js_key( "port" );
+    ob_dec( pd->port );
+    ob_putc( ',' );
+    js_key( "address" );
+    ob_dec( pd->devnum );
+    ob_putc( ',' );
+    js_key( "port_path" );
+    ob_putc( '[' );
+    prtportpath( pd, ',' );
+    ob_puts( "]," );
+    js_key( "vid" );
+    js_hexstr( desc.idVendor, 4 );
+    ob_putc( ',' );
+    js_key( "pid" );
+    js_hexstr( desc.idProduct, 4 );
+    ob_putc( ',' );
+    js_key( "bcd_usb" );
+    js_hexstr( libusb_cpu_to_le16( desc.bcdUSB ), 4 );
+    ob_putc( ',' );
+    js_key( "bcd_device" );
+    js_hexstr( libusb_cpu_to_le16( desc.bcdDevice ), 4 );
+    ob_putc( ',' );
+    js_key( "class" );
+    ob_dec( desc.bDeviceClass );
+    ob_putc( ',' );
+    js_key( "subclass" );
+    ob_dec( desc.bDeviceSubClass );
+    ob_putc( ',' );
+    js_key( "protocol" );
+    ob_dec( desc.bDeviceProtocol );
+    ob_putc( ',' );
+    js_key( "max_packet_size0" );
+    ob_dec( desc.bMaxPacketSize0 );
+    ob_putc( ',' );
+    js_key( "opened" );
+    ob_puts( pd->opened ? "true" : "false" );
+    ob_putc( ',' );
+    js_key( "timed_out" );
+    ob_puts( pd->timedout ? "true" : "false" );
+    ob_putc( ',' );
+    js_key( "manufacturer" );
+    js_str( usbsnap_str( snap, pd->manufacturer ) );
+    ob_putc( ',' );
+    js_key( "product" );
+    js_str( usbsnap_str( snap, pd->product ) );
+    ob_putc( ',' );
+    js_key( "serial" );
+    js_str( usbsnap_str( snap, pd->serialnumber ) );
+    ob_putc( ',' );
+    js_key( "configs" );
+    ob_putc( '[' );
+    for ( size_t cnt=0; cnt<pd->cfgcount; cnt++ )
+    {
+        if ( cnt > 0 )
+            ob_putc( ',' );
+        js_config( snap, pd, cnt );
+    }
+    ob_puts( "]}" );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void csv_str( const char* s )
+{
+    ob_putc( '"' );
+
+    for ( ; *s != 0; s++ )
+    {
+        if ( *s == '"' )
+            ob_putc( '"' );
+        ob_putc( *s );
+    }
+
+    ob_putc( '"' );
+}
+
+// device, config and interface columns, each ends with ','.
+static void csv_device( const usbsnapshot* snap, const snapdev* pd )
+{
+    const libusb_device_descriptor& desc = pd->desc;
+
+    ob_dec( pd->bus );
+    ob_putc( ',' );
+    ob_dec( pd->port );
+    ob_putc( ',' );
+    ob_dec( pd->devnum );
+    ob_puts( ",\"" );
+    prtportpath( pd, '.' );
+    ob_puts( "\"," );
+    ob_hex( desc.idVendor, 4 );
+    ob_putc( ',' );
+    ob_hex( desc.idProduct, 4 );
+    ob_putc( ',' );
+    ob_hex( libusb_cpu_to_le16( desc.bcdUSB ), 4 );
+    ob_putc( ',' );
+    ob_hex( libusb_cpu_to_le16( desc.bcdDevice ), 4 );
+    ob_putc( ',' );
+    ob_dec( desc.bDeviceClass );
+    ob_putc( ',' );
+    ob_dec( desc.bDeviceSubClass );
+    ob_putc( ',' );
+    ob_dec( desc.bDeviceProtocol );
+    ob_putc( ',' );
+    csv_str( usbsnap_str( snap, pd->manufacturer ) );
+    ob_putc( ',' );
+    csv_str( usbsnap_str( snap, pd->product ) );
+    ob_putc( ',' );
+    csv_str( usbsnap_str( snap, pd->serialnumber ) );
+    ob_putc( ',' );
+}
+
+static void csv_config( const usbsnapshot* snap, const snapdev* pd, size_t idx )
+{
+    const snapcfg* pcf = &snap->cfgs[pd->cfgfirst + idx];
+
+    ob_dec( idx );
+    ob_putc( ',' );
+    ob_dec( pcf->bConfigurationValue );
+    ob_putc( ',' );
+    csv_str( usbsnap_str( snap, pcf->cfgstr ) );
+    ob_putc( ',' );
+    ob_dec( usbsnap_maxpower( pd, pcf ) );
+    ob_putc( ',' );
+}
+
+static void csv_altsetting( size_t ifidx, const snapalt* pas )
+{
+    ob_dec( ifidx );
+    ob_putc( ',' );
+    ob_dec( pas->bAlternateSetting );
+    ob_putc( ',' );
+    ob_dec( pas->bInterfaceClass );
+    ob_putc( ',' );
+    ob_dec( pas->bInterfaceSubClass );
+    ob_putc( ',' );
+    ob_dec( pas->bInterfaceProtocol );
+    ob_putc( ',' );
+}
+
+static void csv_endpoint( const snapep* pep )
+{
+    ob_hex( pep->bEndpointAddress, 2 );
+    ob_puts( ( pep->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK ) ? ",in," : ",out," );
+    ob_puts( eptransfer[ pep->bmAttributes & 0x03 ] );
+    ob_putc( ',' );
+    ob_puts( epsync[ ( pep->bmAttributes >> 2 ) & 0x03 ] );
+    ob_putc( ',' );
+    ob_puts( epusage[ ( pep->bmAttributes >> 4 ) & 0x03 ] );
+    ob_putc( ',' );
+    ob_dec( pep->wMaxPacketSize );
+    ob_putc( ',' );
+    ob_dec( pep->bInterval );
+    ob_putc( '\n' );
+}
+
+static void csv_rows( const usbsnapshot* snap, const snapdev* pd )
+{
+    // empty columns of each level, counted by csvheader.
+    static const char* nocfg = ",,,,";
+    static const char* noalt = ",,,,,";
+    static const char* noep  = ",,,,,,\n";
+
+    size_t rows = 0;
+
+    for ( size_t c=0; c<pd->cfgcount; c++ )
+    {
+        const snapcfg* pcf = &snap->cfgs[pd->cfgfirst + c];
+
+        if ( pcf->valid == false )
+            continue;
+
+        size_t cfgrows = 0;
+
+        for ( size_t x=0; x<pcf->bNumInterfaces; x++ )
+        {
+            const snapif* pif = &snap->ifs[pcf->iffirst + x];
+
+            for ( size_t y=0; y<pif->altcount; y++ )
+            {
+                const snapalt* pas = &snap->alts[pif->altfirst + y];
+
+                for ( size_t z=0; z<pas->bNumEndpoints; z++ )
+                {
+                    csv_device( snap, pd );
+                    csv_config( snap, pd, c );
+                    csv_altsetting( x, pas );
+                    csv_endpoint( &snap->eps[pas->epfirst + z] );
+                    cfgrows++;
+                }
+
+                if ( pas->bNumEndpoints == 0 )
+                {
+                    csv_device( snap, pd );
+                    csv_config( snap, pd, c );
+                    csv_altsetting( x, pas );
+                    ob_puts( noep );
+                    cfgrows++;
+                }
+            }
+        }
+
+        if ( cfgrows == 0 )
+        {
+            csv_device( snap, pd );
+            csv_config( snap, pd, c );
+            ob_puts( noalt );
+            ob_puts( noep );
+            cfgrows++;
+        }
+
+        rows += cfgrows;
+    }
+
+    if ( rows == 0 )
+    {
+        csv_device( snap, pd );
+        ob_puts( nocfg );
+        ob_puts( noalt );
+        ob_puts( noep );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// value of one field, strings are quoted as fmt.
+static void fieldvalue( const usbsnapshot* snap, const snapdev* pd, uint8_t id, int fmt )
+{
+    bool json = ( fmt == USBFORMAT_JSON ) || ( fmt == USBFORMAT_NDJSON );
+
+    const libusb_device_descriptor& desc = pd->desc;
+
+    switch( id )
+    {
+        case FIELD_BUS:
+            ob_dec( pd->bus );
+            break;
+
+        case FIELD_PORT:
+            ob_dec( pd->port );
+            break;
+
+        case FIELD_ADDRESS:
+            ob_dec( pd->devnum );
+            break;
+
+        case FIELD_PORTPATH:
+            prtportpath( pd, '.' );
+            break;
+
+        case FIELD_VID:
+            ob_hex( desc.idVendor, 4 );
+            break;
+
+        case FIELD_PID:
+            ob_hex( desc.idProduct, 4 );
+            break;
+
+        case FIELD_SPEED:
+            if ( pd->speed < sizeof( speednames ) / sizeof( const char* ) )
+                ob_puts( speednames[pd->speed] );
+            break;
+
+        case FIELD_BCDUSB:
+            ob_hex( libusb_cpu_to_le16( desc.bcdUSB ), 4 );
+            break;
+
+        case FIELD_BCDDEVICE:
+            ob_hex( libusb_cpu_to_le16( desc.bcdDevice ), 4 );
+            break;
+
+        case FIELD_CLASS:
+            ob_dec( desc.bDeviceClass );
+            break;
+
+        case FIELD_SUBCLASS:
+            ob_dec( desc.bDeviceSubClass );
+            break;
+
+        case FIELD_PROTOCOL:
+            ob_dec( desc.bDeviceProtocol );
+            break;
+
+        case FIELD_CONFIGS:
+            ob_dec( desc.bNumConfigurations );
+            break;
+
+        case FIELD_MANUFACTURER:
+        case FIELD_PRODUCT:
+        case FIELD_SERIAL:
+        {
+            uint32_t off = id == FIELD_MANUFACTURER ? pd->manufacturer :
+                           id == FIELD_PRODUCT ? pd->product : pd->serialnumber;
+
+            if ( json == true )
+                js_str( usbsnap_str( snap, off ) );
+            else
+            if ( fmt == USBFORMAT_CSV )
+                csv_str( usbsnap_str( snap, off ) );
+            else
+                ob_puts( usbsnap_str( snap, off ) );
+        }
+            break;
+
+        case FIELD_MAXPOWER:
+            // of first config, as it is active one for most devices.
+            if ( ( pd->cfgcount > 0 ) && ( snap->cfgs[pd->cfgfirst].valid == true ) )
+                ob_dec( usbsnap_maxpower( pd, &snap->cfgs[pd->cfgfirst] ) );
+            else
+            if ( json == true )
+                ob_puts( "null" );
+            break;
+    }
+}
+
+static void fieldjson( const usbsnapshot* snap, const snapdev* pd, const usbfields* pfs,
+                       int fmt )
+{
+    ob_putc( '{' );
+    for ( size_t cnt=0; cnt<pfs->count; cnt++ )
+    {
+        const fielddef* pfd = &fielddefs[ pfs->ids[cnt] ];
+
+        if ( cnt > 0 )
+            ob_putc( ',' );
+
+        js_key( pfd->name );
+        if ( pfd->quoted == true )
+            ob_putc( '"' );
+        fieldvalue( snap, pd, pfs->ids[cnt], fmt );
+        if ( pfd->quoted == true )
+            ob_putc( '"' );
+    }
+    ob_putc( '}' );
+}
+
+static void fieldrow( const usbsnapshot* snap, const snapdev* pd, const usbfields* pfs,
+                      int fmt )
+{
+    for ( size_t cnt=0; cnt<pfs->count; cnt++ )
+    {
+        if ( cnt > 0 )
+            ob_putc( fmt == USBFORMAT_CSV ? ',' : ';' );
+
+        fieldvalue( snap, pd, pfs->ids[cnt], fmt );
+    }
+    ob_putc( '\n' );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int usbformat_byname( const char* name )
+{
+    if ( name == NULL )
+        return -1;
+
+    if ( strcmp( name, "text" ) == 0 )
+        return USBFORMAT_TEXT;
+
+    if ( strcmp( name, "json" ) == 0 )
+        return USBFORMAT_JSON;
+
+    if ( strcmp( name, "ndjson" ) == 0 )
+        return USBFORMAT_NDJSON;
+
+    if ( strcmp( name, "csv" ) == 0 )
+        return USBFORMAT_CSV;
+
+    return -1;
+}
+
+void usbformat_write( int fmt, const usbsnapshot* snap )
+{
+    size_t written = 0;
+
+    switch( fmt )
+    {
+        case USBFORMAT_JSON:
+            ob_putc( '{' );
+            js_key( "schema" );
+            ob_dec( USBFORMAT_SCHEMA );
+            ob_putc( ',' );
+            js_key( "devices" );
+            ob_putc( '[' );
+            for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+            {
+                if ( snap->devs[cnt].descerr != 0 )
+                    continue;
+
+                ob_puts( written > 0 ? ",\n" : "\n" );
+                js_device( snap, &snap->devs[cnt] );
+                written++;
+            }
+            ob_puts( "\n]}\n" );
+            break;
+
+        case USBFORMAT_NDJSON:
+            for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+            {
+                if ( snap->devs[cnt].descerr != 0 )
+                    continue;
+
+                js_device( snap, &snap->devs[cnt] );
+                ob_putc( '\n' );
+            }
+            break;
+
+        case USBFORMAT_CSV:
+            ob_puts( csvheader );
+            for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+            {
+                if ( snap->devs[cnt].descerr != 0 )
+                    continue;
+
+                csv_rows( snap, &snap->devs[cnt] );
+            }
+            break;
+    }
+}
+
+bool usbformat_fields( const char* list, usbfields* pfs,
+                       char* errname, size_t errlen )
+{
+    if ( ( list == NULL ) || ( pfs == NULL ) )
+        return false;
+
+    memset( pfs, 0, sizeof( usbfields ) );
+
+    while( *list != 0 )
+    {
+        size_t len = strcspn( list, "," );
+
+        if ( len > 0 )
+        {
+            size_t id = 0;
+            for ( ; fielddefs[id].name != NULL; id++ )
+            {
+                if ( ( strlen( fielddefs[id].name ) == len )
+                     && ( strncmp( fielddefs[id].name, list, len ) == 0 ) )
+                    break;
+            }
+
+            if ( ( fielddefs[id].name == NULL ) || ( pfs->count >= USBFIELD_MAX ) )
+            {
+                if ( ( errname != NULL ) && ( errlen > 0 ) )
+                    snprintf( errname, errlen, "%.*s", (int)len, list );
+                return false;
+            }
+
+            pfs->ids[pfs->count++] = (uint8_t)id;
+            pfs->needs |= fielddefs[id].needs;
+        }
+
+        list += len;
+        if ( *list == ',' )
+            list++;
+    }
+
+    return pfs->count > 0;
+}
+
+void usbformat_project( int fmt, const usbsnapshot* snap, const usbfields* pfs )
+{
+    size_t written = 0;
+
+    if ( fmt == USBFORMAT_JSON )
+    {
+        ob_putc( '{' );
+        js_key( "schema" );
+        ob_dec( USBFORMAT_SCHEMA );
+        ob_putc( ',' );
+        js_key( "devices" );
+        ob_putc( '[' );
+    }
+    else
+    if ( fmt == USBFORMAT_CSV )
+    {
+        for ( size_t cnt=0; cnt<pfs->count; cnt++ )
+        {
+            if ( cnt > 0 )
+                ob_putc( ',' );
+            ob_puts( fielddefs[ pfs->ids[cnt] ].name );
+        }
+        ob_putc( '\n' );
+    }
+
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+
+        if ( pd->descerr != 0 )
+            continue;
+
+        switch( fmt )
+        {
+            case USBFORMAT_JSON:
+                ob_puts( written > 0 ? ",\n" : "\n" );
+                fieldjson( snap, pd, pfs, fmt );
+                break;
+
+            case USBFORMAT_NDJSON:
+                fieldjson( snap, pd, pfs, fmt );
+                ob_putc( '\n' );
+                break;
+
+            default:
+                fieldrow( snap, pd, pfs, fmt );
+                break;
+        }
+
+        written++;
+    }
+
+    if ( fmt == USBFORMAT_JSON )
+        ob_puts( "\n]}\n" );
+}
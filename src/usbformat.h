@@ -0,0 +1,46 @@
+#ifndef __USBFORMAT_H__
+#define __USBFORMAT_H__
+
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Machine readable output of a snapshot, streamed into outbuf.
+//
+//  json   : { "schema":1, "devices":[ device, ... ] }
+//  ndjson : one device object per line.
+//  csv    : header line, then one row per endpoint. Device, config and
+//           interface columns are repeated, empty where nothing below.
+
+#define USBFORMAT_TEXT      0
+#define USBFORMAT_JSON      1
+#define USBFORMAT_NDJSON    2
+#define USBFORMAT_CSV       3
+
+#define USBFORMAT_SCHEMA    1
+
+// Projection of --fields=, named as keys of json and columns of csv.
+// needs tells what enumeration has to read for selected fields, others
+// come from device descriptor and libusb without any device I/O.
+
+#define USBFIELD_NEEDSTR    0x01    /// device opened for string descriptors.
+#define USBFIELD_NEEDCFG    0x02    /// config descriptors fetched.
+#define USBFIELD_MAX        32
+
+typedef struct _usbfields {
+    uint8_t     ids[USBFIELD_MAX];
+    size_t      count;
+    uint32_t    needs;
+}usbfields;
+
+int  usbformat_byname( const char* name );
+void usbformat_write( int fmt, const usbsnapshot* snap );
+
+// comma separated names into pfs, false with unknown name in errname.
+bool usbformat_fields( const char* list, usbfields* pfs,
+                       char* errname, size_t errlen );
+// one line, object or row per device with only selected fields, text is
+// separated by ';' as --simple.
+void usbformat_project( int fmt, const usbsnapshot* snap, const usbfields* pfs );
+
+#endif /// of __USBFORMAT_H__
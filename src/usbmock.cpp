@@ -0,0 +1,592 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "usbmock.h"
+#include "usbfetch.h"
+#include "usbsysfs.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define MOCK_SET_HUB        0
+#define MOCK_SET_HID        1
+#define MOCK_SET_STORAGE    2
+#define MOCK_SET_AUDIO      3
+#define MOCK_SET_CDC        4
+#define MOCK_SETS           5
+
+#define MOCK_ROOTVID        0x1D6B
+#define MOCK_VID            0x1209  /// pid.codes, test ids.
+
+typedef struct _mockset {
+    const char*     name;
+    const char*     product;
+    uint8_t         clsid;
+    uint8_t         subclsid;
+    uint8_t         protocol;
+    uint16_t        bcd;
+    int             speed;
+    const char*     config;     /// NULL for no config string.
+    const uint8_t*  raw;        /// whole config descriptor.
+    size_t          rawlen;
+    const uint8_t*  bos;        /// NULL for no BOS.
+    size_t          boslen;
+    const uint8_t*  alts;       /// current alternate setting of each interface,
+    size_t          altslen;    /// NULL for all zero.
+}mockset;
+
+typedef struct _mockdev {
+    const mockset*              set;
+    libusb_device_descriptor    desc;
+    uint8_t                     bus;
+    uint8_t                     port;
+    uint8_t                     devnum;
+    uint8_t                     depth;
+    uint8_t                     portpath[MAX_PORTDEPTH];
+    uint32_t                    serial;
+    unsigned                    latency_us;
+}mockdev;
+
+struct _usbmock {
+    usbmockopt          opt;
+    vector< mockdev >   devs;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const uint8_t raw_hub[] = {
+    0x09, 0x02, 0x19, 0x00, 0x01, 0x01, 0x00, 0xE0, 0x00,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x09, 0x00, 0x00, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x01, 0x00, 0x0C
+};
+
+static const uint8_t raw_hid[] = {
+    0x09, 0x02, 0x22, 0x00, 0x01, 0x01, 0x00, 0xA0, 0x32,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x03, 0x01, 0x01, 0x00,
+    0x09, 0x21, 0x11, 0x01, 0x00, 0x01, 0x22, 0x3F, 0x00,
+    0x07, 0x05, 0x81, 0x03, 0x08, 0x00, 0x0A
+};
+
+static const uint8_t raw_storage[] = {
+    0x09, 0x02, 0x2C, 0x00, 0x01, 0x01, 0x04, 0x80, 0x70,
+    0x09, 0x04, 0x00, 0x00, 0x02, 0x08, 0x06, 0x50, 0x00,
+    0x07, 0x05, 0x81, 0x02, 0x00, 0x04, 0x00,
+    0x06, 0x30, 0x0F, 0x00, 0x00, 0x00,
+    0x07, 0x05, 0x02, 0x02, 0x00, 0x04, 0x00,
+    0x06, 0x30, 0x0F, 0x00, 0x00, 0x00
+};
+
+static const uint8_t raw_audio[] = {
+    0x09, 0x02, 0x3C, 0x00, 0x02, 0x01, 0x00, 0x80, 0x32,
+    0x08, 0x0B, 0x00, 0x02, 0x01, 0x00, 0x20, 0x00,
+    0x09, 0x04, 0x00, 0x00, 0x00, 0x01, 0x01, 0x20, 0x00,
+    0x09, 0x24, 0x01, 0x00, 0x02, 0x1E, 0x00, 0x01, 0x01,
+    0x09, 0x04, 0x01, 0x00, 0x00, 0x01, 0x02, 0x20, 0x00,
+    0x09, 0x04, 0x01, 0x01, 0x01, 0x01, 0x02, 0x20, 0x00,
+    0x07, 0x05, 0x01, 0x05, 0xC0, 0x00, 0x01
+};
+
+static const uint8_t raw_cdc[] = {
+    0x09, 0x02, 0x3A, 0x00, 0x02, 0x01, 0x00, 0x80, 0x32,
+    0x09, 0x04, 0x00, 0x00, 0x01, 0x02, 0x02, 0x01, 0x00,
+    0x05, 0x24, 0x00, 0x10, 0x01,
+    0x05, 0x24, 0x06, 0x00, 0x01,
+    0x07, 0x05, 0x83, 0x03, 0x10, 0x00, 0x10,
+    0x09, 0x04, 0x01, 0x00, 0x02, 0x0A, 0x00, 0x00, 0x00,
+    0x07, 0x05, 0x81, 0x02, 0x40, 0x00, 0x00,
+    0x07, 0x05, 0x02, 0x02, 0x40, 0x00, 0x00
+};
+
+// USB 3.2 Gen2 enclosure, enumerated at Gen1 as behind a 5 Gbps hub.
+static const uint8_t bos_storage[] = {
+    0x05, 0x0F, 0x3E, 0x00, 0x04,
+    0x07, 0x10, 0x02, 0x06, 0x00, 0x00, 0x00,
+    0x0A, 0x10, 0x03, 0x00, 0x0E, 0x00, 0x01, 0x0A, 0xFF, 0x07,
+    0x14, 0x10, 0x04, 0x00, 0x4D, 0x4F, 0x43, 0x4B, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x14, 0x10, 0x0A, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00,
+    0x30, 0x40, 0x0A, 0x00, 0xB0, 0x40, 0x0A, 0x00
+};
+
+// streaming interface of audio plays, its alternate setting 1.
+static const uint8_t alts_audio[] = { 0x00, 0x01 };
+
+// indexed by MOCK_SET_*.
+static const mockset mocksets[MOCK_SETS] = {
+    { "hub", "Mock Hub", 0x09, 0x00, 0x01, 0x0200, LIBUSB_SPEED_HIGH,
+      NULL, raw_hub, sizeof( raw_hub ), NULL, 0, NULL, 0 },
+    { "hid", "Mock Keyboard", 0x00, 0x00, 0x00, 0x0110, LIBUSB_SPEED_LOW,
+      NULL, raw_hid, sizeof( raw_hid ), NULL, 0, NULL, 0 },
+    { "storage", "Mock Storage", 0x00, 0x00, 0x00, 0x0320, LIBUSB_SPEED_SUPER,
+      "Mass Storage", raw_storage, sizeof( raw_storage ), bos_storage, sizeof( bos_storage ),
+      NULL, 0 },
+    { "audio", "Mock Audio", 0xEF, 0x02, 0x01, 0x0200, LIBUSB_SPEED_FULL,
+      NULL, raw_audio, sizeof( raw_audio ), NULL, 0,
+      alts_audio, sizeof( alts_audio ) },
+    { "cdc", "Mock Serial", 0x02, 0x00, 0x00, 0x0200, LIBUSB_SPEED_FULL,
+      NULL, raw_cdc, sizeof( raw_cdc ), NULL, 0, NULL, 0 }
+};
+
+// root hub has no descriptor set of its own, same as hub but xHCI ids.
+static const mockset mockroot = {
+    "root", "Mock Root Hub", 0x09, 0x00, 0x03, 0x0300, LIBUSB_SPEED_SUPER,
+    NULL, raw_hub, sizeof( raw_hub ), NULL, 0, NULL, 0
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static mockdev* mock_dev( libusb_device* dev )
+{
+    return (mockdev*)dev;
+}
+
+static void mock_setdesc( mockdev* pd, const mockset* set, uint16_t vid, uint16_t pid )
+{
+    libusb_device_descriptor& desc = pd->desc;
+
+    pd->set = set;
+
+    memset( &desc, 0, sizeof( libusb_device_descriptor ) );
+    desc.bLength            = LIBUSB_DT_DEVICE_SIZE;
+    desc.bDescriptorType    = LIBUSB_DT_DEVICE;
+    desc.bcdUSB             = libusb_cpu_to_le16( set->bcd );
+    desc.bDeviceClass       = set->clsid;
+    desc.bDeviceSubClass    = set->subclsid;
+    desc.bDeviceProtocol    = set->protocol;
+    desc.bMaxPacketSize0    = set->bcd >= 0x0300 ? 9 : 64;
+    desc.idVendor           = vid;
+    desc.idProduct          = pid;
+    desc.bcdDevice          = 0x0100;
+    desc.iManufacturer      = 1;
+    desc.iProduct           = 2;
+    desc.iSerialNumber      = set->clsid == LIBUSB_CLASS_HUB ? 0 : 3;
+    desc.bNumConfigurations = 1;
+}
+
+// string of index as mock device answers, NULL for no such string.
+static const char* mock_string( const mockdev* pd, uint8_t idx, char* buff, size_t len )
+{
+    switch( idx )
+    {
+        case 1:
+            return pd->desc.idVendor == MOCK_ROOTVID ? "Linux Foundation" : "Mock Devices";
+
+        case 2:
+            return pd->set->product;
+
+        case 3:
+            if ( pd->desc.iSerialNumber == 0 )
+                return NULL;
+            snprintf( buff, len, "MOCK%08X", pd->serial );
+            return buff;
+
+        case 4:
+            return pd->set->config;
+    }
+
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static ssize_t LIBUSB_CALL mock_get_device_list( libusb_context* ctx, libusb_device*** list )
+{
+    usbmock* mock = (usbmock*)ctx;
+    if ( ( mock == NULL ) || ( list == NULL ) )
+        return LIBUSB_ERROR_INVALID_PARAM;
+
+    size_t devs = mock->devs.size();
+    libusb_device** pl = (libusb_device**)calloc( devs + 1, sizeof( libusb_device* ) );
+    if ( pl == NULL )
+        return LIBUSB_ERROR_NO_MEM;
+
+    for ( size_t cnt=0; cnt<devs; cnt++ )
+    {
+        pl[cnt] = (libusb_device*)&mock->devs[cnt];
+    }
+
+    *list = pl;
+    return (ssize_t)devs;
+}
+
+static void LIBUSB_CALL mock_free_device_list( libusb_device** list, int unref )
+{
+    free( list );
+}
+
+// devices live as long as mock, references not counted.
+static libusb_device* LIBUSB_CALL mock_ref_device( libusb_device* dev )
+{
+    return dev;
+}
+
+static void LIBUSB_CALL mock_unref_device( libusb_device* dev )
+{
+}
+
+static int LIBUSB_CALL mock_get_device_descriptor( libusb_device* dev,
+                                                   libusb_device_descriptor* desc )
+{
+    *desc = mock_dev( dev )->desc;
+    return 0;
+}
+
+static uint8_t LIBUSB_CALL mock_get_bus_number( libusb_device* dev )
+{
+    return mock_dev( dev )->bus;
+}
+
+static uint8_t LIBUSB_CALL mock_get_port_number( libusb_device* dev )
+{
+    return mock_dev( dev )->port;
+}
+
+static uint8_t LIBUSB_CALL mock_get_device_address( libusb_device* dev )
+{
+    return mock_dev( dev )->devnum;
+}
+
+static int LIBUSB_CALL mock_get_device_speed( libusb_device* dev )
+{
+    return mock_dev( dev )->set->speed;
+}
+
+static int LIBUSB_CALL mock_get_port_numbers( libusb_device* dev, uint8_t* ports, int len )
+{
+    const mockdev* pd = mock_dev( dev );
+
+    if ( pd->depth > len )
+        return LIBUSB_ERROR_OVERFLOW;
+
+    memcpy( ports, pd->portpath, pd->depth );
+    return pd->depth;
+}
+
+// handle is device itself, nothing to allocate.
+static int LIBUSB_CALL mock_open( libusb_device* dev, libusb_device_handle** handle )
+{
+    *handle = (libusb_device_handle*)dev;
+    return 0;
+}
+
+static void LIBUSB_CALL mock_close( libusb_device_handle* handle )
+{
+}
+
+static int LIBUSB_CALL mock_control_transfer( libusb_device_handle* handle,
+                                              uint8_t reqtype, uint8_t req,
+                                              uint16_t value, uint16_t index,
+                                              unsigned char* data, uint16_t len,
+                                              unsigned int timeout )
+{
+    const mockdev* pd = (const mockdev*)handle;
+
+    if ( pd->latency_us > 0 )
+        this_thread::sleep_for( chrono::microseconds( pd->latency_us ) );
+
+    if ( ( reqtype != LIBUSB_ENDPOINT_IN )
+         || ( req != LIBUSB_REQUEST_GET_DESCRIPTOR ) )
+        return LIBUSB_ERROR_PIPE;
+
+    if ( ( value >> 8 ) == LIBUSB_DT_BOS )
+    {
+        if ( pd->set->bos == NULL )
+            return LIBUSB_ERROR_PIPE;
+
+        size_t boslen = pd->set->boslen < len ? pd->set->boslen : len;
+        memcpy( data, pd->set->bos, boslen );
+        return (int)boslen;
+    }
+
+    if ( ( value >> 8 ) != LIBUSB_DT_STRING )
+        return LIBUSB_ERROR_PIPE;
+
+    uint8_t desc[255] = {0};
+    size_t  desclen = 0;
+    uint8_t idx = value & 0xFF;
+
+    if ( idx == 0 )
+    {
+        // english ( US ) only.
+        desc[2] = 0x09;
+        desc[3] = 0x04;
+        desclen = 4;
+    }
+    else
+    {
+        char sbuff[32] = {0};
+        const char* str = mock_string( pd, idx, sbuff, sizeof( sbuff ) );
+        if ( str == NULL )
+            return LIBUSB_ERROR_PIPE;
+
+        desclen = 2;
+        for ( ; ( *str != 0 ) && ( desclen + 2 <= sizeof( desc ) ); str++ )
+        {
+            desc[desclen++] = (uint8_t)*str;
+            desc[desclen++] = 0;
+        }
+    }
+
+    desc[0] = (uint8_t)desclen;
+    desc[1] = LIBUSB_DT_STRING;
+
+    if ( desclen > len )
+        desclen = len;
+
+    memcpy( data, desc, desclen );
+    return (int)desclen;
+}
+
+static int LIBUSB_CALL mock_get_config_descriptor( libusb_device* dev, uint8_t idx,
+                                                   libusb_config_descriptor** cfg )
+{
+    const mockdev* pd = mock_dev( dev );
+
+    if ( idx >= pd->desc.bNumConfigurations )
+        return LIBUSB_ERROR_NOT_FOUND;
+
+    *cfg = usbsysfs_parseconfig( pd->set->raw, pd->set->rawlen );
+    if ( *cfg == NULL )
+        return LIBUSB_ERROR_NO_MEM;
+
+    return 0;
+}
+
+static void LIBUSB_CALL mock_free_config_descriptor( libusb_config_descriptor* cfg )
+{
+    usbsysfs_freeconfig( cfg );
+}
+
+static int LIBUSB_CALL mock_get_raw_config( libusb_device* dev, uint8_t idx,
+                                            const uint8_t** raw, size_t* len )
+{
+    const mockdev* pd = mock_dev( dev );
+
+    if ( idx >= pd->desc.bNumConfigurations )
+        return LIBUSB_ERROR_NOT_FOUND;
+
+    *raw = pd->set->raw;
+    *len = pd->set->rawlen;
+
+    return 0;
+}
+
+// configured as by kernel, config 1.
+static int LIBUSB_CALL mock_get_active( libusb_device* dev, uint8_t* cfgval,
+                                        uint8_t* alts, size_t altslen )
+{
+    const mockdev* pd = mock_dev( dev );
+
+    *cfgval = 1;
+    memset( alts, 0, altslen );
+
+    if ( pd->set->alts != NULL )
+        memcpy( alts, pd->set->alts, pd->set->altslen < altslen ? pd->set->altslen : altslen );
+
+    return 0;
+}
+
+static const usbbackend mockbackend = {
+    "mock",
+    false,
+    mock_get_device_list,
+    mock_free_device_list,
+    mock_ref_device,
+    mock_unref_device,
+    mock_get_device_descriptor,
+    mock_get_bus_number,
+    mock_get_port_number,
+    mock_get_device_address,
+    mock_get_device_speed,
+    mock_get_port_numbers,
+    mock_open,
+    mock_close,
+    mock_control_transfer,
+    mock_get_config_descriptor,
+    mock_free_config_descriptor,
+    mock_get_raw_config,
+    mock_get_active
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+void usbmock_defaults( usbmockopt* opt )
+{
+    if ( opt == NULL )
+        return;
+
+    opt->devices    = 10;
+    opt->latency_us = 0;
+    opt->ports      = 7;
+    opt->sets       = ( 1 << MOCK_SETS ) - 1;
+}
+
+bool usbmock_parse( const char* spec, usbmockopt* opt )
+{
+    if ( ( spec == NULL ) || ( opt == NULL ) )
+        return false;
+
+    char* endp = NULL;
+    opt->devices = strtoul( spec, &endp, 10 );
+    if ( endp == spec )
+        return false;
+
+    if ( *endp == ':' )
+    {
+        spec = endp + 1;
+        opt->latency_us = strtoul( spec, &endp, 10 );
+        if ( endp == spec )
+            return false;
+    }
+
+    if ( *endp == ':' )
+    {
+        spec = endp + 1;
+        opt->sets = 0;
+
+        while( *spec != 0 )
+        {
+            size_t len = strcspn( spec, "," );
+            size_t set = 0;
+
+            for ( ; set<MOCK_SETS; set++ )
+            {
+                if ( ( strlen( mocksets[set].name ) == len )
+                     && ( strncmp( mocksets[set].name, spec, len ) == 0 ) )
+                    break;
+            }
+
+            if ( set == MOCK_SETS )
+                return false;
+
+            opt->sets |= 1 << set;
+
+            spec += len;
+            if ( *spec == ',' )
+                spec++;
+        }
+
+        return opt->sets != 0;
+    }
+
+    return *endp == 0;
+}
+
+usbmock* usbmock_create( const usbmockopt* opt )
+{
+    usbmockopt defopt;
+    if ( opt == NULL )
+    {
+        usbmock_defaults( &defopt );
+        opt = &defopt;
+    }
+
+    usbmock* mock = new usbmock();
+    mock->opt = *opt;
+
+    if ( mock->opt.ports < 2 )
+        mock->opt.ports = 2;
+    if ( mock->opt.sets == 0 )
+        mock->opt.sets = ( 1 << MOCK_SETS ) - 1;
+
+    size_t buses = ( opt->devices + USBMOCK_BUSDEVS - 1 ) / USBMOCK_BUSDEVS;
+    if ( buses == 0 )
+        buses = 1;
+    if ( buses > 255 )
+        buses = 255;
+
+    mock->devs.reserve( opt->devices + buses );
+
+    size_t   left   = opt->devices;
+    size_t   setidx = 0;
+    uint32_t serial = 0x1000;
+
+    for ( size_t bus=1; bus<=buses; bus++ )
+    {
+        // hubs with free ports, in order of depth.
+        vector< size_t > hubs;
+        vector< unsigned > used;
+
+        mockdev root = mockdev();
+        mock_setdesc( &root, &mockroot, MOCK_ROOTVID, 0x0003 );
+        root.bus    = (uint8_t)bus;
+        root.devnum = 1;
+        root.latency_us = opt->latency_us;
+        hubs.push_back( mock->devs.size() );
+        used.push_back( 0 );
+        mock->devs.push_back( root );
+
+        size_t busdevs = left < USBMOCK_BUSDEVS ? left : USBMOCK_BUSDEVS;
+        size_t freeports = mock->opt.ports;
+        size_t hubpos = 0;
+
+        for ( size_t cnt=0; ( cnt<busdevs ) && ( hubpos<hubs.size() ); cnt++ )
+        {
+            // next set of mask in turn.
+            while( ( mock->opt.sets & ( 1 << setidx ) ) == 0 )
+                setidx = ( setidx + 1 ) % MOCK_SETS;
+
+            size_t set = setidx;
+            setidx = ( setidx + 1 ) % MOCK_SETS;
+
+            const mockdev& parent = mock->devs[ hubs[hubpos] ];
+
+            // becomes a hub until free ports are enough for devices left.
+            if ( ( freeports <= busdevs - cnt - 1 )
+                 && ( parent.depth + 1 < MAX_PORTDEPTH ) )
+                set = MOCK_SET_HUB;
+
+            mockdev md = mockdev();
+            mock_setdesc( &md, &mocksets[set], MOCK_VID, (uint16_t)( 0x0100 + set ) );
+            md.bus     = (uint8_t)bus;
+            md.port    = (uint8_t)( ++used[hubpos] );
+            md.devnum  = (uint8_t)( cnt + 2 );
+            md.depth   = parent.depth + 1;
+            md.serial  = serial++;
+            md.latency_us = opt->latency_us;
+            memcpy( md.portpath, parent.portpath, parent.depth );
+            md.portpath[parent.depth] = md.port;
+
+            freeports--;
+
+            if ( ( set == MOCK_SET_HUB ) && ( md.depth < MAX_PORTDEPTH ) )
+            {
+                hubs.push_back( mock->devs.size() );
+                used.push_back( 0 );
+                freeports += mock->opt.ports;
+            }
+
+            mock->devs.push_back( md );
+
+            if ( used[hubpos] >= mock->opt.ports )
+                hubpos++;
+        }
+
+        left -= busdevs;
+    }
+
+    return mock;
+}
+
+void usbmock_destroy( usbmock* mock )
+{
+    delete mock;
+}
+
+libusb_context* usbmock_context( usbmock* mock )
+{
+    return (libusb_context*)mock;
+}
+
+const usbbackend* usbmock_backend()
+{
+    return &mockbackend;
+}
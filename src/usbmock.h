@@ -0,0 +1,36 @@
+#ifndef __USBMOCK_H__
+#define __USBMOCK_H__
+
+#include "usbbackend.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Synthesized devices for enumeration without USB hardware. Devices are
+// spread over buses of at most USBMOCK_BUSDEVS devices, each one under
+// root hub or under a hub made of same descriptor set, so tree view has
+// real topology. Every string transfer sleeps latency_us, as a slow
+// device would take. Context of backend calls is usbmock_context().
+//
+// Descriptor sets : hub, hid, storage, audio, cdc.
+
+#define USBMOCK_BUSDEVS     126     /// devices of one bus, less root hub.
+
+typedef struct _usbmockopt {
+    size_t          devices;    /// devices, less root hubs.
+    unsigned        latency_us; /// per control transfer.
+    unsigned        ports;      /// ports of each hub.
+    uint32_t        sets;       /// mask of descriptor sets, used in turn.
+}usbmockopt;
+
+typedef struct _usbmock usbmock;
+
+void             usbmock_defaults( usbmockopt* opt );
+// "N[:latency_us[:set,set...]]", as LISTUSB_MOCK environment.
+bool             usbmock_parse( const char* spec, usbmockopt* opt );
+
+usbmock*         usbmock_create( const usbmockopt* opt );
+void             usbmock_destroy( usbmock* mock );
+libusb_context*  usbmock_context( usbmock* mock );
+const usbbackend* usbmock_backend();
+
+#endif /// of __USBMOCK_H__
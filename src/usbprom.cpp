@@ -0,0 +1,214 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif /// of _WIN32
+
+#include "usbprom.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define PROM_PATHMAX        512
+
+// Mbps of libusb_speed, 0 for unknown.
+static const double speedmbps[] = {
+    0.0, 1.5, 12.0, 480.0, 5000.0, 10000.0, 20000.0
+};
+
+typedef struct _prombus {
+    size_t      devs;
+    uint32_t    maxpower;
+}prombus;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void prom_value( FILE* fp, const char* s )
+{
+    fputc( '"', fp );
+
+    for ( ; *s != 0; s++ )
+    {
+        if ( ( *s == '"' ) || ( *s == '\\' ) )
+        {
+            fputc( '\\', fp );
+            fputc( *s, fp );
+        }
+        else
+        if ( *s == '\n' )
+            fputs( "\\n", fp );
+        else
+            fputc( *s, fp );
+    }
+
+    fputc( '"', fp );
+}
+
+// labels of every device metric, port path tells device on same bus.
+static void prom_devlabels( FILE* fp, const snapdev* pd )
+{
+    fprintf( fp, "bus=\"%u\",port_path=\"", pd->bus );
+
+    for ( uint8_t cnt=0; cnt<pd->depth; cnt++ )
+    {
+        fprintf( fp, cnt > 0 ? ".%u" : "%u", pd->portpath[cnt] );
+    }
+
+    fprintf( fp, "\",vid=\"%04x\",pid=\"%04x\"",
+             pd->desc.idVendor, pd->desc.idProduct );
+}
+
+static void prom_help( FILE* fp, const char* name, const char* help )
+{
+    fprintf( fp, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name );
+}
+
+static void prom_metrics( FILE* fp, const usbsnapshot* snap, double scrapesec,
+                          size_t devsread )
+{
+    map< uint8_t, prombus > buses;
+
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+        prombus& pb = buses[ pd->bus ];
+
+        pb.devs++;
+        if ( ( pd->cfgcount > 0 ) && ( snap->cfgs[ pd->cfgfirst ].valid == true ) )
+            pb.maxpower += usbsnap_maxpower( pd, &snap->cfgs[ pd->cfgfirst ] );
+    }
+
+    prom_help( fp, "listusb_devices", "USB devices enumerated." );
+    fprintf( fp, "listusb_devices %zu\n", snap->devs.size() );
+
+    prom_help( fp, "listusb_bus_devices", "USB devices on each bus, root hub included." );
+    for ( map< uint8_t, prombus >::const_iterator it = buses.begin(); it != buses.end(); ++it )
+    {
+        fprintf( fp, "listusb_bus_devices{bus=\"%u\"} %zu\n", it->first, it->second.devs );
+    }
+
+    prom_help( fp, "listusb_bus_max_power_milliamps",
+               "Sum of max power of first config of each device on bus." );
+    for ( map< uint8_t, prombus >::const_iterator it = buses.begin(); it != buses.end(); ++it )
+    {
+        fprintf( fp, "listusb_bus_max_power_milliamps{bus=\"%u\"} %u\n",
+                 it->first, it->second.maxpower );
+    }
+
+    prom_help( fp, "listusb_device_info", "Descriptor and strings of each device, always 1." );
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+
+        fprintf( fp, "listusb_device_info{" );
+        prom_devlabels( fp, pd );
+        fprintf( fp, ",address=\"%u\",class=\"%02x\",bcd_usb=\"%04x\",manufacturer=",
+                 pd->devnum, pd->desc.bDeviceClass,
+                 libusb_cpu_to_le16( pd->desc.bcdUSB ) );
+        prom_value( fp, usbsnap_str( snap, pd->manufacturer ) );
+        fprintf( fp, ",product=" );
+        prom_value( fp, usbsnap_str( snap, pd->product ) );
+        fprintf( fp, ",serial=" );
+        prom_value( fp, usbsnap_str( snap, pd->serialnumber ) );
+        fprintf( fp, "} 1\n" );
+    }
+
+    prom_help( fp, "listusb_device_speed_mbps", "Negotiated speed of each device." );
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+
+        if ( ( pd->speed == 0 )
+             || ( pd->speed >= sizeof( speedmbps ) / sizeof( double ) ) )
+            continue;
+
+        fprintf( fp, "listusb_device_speed_mbps{" );
+        prom_devlabels( fp, pd );
+        fprintf( fp, "} %g\n", speedmbps[ pd->speed ] );
+    }
+
+    prom_help( fp, "listusb_device_max_power_milliamps", "Max power of each config of device." );
+    for ( size_t cnt=0; cnt<snap->devs.size(); cnt++ )
+    {
+        const snapdev* pd = &snap->devs[cnt];
+
+        for ( uint32_t itr=0; itr<pd->cfgcount; itr++ )
+        {
+            const snapcfg* pcf = &snap->cfgs[ pd->cfgfirst + itr ];
+            if ( pcf->valid == false )
+                continue;
+
+            fprintf( fp, "listusb_device_max_power_milliamps{" );
+            prom_devlabels( fp, pd );
+            fprintf( fp, ",config=\"%u\"} %u\n",
+                     pcf->bConfigurationValue, usbsnap_maxpower( pd, pcf ) );
+        }
+    }
+
+    prom_help( fp, "listusb_scrape_duration_seconds", "Time to enumerate devices of this file." );
+    fprintf( fp, "listusb_scrape_duration_seconds %.6f\n", scrapesec );
+
+    prom_help( fp, "listusb_scrape_devices_read", "Devices opened and read for this file, new since last one or read again shortly after arrival." );
+    fprintf( fp, "listusb_scrape_devices_read %zu\n", devsread );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool usbprom_write( const char* path, const usbsnapshot* snap,
+                    double scrapesec, size_t devsread )
+{
+    if ( ( path == NULL ) || ( snap == NULL ) )
+        return false;
+
+    // not *.prom, collector never reads it.
+    char  tmppath[PROM_PATHMAX + 32] = {0};
+    FILE* fp = NULL;
+
+#ifndef _WIN32
+    // new name of mkstemp(), never follows a link left in textfile
+    // directory, mode 0644 for collector of other user.
+    snprintf( tmppath, sizeof( tmppath ), "%s.XXXXXX", path );
+
+    int fd = mkstemp( tmppath );
+    if ( fd < 0 )
+        return false;
+
+    if ( fchmod( fd, 0644 ) == 0 )
+        fp = fdopen( fd, "w" );
+
+    if ( fp == NULL )
+    {
+        close( fd );
+        unlink( tmppath );
+        return false;
+    }
+#else
+    snprintf( tmppath, sizeof( tmppath ), "%s.%u", path, (unsigned)getpid() );
+
+    fp = fopen( tmppath, "w" );
+    if ( fp == NULL )
+        return false;
+#endif /// of _WIN32
+
+    prom_metrics( fp, snap, scrapesec, devsread );
+
+    bool retb = ( ferror( fp ) == 0 );
+    if ( fclose( fp ) != 0 )
+        retb = false;
+
+    if ( ( retb == false ) || ( rename( tmppath, path ) != 0 ) )
+    {
+        unlink( tmppath );
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,17 @@
+#ifndef __USBPROM_H__
+#define __USBPROM_H__
+
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Prometheus text exposition of a snapshot, for textfile collector of
+// node_exporter. Gauges per bus ( devices, max power of first configs )
+// and per device ( info, speed, max power of each config ), labeled by
+// bus and port path. File is written aside and renamed, so collector
+// never reads half written one.
+
+bool usbprom_write( const char* path, const usbsnapshot* snap,
+                    double scrapesec, size_t devsread );
+
+#endif /// of __USBPROM_H__
@@ -0,0 +1,754 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "outbuf.h"
+#include "usbrender.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define SGR_RST             "\033[0m"
+#define SGR_RED             "\033[31m"
+#define SGR_GRN             "\033[32m"
+#define SGR_YEL             "\033[33m"
+#define SGR_LRED            "\033[91m"
+#define SGR_LGRN            "\033[92m"
+#define SGR_LYEL            "\033[93m"
+#define SGR_LBLU            "\033[94m"
+#define SGR_LMAG            "\033[95m"
+#define SGR_LCYN            "\033[96m"
+#define SGR_WHT             "\033[97m"
+
+// writes colored or plain literal by template parameter C, an empty
+// literal is folded out by compiler.
+#define OB_SGR( _col_, _mono_ )     ob_lit< C >( _col_, _mono_ )
+
+template< bool C >
+static inline void ob_lit( const char* col, const char* mono )
+{
+    const char* s = C ? col : mono;
+
+    if ( *s != 0 )
+        ob_puts( s );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template< bool S >
+static const char* classname( uint8_t id )
+{
+    switch( id )
+    {
+        case LIBUSB_CLASS_AUDIO:
+            return S ? "audio;" : "audio device";
+
+        case LIBUSB_CLASS_COMM:
+            return S ? "communicating;" : "communicating device";
+
+        case LIBUSB_CLASS_HID:
+            return S ? "HID;" : "Human Interface Device";
+
+        case LIBUSB_CLASS_PHYSICAL:
+            return S ? "physical;" : "Physical device";
+
+        case LIBUSB_CLASS_IMAGE:
+            return S ? "image;" : "Imaging device";
+
+        case LIBUSB_CLASS_PRINTER:
+            return S ? "printer;" : "Printing device";
+
+        case LIBUSB_CLASS_MASS_STORAGE:
+            return S ? "mass_storage;" : "Mass storage device";
+
+        case LIBUSB_CLASS_HUB:
+            return S ? "HUB;" : "HUB device";
+
+        case LIBUSB_CLASS_DATA:
+            return S ? "data;" : "Data device";
+
+        case LIBUSB_CLASS_SMART_CARD:
+            return S ? "smartcard;" : "Smart Card device";
+
+        case LIBUSB_CLASS_CONTENT_SECURITY:
+            return S ? "content_security;" : "Content Security device";
+
+        case LIBUSB_CLASS_VIDEO:
+            return S ? "video;" : "Video device";
+
+        case LIBUSB_CLASS_PERSONAL_HEALTHCARE:
+            return S ? "personal_healthcare;" : "Personal Healthcare device";
+
+        case LIBUSB_CLASS_DIAGNOSTIC_DEVICE:
+            return S ? "diagnostic;" : "Diagnositc device";
+
+        case LIBUSB_CLASS_WIRELESS:
+            return S ? "wireless;" : "Wireless device";
+
+        case LIBUSB_CLASS_MISCELLANEOUS:
+            return S ? "misc.;" : "Miscellaneous device";
+
+        case LIBUSB_CLASS_APPLICATION:
+            return S ? "application;" : "Application device";
+
+        case LIBUSB_CLASS_VENDOR_SPEC:
+            return S ? "vendor-spec;" : "Vendor-Specific device";
+    }
+
+    return NULL;
+}
+
+// short class name of tree view.
+static const char* treeclassname( uint8_t id )
+{
+    switch( id )
+    {
+        case LIBUSB_CLASS_PER_INTERFACE:        return "PER";
+        case LIBUSB_CLASS_AUDIO:                return "AUD.";
+        case LIBUSB_CLASS_COMM:                 return "COM.";
+        case LIBUSB_CLASS_HID:                  return "HID";
+        case LIBUSB_CLASS_PHYSICAL:             return "PHY.";
+        case LIBUSB_CLASS_IMAGE:                return "IMG.";
+        case LIBUSB_CLASS_PRINTER:              return "PRT.";
+        case LIBUSB_CLASS_MASS_STORAGE:         return "MSD.";
+        case LIBUSB_CLASS_HUB:                  return "HUB";
+        case LIBUSB_CLASS_DATA:                 return "DAT.";
+        case LIBUSB_CLASS_SMART_CARD:           return "SCD.";
+        case LIBUSB_CLASS_CONTENT_SECURITY:     return "CSD.";
+        case LIBUSB_CLASS_VIDEO:                return "VID.";
+        case LIBUSB_CLASS_PERSONAL_HEALTHCARE:  return "PHD.";
+        case LIBUSB_CLASS_DIAGNOSTIC_DEVICE:    return "DIA.";
+        case LIBUSB_CLASS_WIRELESS:             return "WLS.";
+        case LIBUSB_CLASS_MISCELLANEOUS:        return "MISC.";
+        case LIBUSB_CLASS_APPLICATION:          return "APP.";
+        case LIBUSB_CLASS_VENDOR_SPEC:          return "VSC";
+    }
+
+    return NULL;
+}
+
+template< bool S >
+static void prtclassname( uint8_t id, uint8_t subid )
+{
+    if ( id == LIBUSB_CLASS_PER_INTERFACE )
+    {
+        if ( ( subid > 0 ) && ( S == false ) )
+        {
+            ob_puts( "PER interface " );
+            ob_hex( subid, 2 );
+            ob_puts( " device.\n" );
+        }
+        else
+        {
+            ob_puts( "PER/" );
+            ob_hex( subid, 2 );
+            ob_putc( ';' );
+        }
+        return;
+    }
+
+    const char* name = classname< S >( id );
+
+    if ( name != NULL )
+    {
+        ob_puts( name );
+    }
+    else
+    if ( S == false )
+    {
+        ob_puts( "Unknown " );
+        ob_hex( id, 2 );
+        ob_puts( " class type device" );
+    }
+    else
+    {
+        ob_hex( id, 2 );
+        ob_putc( ';' );
+    }
+}
+
+// device class line.
+template< bool S, bool C >
+static void prtclass( uint8_t id, uint8_t subid )
+{
+    OB_SGR( S ? SGR_LBLU "cls=" SGR_LYEL : SGR_LBLU "Class = " SGR_LYEL,
+            S ? "cls=" : "Class = " );
+    prtclassname< S >( id, subid );
+    OB_SGR( S ? SGR_RST : SGR_RST "\n",
+            S ? "" : "\n" );
+}
+
+// class of interface alt.setting, always in normal view.
+template< bool C >
+static void prtaltclass( uint8_t id, uint8_t subid )
+{
+    OB_SGR( SGR_RED, "" );
+    prtclassname< false >( id, subid );
+    OB_SGR( SGR_RST, "" );
+}
+
+template< bool S, bool C >
+static void prtbcd( uint16_t id )
+{
+    OB_SGR( S ? SGR_LRED : SGR_LYEL "USB " SGR_LRED,
+            S ? "" : "USB " );
+    ob_dec( id >> 8 );
+    ob_putc( '.' );
+    ob_dec( ( id & 0x00F0 ) >> 4 );
+}
+
+static const char* eptypes[] = {
+    "Control", "Isochronous", "Bulk", "Interrupt"
+};
+
+static const char* epsyncs[] = {
+    "No-Sync", "Asynchronous", "Adaptive", "Synchronous"
+};
+
+static const char* epusages[] = {
+    "Data", "Feedback", "Implicit feedback Data", "Reserved"
+};
+
+// one decimal, of kB/s, MB/s or GB/s.
+static void prtrate( uint64_t bps )
+{
+    const char* unit = " GB/s";
+    uint64_t    div  = 1000000000;
+
+    if ( bps < 1000 )
+    {
+        ob_dec( bps );
+        ob_puts( " B/s" );
+        return;
+    }
+
+    if ( bps < 1000000 )
+    {
+        unit = " kB/s";
+        div  = 1000;
+    }
+    else
+    if ( bps < 1000000000 )
+    {
+        unit = " MB/s";
+        div  = 1000000;
+    }
+
+    uint64_t tenths = ( bps * 10 + div / 2 ) / div;
+
+    ob_dec( tenths / 10 );
+    ob_putc( '.' );
+    ob_dec( tenths % 10 );
+    ob_puts( unit );
+}
+
+static void prtinterval( uint32_t us )
+{
+    ob_puts( " every " );
+
+    if ( ( us >= 1000 ) && ( ( us % 1000 ) == 0 ) )
+    {
+        ob_dec( us / 1000 );
+        ob_puts( " ms" );
+        return;
+    }
+
+    ob_dec( us );
+    ob_puts( " us" );
+}
+
+// class specific descriptors after endpoint, companions are decoded.
+template< bool C >
+static void prtepextra( const uint8_t* extra, size_t extralen )
+{
+    usbdescview v = { NULL, 0, extra, extralen };
+    size_t off  = 0;
+    size_t last = 0;
+    bool   first = true;
+    const uint8_t* cs = NULL;
+
+    while( usbdesc_nextextra( &v, &off, &cs ) == true )
+    {
+        if ( off > extralen )
+            off = extralen;
+
+        if ( ( cs[1] != USBDESC_DT_SSEPCOMP ) && ( cs[1] != USBDESC_DT_SSPISOCOMP ) )
+        {
+            if ( first == true )
+            {
+                OB_SGR( ", " SGR_YEL, ", " );
+                first = false;
+            }
+
+            for ( size_t q=last; q<off; q++ )
+                ob_hex( extra[q], 2 );
+        }
+
+        last = off;
+    }
+
+    // broken one, as it is.
+    for ( size_t q=last; q<extralen; q++ )
+    {
+        if ( first == true )
+        {
+            OB_SGR( ", " SGR_YEL, ", " );
+            first = false;
+        }
+
+        ob_hex( extra[q], 2 );
+    }
+}
+
+template< bool C >
+static void prtendpoint( const usbsnapshot* snap, uint8_t speed, const snapep* pep )
+{
+    const uint8_t* extra = usbsnap_bytes( snap, pep->extra );
+    usbdescep de;
+
+    usbdesc_endpoint( speed, pep->bmAttributes, pep->wMaxPacketSize, pep->bInterval,
+                      extra, pep->extralen, &de );
+
+    ob_hex( pep->bmAttributes, 2 );
+    OB_SGR( " (" SGR_RED " ", " ( " );
+    ob_puts( eptypes[de.type] );
+
+    // sync and usage are reserved bits of other types.
+    if ( de.type == LIBUSB_ENDPOINT_TRANSFER_TYPE_ISOCHRONOUS )
+    {
+        ob_puts( ", " );
+        ob_puts( epsyncs[ ( pep->bmAttributes >> 2 ) & 0x03 ] );
+        ob_puts( ", " );
+        ob_puts( epusages[ ( pep->bmAttributes >> 4 ) & 0x03 ] );
+    }
+
+    OB_SGR( SGR_LGRN " )", " )" );
+
+    if ( ( pep->bEndpointAddress & LIBUSB_ENDPOINT_DIR_MASK ) == LIBUSB_ENDPOINT_IN )
+        ob_puts( " EP:IN, " );
+    else
+        ob_puts( " EP:OUT, " );
+
+    if ( ( speed == LIBUSB_SPEED_HIGH ) && ( de.mult > 1 ) )
+    {
+        ob_dec( de.mult );
+        ob_puts( " x " );
+    }
+
+    ob_dec( de.maxpacket );
+    ob_puts( " bytes" );
+
+    if ( de.companion == true )
+    {
+        ob_puts( ", burst " );
+        ob_dec( de.burst );
+
+        if ( de.mult > 1 )
+        {
+            ob_puts( ", mult " );
+            ob_dec( de.mult );
+        }
+
+        if ( de.streams > 0 )
+        {
+            ob_puts( ", " );
+            ob_dec( de.streams );
+            ob_puts( " streams" );
+        }
+    }
+
+    if ( de.interval > 0 )
+    {
+        // bursts of SuperSpeed, payload of whole interval.
+        if ( de.bytes != de.maxpacket * de.mult )
+        {
+            ob_puts( ", " );
+            ob_dec( de.bytes );
+            ob_puts( " bytes" );
+        }
+
+        prtinterval( de.interval );
+    }
+
+    uint64_t rate = usbdesc_epmaxrate( speed, &de );
+    if ( rate > 0 )
+    {
+        ob_puts( ", max " );
+        prtrate( rate );
+    }
+
+    prtepextra< C >( extra, pep->extralen );
+}
+
+template< bool C >
+static void prtinterfaces( const usbsnapshot* snap, uint8_t speed, const snapcfg* pcf )
+{
+    for ( int x=0; x<pcf->bNumInterfaces; x++ )
+    {
+        const snapif* pif = &snap->ifs[pcf->iffirst + x];
+        int altcnt = pif->altcount;
+
+        OB_SGR( SGR_WHT "        - interface[" SGR_LCYN,
+                "        - interface[" );
+        ob_int( x );
+        OB_SGR( SGR_WHT "] : ", "] : " );
+
+        if ( pcf->extralen > 0 )
+        {
+            ob_puts( usbsnap_str( snap, pcf->extra ) );
+            ob_puts( ", " );
+        }
+
+        OB_SGR( SGR_LCYN "alt.settings = " SGR_LYEL, "alt.settings = " );
+        ob_int( altcnt );
+        OB_SGR( SGR_WHT, "" );
+
+        if ( altcnt > 0 )
+        {
+            const snapalt* palts = &snap->alts[pif->altfirst];
+
+            ob_puts( " : " );
+            for ( int q=0; q<altcnt; q++ )
+            {
+                prtaltclass< C >( palts[q].bInterfaceClass,
+                                  palts[q].bInterfaceSubClass );
+                if ( q+1 < altcnt )
+                {
+                    ob_puts( ", " );
+                }
+            }
+
+            ob_putc( '\n' );
+
+            for( int y=0; y<altcnt; y++ )
+            {
+                const snapalt* pas = &palts[y];
+
+                OB_SGR( SGR_LCYN "            -> ep[" SGR_LMAG,
+                        "            -> ep[" );
+                ob_int( y );
+                OB_SGR( SGR_LCYN "]" SGR_LRED "=" SGR_LGRN, "]=" );
+                ob_int( pas->bNumEndpoints );
+                OB_SGR( SGR_LMAG ":", ":" );
+
+                for ( int z=0; z<pas->bNumEndpoints; z++ )
+                {
+                    const snapep* pep = &snap->eps[pas->epfirst + z];
+
+                    OB_SGR( SGR_GRN, "" );
+                    prtendpoint< C >( snap, speed, pep );
+
+                    if ( z+1 < pas->bNumEndpoints )
+                    {
+                        ob_puts( "\n                       " );
+                    }
+                }
+
+                if( y+1 < altcnt )
+                {
+                    OB_SGR( SGR_RST "\n", "\n" );
+                }
+            }
+
+            OB_SGR( SGR_LCYN "\n", "\n" );
+        }
+
+        OB_SGR( SGR_RST, "" );
+    }
+}
+
+template< bool S, bool C, bool L >
+static void prtconfig( const usbsnapshot* snap, uint8_t idx, const snapdev* pd,
+                       const snapcfg* pcf )
+{
+    const char* cfgstr = usbsnap_str( snap, pcf->cfgstr );
+
+    uint32_t pwrCalc = usbsnap_maxpower( pd, pcf );
+
+    if ( S == false )
+    {
+        OB_SGR( SGR_LYEL "    + " SGR_LBLU "config[" SGR_LMAG,
+                "    + config[" );
+        ob_dec( idx, 2 );
+
+        if ( cfgstr[0] != 0 )
+        {
+            OB_SGR( SGR_LBLU "] " SGR_RST " : " SGR_LYEL, "]  : " );
+            ob_puts( cfgstr );
+            OB_SGR( ", " SGR_LBLU "interfaces = " SGR_LYEL,
+                    ", interfaces = " );
+        }
+        else
+        {
+            OB_SGR( SGR_LBLU "], interfaces = " SGR_LYEL,
+                    "], interfaces = " );
+        }
+
+        ob_dec( pcf->bNumInterfaces );
+        OB_SGR( ", " SGR_LMAG "ID = " SGR_LYEL "0x", ", ID = 0x" );
+        ob_hex( pcf->bConfigurationValue, 2 );
+        OB_SGR( ", " SGR_LBLU "max required power = " SGR_LYEL,
+                ", max required power = " );
+        ob_dec( pwrCalc );
+        OB_SGR( " mA\n" SGR_RST, " mA\n" );
+
+        if ( ( L == false ) && ( pcf->bNumInterfaces > 0 ) )
+        {
+            prtinterfaces< C >( snap, pd->speed, pcf );
+        }
+    }
+    else
+    {
+        OB_SGR( SGR_LBLU "MRP=" SGR_LYEL, "MRP=" );
+        ob_dec( pwrCalc );
+        OB_SGR( "(mA)\n" SGR_RST, "(mA)\n" );
+    }
+}
+
+template< bool S, bool C, bool L >
+static void prtdevice( const usbsnapshot* snap, size_t idx )
+{
+    const snapdev* pd = &snap->devs[idx];
+
+    if ( pd->descerr != 0 )
+        return;
+
+    const libusb_device_descriptor& desc = pd->desc;
+
+    const char* dev_pn = usbsnap_str( snap, pd->product );
+    const char* dev_mn = usbsnap_str( snap, pd->manufacturer );
+    const char* dev_sn = usbsnap_str( snap, pd->serialnumber );
+
+    if ( S == false )
+    {
+        OB_SGR( SGR_LBLU "Bus " SGR_LYEL, "Bus " );
+        ob_dec( pd->bus, 3, '0' );
+        OB_SGR( ", " SGR_LBLU "Port " SGR_WHT, ", Port " );
+        ob_dec( pd->port, 3, '0' );
+        OB_SGR( " " SGR_LGRN "[", " [" );
+    }
+    else
+    {
+        OB_SGR( SGR_LYEL, "" );
+        ob_dec( pd->bus, 3, '0' );
+        OB_SGR( ";" SGR_WHT, ";" );
+        ob_dec( pd->port, 3, '0' );
+        OB_SGR( ";" SGR_LGRN "[", ";[" );
+    }
+
+    ob_hex( desc.idVendor, 4 );
+    ob_putc( ':' );
+    ob_hex( desc.idProduct, 4 );
+    OB_SGR( S ? "];" SGR_LRED : "] " SGR_LRED,
+            S ? "];" : "] " );
+
+    if ( dev_mn[0] != 0 )
+    {
+        ob_puts( dev_mn );
+        OB_SGR( S ? ";" SGR_LMAG : ", " SGR_LMAG,
+                S ? ";" : ", " );
+    }
+    else
+    {
+        OB_SGR( S ? ";" SGR_LMAG : "(no manufacturer)" SGR_LMAG,
+                S ? ";" : "(no manufacturer)" );
+    }
+
+    if ( dev_pn[0] != 0 )
+    {
+        ob_puts( dev_pn );
+        OB_SGR( S ? ";" SGR_LYEL : "\n" SGR_LYEL "    + ",
+                S ? ";" : "\n    + " );
+    }
+    else
+    {
+        OB_SGR( S ? ";" SGR_LYEL : "(no product name)\n" SGR_LYEL "    + ",
+                S ? ";" : "(no product name)\n    + " );
+    }
+
+    if ( dev_sn[0] != 0 )
+    {
+        OB_SGR( S ? "" : SGR_LBLU "Serial number =" SGR_LYEL " ",
+                S ? "" : "Serial number = " );
+        ob_puts( dev_sn );
+        ob_putc( S ? ';' : '\n' );
+    }
+    else
+    {
+        OB_SGR( S ? ";" : SGR_LRED "(SN not found)\n",
+                S ? ";" : "(SN not found)\n" );
+    }
+
+    // device abandoned by --device-timeout or --deadline.
+    if ( pd->timedout == true )
+    {
+        OB_SGR( S ? SGR_LRED "timeout;" : SGR_LRED "    + (timed out, strings incomplete)\n",
+                S ? "timeout;" : "    + (timed out, strings incomplete)\n" );
+    }
+
+    if ( ( desc.bDeviceClass > 0 ) || ( desc.bDeviceSubClass > 0 ) )
+    {
+        OB_SGR( S ? "" : SGR_LYEL "    + ", S ? "" : "    + " );
+        prtclass< S, C >( desc.bDeviceClass, desc.bDeviceSubClass );
+    }
+    else
+    if ( S == true )
+    {
+        OB_SGR( SGR_LBLU "cls=" SGR_LYEL "none;", "cls=none;" );
+    }
+
+    uint16_t l16bcdID = libusb_cpu_to_le16( desc.bcdUSB );
+
+    if ( S == false )
+    {
+        OB_SGR( SGR_LYEL "    + " SGR_LBLU "bcdID = " SGR_LYEL,
+                "    + bcdID = " );
+        ob_hex( l16bcdID, 4 );
+        OB_SGR( "," SGR_LBLU " human readable = ", ", human readable = " );
+        prtbcd< S, C >( l16bcdID );
+        ob_putc( '\n' );
+    }
+    else
+    {
+        OB_SGR( SGR_LBLU "bcdID=" SGR_LYEL, "bcdID=" );
+        ob_hex( l16bcdID, 4 );
+        ob_putc( '(' );
+        prtbcd< S, C >( l16bcdID );
+        OB_SGR( SGR_LYEL ");", ");" );
+    }
+
+    // print configs
+    for ( size_t itr=0; itr<pd->cfgcount; itr++ )
+    {
+        const snapcfg* pcf = &snap->cfgs[pd->cfgfirst + itr];
+
+        if ( pcf->valid == true )
+        {
+            prtconfig< S, C, L >( snap, itr, pd, pcf );
+        }
+        else
+        {
+            ob_putc( '\n' );
+        }
+    }
+}
+
+template< bool C >
+static void prtreftable()
+{
+    OB_SGR( SGR_LYEL "BUS;" SGR_WHT "Port;" SGR_LGRN "[ PID: VID]; "
+            SGR_LRED "manufacturer; " SGR_LMAG "product name; "
+            SGR_LRED "serial No.; " SGR_LBLU "class; "
+            SGR_LYEL "bcdID; " SGR_WHT "MRP(mA)\n" SGR_RST,
+            "BUS;Port;[ PID: VID]; manufacturer; product name; "
+            "serial No.; class; bcdID; MRP(mA)\n" );
+}
+
+template< bool C >
+static void prttreebus( uint8_t bus, size_t devs )
+{
+    OB_SGR( SGR_LBLU "Bus " SGR_LYEL, "Bus " );
+    ob_dec( bus, 3, '0' );
+    OB_SGR( SGR_LMAG " : " SGR_LGRN, " : " );
+    ob_dec( devs );
+    ob_puts( " devices\n" );
+}
+
+template< bool S, bool C >
+static void prttreedev( const usbtreedev* pn )
+{
+    // guide line of each upper level, while it has more siblings below.
+    const usbtreedev* ups[MAX_PORTDEPTH + 1];
+    size_t levels = 0;
+
+    for ( const usbtreedev* pp = pn->parent;
+          ( pp != NULL ) && ( levels < MAX_PORTDEPTH + 1 ); pp = pp->parent )
+    {
+        ups[levels++] = pp;
+    }
+
+    OB_SGR( SGR_LYEL "  ", "  " );
+    while( levels > 0 )
+    {
+        ob_puts( ups[--levels]->next != NULL ? "|   " : "    " );
+    }
+    OB_SGR( "+-- " SGR_LBLU "Port " SGR_WHT, "+-- Port " );
+    ob_dec( pn->port, 3, '0' );
+    OB_SGR( " " SGR_LGRN "[", " [" );
+    ob_hex( pn->vid, 4 );
+    ob_putc( ':' );
+    ob_hex( pn->pid, 4 );
+    ob_puts( "] " );
+
+    prtbcd< S, C >( pn->bcd );
+
+    OB_SGR( ", " SGR_LYEL, ", " );
+    const char* cname = treeclassname( pn->clsid );
+    if ( cname != NULL )
+        ob_puts( cname );
+    else
+        ob_hex( pn->clsid, 4 );
+    OB_SGR( ", " SGR_LCYN, ", " );
+    ob_puts( pn->serialnumber );
+    OB_SGR( ", " SGR_LRED, ", " );
+    ob_puts( pn->manufacturer );
+    OB_SGR( ", " SGR_LMAG, ", " );
+    ob_puts( pn->product );
+    OB_SGR( SGR_RST "\n", "\n" );
+}
+
+template< bool S, bool C >
+static void prtwatchmark( bool arrived )
+{
+    if ( arrived == true )
+    {
+        OB_SGR( S ? SGR_LGRN "+;" SGR_RST : SGR_LGRN "[+] " SGR_RST,
+                S ? "+;" : "[+] " );
+    }
+    else
+    {
+        OB_SGR( S ? SGR_LRED "-;" SGR_RST : SGR_LRED "[-] " SGR_RST,
+                S ? "-;" : "[-] " );
+    }
+}
+
+template< bool C >
+static void prtwatchbus( uint8_t bus )
+{
+    OB_SGR( SGR_LBLU "Bus " SGR_LYEL, "Bus " );
+    ob_dec( bus, 3, '0' );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define USBRENDERER( _s_, _c_, _l_ ) \
+    { \
+        prtreftable< _c_ >, \
+        prtdevice< _s_, _c_, _l_ >, \
+        prttreebus< _c_ >, \
+        prttreedev< _s_, _c_ >, \
+        prtwatchmark< _s_, _c_ >, \
+        prtwatchbus< _c_ > \
+    }
+
+// indexed by ( simple << 2 ) | ( color << 1 ) | lessinfo.
+static const usbrenderer renderers[8] = {
+    USBRENDERER( false, false, false ),
+    USBRENDERER( false, false, true  ),
+    USBRENDERER( false, true,  false ),
+    USBRENDERER( false, true,  true  ),
+    USBRENDERER( true,  false, false ),
+    USBRENDERER( true,  false, true  ),
+    USBRENDERER( true,  true,  false ),
+    USBRENDERER( true,  true,  true  )
+};
+
+const usbrenderer* usbrender_select( bool simple, bool color, bool lessinfo )
+{
+    size_t idx = ( simple ? 4 : 0 ) | ( color ? 2 : 0 ) | ( lessinfo ? 1 : 0 );
+
+    return &renderers[idx];
+}
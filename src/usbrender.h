@@ -0,0 +1,25 @@
+#ifndef __USBRENDER_H__
+#define __USBRENDER_H__
+
+#include "usbsnap.h"
+#include "usbtree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Text renderers, each one generated from templates specialized on
+// ( simple, color, lessinfo ). Color escape codes are merged into string
+// literals at compile time, so a renderer has no mode branch inside.
+// All of them write to outbuf.
+
+typedef struct _usbrenderer {
+    void (*reftable)();
+    void (*device)( const usbsnapshot* snap, size_t idx );
+    void (*treebus)( uint8_t bus, size_t devs );
+    void (*treedev)( const usbtreedev* pn );
+    void (*watchmark)( bool arrived );
+    void (*watchbus)( uint8_t bus );
+}usbrenderer;
+
+const usbrenderer* usbrender_select( bool simple, bool color, bool lessinfo );
+
+#endif /// of __USBRENDER_H__
@@ -0,0 +1,358 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+
+#include "usbsnap.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t poolbytes( usbsnapshot& snap, const uint8_t* src, size_t len, bool term )
+{
+    if ( ( src == NULL ) || ( len == 0 ) )
+        return SNAP_NOSTR;
+
+    uint32_t off = snap.pool.size();
+    snap.pool.insert( snap.pool.end(), (const char*)src, (const char*)src + len );
+
+    if ( term == true )
+        snap.pool.push_back( 0 );
+
+    return off;
+}
+
+// as trimStrInner(), leading and trailing spaces are not kept.
+static uint32_t poolstr( usbsnapshot& snap, const uint8_t* src, size_t maxlen )
+{
+    const char* ps  = (const char*)src;
+    size_t      len = strnlen( ps, maxlen );
+
+    while( ( len > 0 ) && isspace( (uint8_t)ps[len - 1] ) ) --len;
+    while( ( len > 0 ) && isspace( (uint8_t)*ps ) ) ++ps, --len;
+
+    return poolbytes( snap, (const uint8_t*)ps, len, true );
+}
+
+// alt at view, endpoints right after it, missing ones zeroed as libusb.
+static void rawalt( usbsnapshot& snap, usbdesciter* it, const usbdescview* pv )
+{
+    snapalt sa = snapalt();
+    sa.bInterfaceNumber   = pv->data[USBDESC_IF_NUMBER];
+    sa.bAlternateSetting  = pv->data[USBDESC_IF_ALT];
+    sa.bInterfaceClass    = pv->data[USBDESC_IF_CLASS];
+    sa.bInterfaceSubClass = pv->data[USBDESC_IF_SUBCLASS];
+    sa.bInterfaceProtocol = pv->data[USBDESC_IF_PROTOCOL];
+    sa.bNumEndpoints      = pv->data[USBDESC_IF_NUMEPS];
+    sa.epfirst            = snap.eps.size();
+    snap.alts.push_back( sa );
+
+    for ( uint8_t z=0; z<sa.bNumEndpoints; z++ )
+    {
+        snapep se = snapep();
+
+        usbdesciter eit = *it;
+        usbdescview ev;
+
+        if ( ( usbdesc_next( &eit, &ev ) == true )
+             && ( ev.avail >= LIBUSB_DT_ENDPOINT_SIZE )
+             && ( usbdesc_type( &ev ) == LIBUSB_DT_ENDPOINT ) )
+        {
+            *it = eit;
+
+            se.bEndpointAddress = ev.data[USBDESC_EP_ADDRESS];
+            se.bmAttributes     = ev.data[USBDESC_EP_ATTR];
+            se.wMaxPacketSize   = usbdesc_u16( &ev.data[USBDESC_EP_MAXPKT] );
+            se.bInterval        = ev.data[USBDESC_EP_INTERVAL];
+            se.extra    = poolbytes( snap, ev.extra, ev.extralen, false );
+            se.extralen = ev.extralen;
+        }
+
+        snap.eps.push_back( se );
+    }
+}
+
+// next interface descriptor in libusb tree, false at end of tree.
+static bool rawnextif( usbdesciter* it, usbdescview* pv, uint8_t numifs )
+{
+    while( usbdesc_next( it, pv ) == true )
+    {
+        if ( pv->avail < LIBUSB_DT_INTERFACE_SIZE )
+            return false;
+
+        if ( usbdesc_type( pv ) != LIBUSB_DT_INTERFACE )
+            continue;
+
+        return ( pv->data[USBDESC_IF_NUMBER] < numifs );
+    }
+
+    return false;
+}
+
+// one pass when interface numbers never go back, as nearly every device.
+static bool rawordered( usbsnapshot& snap, const snapcfg& sc, usbdesciter it )
+{
+    usbdescview v;
+
+    while( rawnextif( &it, &v, sc.bNumInterfaces ) == true )
+    {
+        size_t ifnum = v.data[USBDESC_IF_NUMBER];
+        size_t ifcnt = snap.ifs.size() - sc.iffirst;
+
+        if ( ifnum + 1 < ifcnt )
+            return false;
+
+        while( ifnum + 1 > ifcnt )
+        {
+            snapif si = snapif();
+            si.altfirst = snap.alts.size();
+            snap.ifs.push_back( si );
+            ifcnt++;
+        }
+
+        snap.ifs.back().altcount++;
+        rawalt( snap, &it, &v );
+    }
+
+    while( snap.ifs.size() - sc.iffirst < sc.bNumInterfaces )
+    {
+        snapif si = snapif();
+        si.altfirst = snap.alts.size();
+        snap.ifs.push_back( si );
+    }
+
+    return true;
+}
+
+// scan for each interface number, from first interface not passed yet.
+static void rawscan( usbsnapshot& snap, const snapcfg& sc, usbdesciter cit )
+{
+    usbdescview v;
+
+    for ( uint8_t x=0; x<sc.bNumInterfaces; x++ )
+    {
+        size_t ifidx = snap.ifs.size();
+
+        snapif si = snapif();
+        si.altfirst = snap.alts.size();
+        snap.ifs.push_back( si );
+
+        usbdesciter it = cit;
+        bool        nextfound = false;
+
+        for(;;)
+        {
+            usbdesciter at = it;
+
+            if ( rawnextif( &it, &v, sc.bNumInterfaces ) == false )
+                break;
+
+            if ( v.data[USBDESC_IF_NUMBER] != x )
+            {
+                if ( ( nextfound == false ) && ( v.data[USBDESC_IF_NUMBER] > x ) )
+                {
+                    cit = at;
+                    nextfound = true;
+                }
+                continue;
+            }
+
+            snap.ifs[ifidx].altcount++;
+            rawalt( snap, &it, &v );
+        }
+    }
+}
+
+// same layout as libusb tree : alts grouped by interface number, stops
+// at interface number out of config.
+static void appendraw( usbsnapshot& snap, snapcfg& sc, const usbcfgfetch* pcf )
+{
+    usbdesciter it;
+    usbdescview v;
+
+    if ( usbdesc_config( &it, pcf->raw.data(), pcf->raw.size(), &v ) == false )
+        return;
+
+    sc.valid               = true;
+    sc.bNumInterfaces      = v.data[USBDESC_CFG_NUMIFS];
+    sc.bConfigurationValue = v.data[USBDESC_CFG_VALUE];
+    sc.MaxPower            = v.data[USBDESC_CFG_POWER];
+    sc.cfgstr   = poolstr( snap, pcf->cfgstr, SLEN_CONFIG );
+    sc.extra    = poolbytes( snap, v.extra, v.extralen, true );
+    sc.extralen = v.extralen;
+
+    size_t alts = snap.alts.size();
+    size_t eps  = snap.eps.size();
+    size_t pool = snap.pool.size();
+
+    if ( rawordered( snap, sc, it ) == true )
+        return;
+
+    snap.ifs.resize( sc.iffirst );
+    snap.alts.resize( alts );
+    snap.eps.resize( eps );
+    snap.pool.resize( pool );
+
+    rawscan( snap, sc, it );
+}
+
+static void appendconfig( usbsnapshot& snap, const usbcfgfetch* pcf )
+{
+    snapcfg sc = snapcfg();
+
+    const libusb_config_descriptor* cfg = pcf->cfg;
+
+    sc.iffirst = snap.ifs.size();
+
+    if ( cfg != NULL )
+    {
+        sc.valid               = true;
+        sc.bNumInterfaces      = cfg->bNumInterfaces;
+        sc.bConfigurationValue = cfg->bConfigurationValue;
+        sc.MaxPower            = cfg->MaxPower;
+        sc.cfgstr   = poolstr( snap, pcf->cfgstr, SLEN_CONFIG );
+        sc.extra    = poolbytes( snap, cfg->extra, cfg->extra_length, true );
+        sc.extralen = cfg->extra_length;
+
+        for ( size_t x=0; x<cfg->bNumInterfaces; x++ )
+        {
+            const libusb_interface* pif = &cfg->interface[x];
+
+            snapif si = snapif();
+            si.altfirst = snap.alts.size();
+            si.altcount = pif->num_altsetting;
+            snap.ifs.push_back( si );
+
+            for ( int y=0; y<pif->num_altsetting; y++ )
+            {
+                const libusb_interface_descriptor* pas = &pif->altsetting[y];
+
+                snapalt sa = snapalt();
+                sa.bInterfaceNumber   = pas->bInterfaceNumber;
+                sa.bAlternateSetting  = pas->bAlternateSetting;
+                sa.bInterfaceClass    = pas->bInterfaceClass;
+                sa.bInterfaceSubClass = pas->bInterfaceSubClass;
+                sa.bInterfaceProtocol = pas->bInterfaceProtocol;
+                sa.bNumEndpoints      = pas->bNumEndpoints;
+                sa.epfirst            = snap.eps.size();
+                snap.alts.push_back( sa );
+
+                for ( int z=0; z<pas->bNumEndpoints; z++ )
+                {
+                    const libusb_endpoint_descriptor* pep = &pas->endpoint[z];
+
+                    snapep se = snapep();
+                    se.bEndpointAddress = pep->bEndpointAddress;
+                    se.bmAttributes     = pep->bmAttributes;
+                    se.wMaxPacketSize   = pep->wMaxPacketSize;
+                    se.bInterval        = pep->bInterval;
+                    se.extra    = poolbytes( snap, pep->extra, pep->extra_length, false );
+                    se.extralen = pep->extra_length;
+                    snap.eps.push_back( se );
+                }
+            }
+        }
+    }
+    else
+    if ( pcf->raw.size() > 0 )
+    {
+        appendraw( snap, sc, pcf );
+    }
+
+    snap.cfgs.push_back( sc );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t usbsnap_append( usbsnapshot& snap, const usbdevfetch* pf )
+{
+    if ( snap.pool.size() == 0 )
+    {
+        // offset 0 is always empty string.
+        snap.pool.push_back( 0 );
+    }
+
+    snapdev sd = snapdev();
+
+    sd.descerr = pf->descerr;
+    sd.opened  = pf->opened;
+    sd.timedout = pf->timedout;
+    sd.bus     = pf->bus;
+    sd.port    = pf->port;
+    sd.devnum  = pf->devnum;
+    sd.speed   = pf->speed;
+    sd.depth   = pf->depth;
+    memcpy( sd.portpath, pf->portpath, MAX_PORTDEPTH );
+    sd.desc    = pf->desc;
+    sd.bos     = pf->bos;
+    sd.active  = pf->active;
+    sd.actconfig = pf->actconfig;
+
+    sd.manufacturer = poolstr( snap, pf->manufacturer, SLEN_MANUFACTURER );
+    sd.product      = poolstr( snap, pf->product, SLEN_PRODUCT );
+    sd.serialnumber = poolstr( snap, pf->serialnumber, SLEN_SN );
+
+    sd.cfgfirst = snap.cfgs.size();
+    sd.cfgcount = pf->config.size();
+
+    for ( size_t cnt=0; cnt<pf->config.size(); cnt++ )
+    {
+        appendconfig( snap, &pf->config[cnt] );
+    }
+
+    // current alternate setting by interface number, of active config only.
+    for ( size_t cnt=sd.cfgfirst; cnt<snap.cfgs.size(); cnt++ )
+    {
+        const snapcfg* pc = &snap.cfgs[cnt];
+        bool isactive = ( pf->active == true ) && ( pc->valid == true )
+                        && ( pc->bConfigurationValue == pf->actconfig );
+
+        for ( size_t x=0; x<pc->bNumInterfaces; x++ )
+        {
+            snapif* pi = &snap.ifs[pc->iffirst + x];
+            pi->curalt = ALT_UNKNOWN;
+
+            if ( ( isactive == false ) || ( pi->altcount == 0 ) )
+                continue;
+
+            uint8_t ifnum = snap.alts[pi->altfirst].bInterfaceNumber;
+            if ( ifnum < pf->curalts.size() )
+                pi->curalt = pf->curalts[ifnum];
+        }
+    }
+
+    snap.devs.push_back( sd );
+
+    return snap.devs.size() - 1;
+}
+
+size_t usbsnap_build( usbsnapshot& snap, const usbfetchlist& ufl )
+{
+    usbsnap_clear( snap );
+
+    snap.devs.reserve( ufl.size() );
+
+    for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+    {
+        usbsnap_append( snap, &ufl[cnt] );
+    }
+
+    return snap.devs.size();
+}
+
+void usbsnap_clear( usbsnapshot& snap )
+{
+    snap.devs.clear();
+    snap.cfgs.clear();
+    snap.ifs.clear();
+    snap.alts.clear();
+    snap.eps.clear();
+    snap.pool.clear();
+}
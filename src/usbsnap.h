@@ -0,0 +1,110 @@
+#ifndef __USBSNAP_H__
+#define __USBSNAP_H__
+
+#include "usbfetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Flat snapshot of enumerated devices. Every level is kept in its own
+// contiguous array and refers its children by first index and count,
+// strings and extra descriptor bytes are offsets into one pool.
+// Snapshot holds no libusb object, fetched list can be freed after
+// usbsnap_build().
+
+#define SNAP_NOSTR          0   /// offset of empty string in pool.
+
+typedef struct _snapep {
+    uint8_t     bEndpointAddress;
+    uint8_t     bmAttributes;
+    uint16_t    wMaxPacketSize;
+    uint8_t     bInterval;
+    uint32_t    extra;          /// pool offset.
+    uint32_t    extralen;
+}snapep;
+
+typedef struct _snapalt {
+    uint8_t     bInterfaceNumber;
+    uint8_t     bAlternateSetting;
+    uint8_t     bInterfaceClass;
+    uint8_t     bInterfaceSubClass;
+    uint8_t     bInterfaceProtocol;
+    uint8_t     bNumEndpoints;
+    uint32_t    epfirst;
+}snapalt;
+
+typedef struct _snapif {
+    uint32_t    altfirst;
+    uint32_t    altcount;
+    uint8_t     curalt;         /// ALT_UNKNOWN when not read or not active.
+}snapif;
+
+typedef struct _snapcfg {
+    bool        valid;          /// false when descriptor was not read.
+    uint8_t     bNumInterfaces;
+    uint8_t     bConfigurationValue;
+    uint8_t     MaxPower;
+    uint32_t    cfgstr;         /// pool offset.
+    uint32_t    extra;          /// pool offset, NUL terminated.
+    uint32_t    extralen;
+    uint32_t    iffirst;
+}snapcfg;
+
+typedef struct _snapdev {
+    int                         descerr;
+    bool                        opened;
+    bool                        timedout;
+    uint8_t                     bus;
+    uint8_t                     port;
+    uint8_t                     devnum;
+    uint8_t                     speed;          /// libusb_speed.
+    uint8_t                     depth;
+    uint8_t                     portpath[MAX_PORTDEPTH];
+    libusb_device_descriptor    desc;
+    usbdescbos                  bos;            /// zeroed when not read.
+    bool                        active;         /// actconfig and curalt read.
+    uint8_t                     actconfig;      /// 0 for unconfigured.
+    uint32_t                    manufacturer;   /// pool offset.
+    uint32_t                    product;        /// pool offset.
+    uint32_t                    serialnumber;   /// pool offset.
+    uint32_t                    cfgfirst;
+    uint32_t                    cfgcount;
+}snapdev;
+
+typedef struct _usbsnapshot {
+    std::vector< snapdev >      devs;
+    std::vector< snapcfg >      cfgs;
+    std::vector< snapif >       ifs;
+    std::vector< snapalt >      alts;
+    std::vector< snapep >       eps;
+    std::vector< char >         pool;
+}usbsnapshot;
+
+////////////////////////////////////////////////////////////////////////////////
+
+// strings are trimmed as they go into pool.
+size_t usbsnap_build( usbsnapshot& snap, const usbfetchlist& ufl );
+size_t usbsnap_append( usbsnapshot& snap, const usbdevfetch* pf );
+void   usbsnap_clear( usbsnapshot& snap );
+
+static inline const char* usbsnap_str( const usbsnapshot* snap, uint32_t off )
+{
+    return &snap->pool[off];
+}
+
+static inline const uint8_t* usbsnap_bytes( const usbsnapshot* snap, uint32_t off )
+{
+    return (const uint8_t*)&snap->pool[off];
+}
+
+// mA of MaxPower, in 8 mA units since USB 3.0, 2 mA before.
+static inline uint32_t usbsnap_maxpower( const snapdev* pd, const snapcfg* pcf )
+{
+    uint32_t pwr = pcf->MaxPower;
+
+    if ( libusb_cpu_to_le16( pd->desc.bcdUSB ) >= 0x0300 )
+        return pwr * 8;
+
+    return pwr * 2;
+}
+
+#endif /// of __USBSNAP_H__
@@ -0,0 +1,324 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include "usbstats.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define STATS_PORTSTRSZ     ( MAX_PORTDEPTH * 4 + 1 )
+
+typedef struct _statdev {
+    uint8_t         bus;
+    uint8_t         devnum;
+    uint16_t        vid;
+    uint16_t        pid;
+    bool            timedout;
+    char            portpath[STATS_PORTSTRSZ];
+    char            product[SLEN_PRODUCT];
+    usbfetchtime    times;
+}statdev;
+
+struct _usbstats {
+    vector< uint64_t >  samples[USBSTAT_PHASES];
+    vector< statdev >   devs;
+};
+
+typedef struct _statsum {
+    size_t      count;
+    uint64_t    total;
+    uint64_t    p50;
+    uint64_t    p99;
+    uint64_t    max;
+}statsum;
+
+// same order as USBSTAT_*, json keys.
+static const char* phasenames[USBSTAT_PHASES] = {
+    "init",
+    "device_list",
+    "open",
+    "strings",
+    "config",
+    "device",
+    "async_strings",
+    "enumerate",
+    "run"
+};
+
+// FETCHTIME_* of each per device phase.
+static const int phasesteps[USBSTAT_PHASES] = {
+    -1, -1, FETCHTIME_OPEN, FETCHTIME_STRINGS, FETCHTIME_CONFIG, FETCHTIME_DEVICE,
+    -1, -1, -1
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// nearest rank of sorted samples.
+static uint64_t percentile( const vector< uint64_t >& sorted, unsigned pct )
+{
+    size_t rank = ( sorted.size() * pct + 99 ) / 100;
+    if ( rank == 0 )
+        rank = 1;
+
+    return sorted[ rank - 1 ];
+}
+
+static void summary( const vector< uint64_t >& samples, statsum* ps )
+{
+    memset( ps, 0, sizeof( statsum ) );
+
+    ps->count = samples.size();
+    if ( ps->count == 0 )
+        return;
+
+    vector< uint64_t > sorted( samples );
+    sort( sorted.begin(), sorted.end() );
+
+    for ( size_t cnt=0; cnt<sorted.size(); cnt++ )
+    {
+        ps->total += sorted[cnt];
+    }
+
+    ps->p50 = percentile( sorted, 50 );
+    ps->p99 = percentile( sorted, 99 );
+    ps->max = sorted.back();
+}
+
+static double ms( uint64_t usecs )
+{
+    return (double)usecs / 1000.0;
+}
+
+// indexes of slowest devices by whole read, at most USBSTATS_SLOWEST.
+static void slowest( const usbstats* st, vector< size_t >& idxs )
+{
+    idxs.clear();
+
+    for ( size_t cnt=0; cnt<st->devs.size(); cnt++ )
+    {
+        if ( ( st->devs[cnt].times.mask & ( 1 << FETCHTIME_DEVICE ) ) != 0 )
+            idxs.push_back( cnt );
+    }
+
+    const vector< statdev >& devs = st->devs;
+    size_t keep = min( idxs.size(), (size_t)USBSTATS_SLOWEST );
+
+    partial_sort( idxs.begin(), idxs.begin() + keep, idxs.end(),
+                  [&devs]( size_t a, size_t b )
+                  {
+                      return devs[a].times.usecs[FETCHTIME_DEVICE] \
+                             > devs[b].times.usecs[FETCHTIME_DEVICE];
+                  } );
+
+    idxs.resize( keep );
+}
+
+static void json_str( FILE* fp, const char* s )
+{
+    fputc( '"', fp );
+
+    for ( ; *s != 0; s++ )
+    {
+        uint8_t c = (uint8_t)*s;
+
+        if ( ( c == '"' ) || ( c == '\\' ) )
+            fprintf( fp, "\\%c", c );
+        else
+        if ( c < 0x20 )
+            fprintf( fp, "\\u%04x", c );
+        else
+            fputc( c, fp );
+    }
+
+    fputc( '"', fp );
+}
+
+static void write_text( const usbstats* st, FILE* fp )
+{
+    fprintf( fp, "%-14s %7s %12s %10s %10s %10s\n",
+             "phase", "count", "total ms", "p50 ms", "p99 ms", "max ms" );
+
+    for ( int phase=0; phase<USBSTAT_PHASES; phase++ )
+    {
+        statsum sum;
+        summary( st->samples[phase], &sum );
+
+        if ( sum.count == 0 )
+            continue;
+
+        fprintf( fp, "%-14s %7zu %12.3f %10.3f %10.3f %10.3f\n",
+                 phasenames[phase], sum.count, ms( sum.total ),
+                 ms( sum.p50 ), ms( sum.p99 ), ms( sum.max ) );
+    }
+
+    vector< size_t > idxs;
+    slowest( st, idxs );
+
+    if ( idxs.size() == 0 )
+        return;
+
+    fprintf( fp, "slowest devices :\n" );
+
+    for ( size_t cnt=0; cnt<idxs.size(); cnt++ )
+    {
+        const statdev* pd = &st->devs[ idxs[cnt] ];
+
+        fprintf( fp, "  %03u:%03u %-12s %04x:%04x %10.3f ms",
+                 pd->bus, pd->devnum, pd->portpath, pd->vid, pd->pid,
+                 ms( pd->times.usecs[FETCHTIME_DEVICE] ) );
+
+        for ( int phase=USBSTAT_OPEN; phase<USBSTAT_DEVICE; phase++ )
+        {
+            int step = phasesteps[phase];
+            if ( ( pd->times.mask & ( 1 << step ) ) != 0 )
+                fprintf( fp, ", %s %.3f", phasenames[phase], ms( pd->times.usecs[step] ) );
+        }
+
+        if ( pd->timedout == true )
+            fprintf( fp, ", timed out" );
+
+        if ( pd->product[0] != 0 )
+            fprintf( fp, " ( %s )", pd->product );
+
+        fputc( '\n', fp );
+    }
+}
+
+static void write_json( const usbstats* st, FILE* fp )
+{
+    fprintf( fp, "{\"phases\":{" );
+
+    bool first = true;
+    for ( int phase=0; phase<USBSTAT_PHASES; phase++ )
+    {
+        statsum sum;
+        summary( st->samples[phase], &sum );
+
+        if ( sum.count == 0 )
+            continue;
+
+        fprintf( fp, "%s\"%s\":{\"count\":%zu,\"total_ms\":%.3f,\"p50_ms\":%.3f,"
+                     "\"p99_ms\":%.3f,\"max_ms\":%.3f}",
+                 first ? "" : ",", phasenames[phase], sum.count, ms( sum.total ),
+                 ms( sum.p50 ), ms( sum.p99 ), ms( sum.max ) );
+        first = false;
+    }
+
+    fprintf( fp, "},\"slowest\":[" );
+
+    vector< size_t > idxs;
+    slowest( st, idxs );
+
+    for ( size_t cnt=0; cnt<idxs.size(); cnt++ )
+    {
+        const statdev* pd = &st->devs[ idxs[cnt] ];
+
+        fprintf( fp, "%s{\"bus\":%u,\"address\":%u,\"port_path\":\"%s\","
+                     "\"vid\":\"%04x\",\"pid\":\"%04x\",\"product\":",
+                 cnt > 0 ? "," : "", pd->bus, pd->devnum, pd->portpath,
+                 pd->vid, pd->pid );
+        json_str( fp, pd->product );
+
+        for ( int phase=USBSTAT_OPEN; phase<=USBSTAT_DEVICE; phase++ )
+        {
+            int step = phasesteps[phase];
+            if ( ( pd->times.mask & ( 1 << step ) ) != 0 )
+                fprintf( fp, ",\"%s_ms\":%.3f", phasenames[phase], ms( pd->times.usecs[step] ) );
+        }
+
+        fprintf( fp, ",\"timed_out\":%s}", pd->timedout ? "true" : "false" );
+    }
+
+    fprintf( fp, "]}\n" );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+usbstats* usbstats_create()
+{
+    return new usbstats();
+}
+
+void usbstats_destroy( usbstats* st )
+{
+    delete st;
+}
+
+uint64_t usbstats_now()
+{
+    return chrono::duration_cast< chrono::microseconds >(
+               chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+void usbstats_add( usbstats* st, int phase, uint64_t usecs )
+{
+    if ( ( st == NULL ) || ( phase < 0 ) || ( phase >= USBSTAT_PHASES ) )
+        return;
+
+    st->samples[phase].push_back( usecs );
+}
+
+void usbstats_collect( usbstats* st, const usbfetchlist& ufl )
+{
+    if ( st == NULL )
+        return;
+
+    for ( size_t cnt=0; cnt<ufl.size(); cnt++ )
+    {
+        const usbdevfetch* pf = &ufl[cnt];
+
+        if ( ( pf->skipped == true ) || ( pf->times.mask == 0 ) )
+            continue;
+
+        for ( int phase=0; phase<USBSTAT_PHASES; phase++ )
+        {
+            int step = phasesteps[phase];
+            if ( ( step >= 0 ) && ( ( pf->times.mask & ( 1 << step ) ) != 0 ) )
+                st->samples[phase].push_back( pf->times.usecs[step] );
+        }
+
+        statdev sd;
+        memset( &sd, 0, sizeof( statdev ) );
+
+        sd.bus      = pf->bus;
+        sd.devnum   = pf->devnum;
+        sd.vid      = pf->desc.idVendor;
+        sd.pid      = pf->desc.idProduct;
+        sd.timedout = pf->timedout;
+        sd.times    = pf->times;
+
+        size_t len = 0;
+        for ( uint8_t dep=0; dep<pf->depth; dep++ )
+        {
+            len += snprintf( sd.portpath + len, STATS_PORTSTRSZ - len,
+                             dep > 0 ? ".%u" : "%u", pf->portpath[dep] );
+        }
+
+        if ( pf->depth == 0 )
+            strcpy( sd.portpath, "-" );
+
+        snprintf( sd.product, sizeof( sd.product ), "%s", (const char*)pf->product );
+
+        st->devs.push_back( sd );
+    }
+}
+
+void usbstats_write( const usbstats* st, FILE* fp, bool json )
+{
+    if ( ( st == NULL ) || ( fp == NULL ) )
+        return;
+
+    if ( json == true )
+        write_json( st, fp );
+    else
+        write_text( st, fp );
+
+    fflush( fp );
+}
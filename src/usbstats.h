@@ -0,0 +1,40 @@
+#ifndef __USBSTATS_H__
+#define __USBSTATS_H__
+
+#include <cstdio>
+
+#include "usbfetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Timings of --stats. Each phase keeps every sample, reported as count,
+// total, p50, p99 and max. Per device steps come from usbdevfetch times
+// of enumerated records, slowest devices are named by bus, port path and
+// product. Functions do nothing with NULL, not called from many threads.
+
+#define USBSTAT_INIT        0   /// libusb_init_context(), or mock created.
+#define USBSTAT_DEVLIST     1   /// libusb_get_device_list(), or sysfs read.
+#define USBSTAT_OPEN        2   /// libusb_open() of each device.
+#define USBSTAT_STRINGS     3   /// LANGID and device strings of each device.
+#define USBSTAT_CONFIG      4   /// config descriptors and their strings.
+#define USBSTAT_DEVICE      5   /// whole read of each device.
+#define USBSTAT_ASYNC       6   /// strings of all devices by --async.
+#define USBSTAT_ENUM        7   /// usbenum_fetchdevs() as whole.
+#define USBSTAT_RUN         8   /// enumeration and output of listusb.
+#define USBSTAT_PHASES      9
+
+#define USBSTATS_SLOWEST    5
+
+typedef struct _usbstats usbstats;
+
+usbstats* usbstats_create();
+void      usbstats_destroy( usbstats* st );
+// steady clock in microseconds, for samples.
+uint64_t  usbstats_now();
+void      usbstats_add( usbstats* st, int phase, uint64_t usecs );
+// per device samples of every record read, not skipped.
+void      usbstats_collect( usbstats* st, const usbfetchlist& ufl );
+// table as text, or one json object.
+void      usbstats_write( const usbstats* st, FILE* fp, bool json );
+
+#endif /// of __USBSTATS_H__
@@ -0,0 +1,555 @@
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "usbsysfs.h"
+#include "usbdesc.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define SYSFS_PATHMAX       512
+#define SYSFS_DESCMAX       65536
+#define SYSFS_MAXIFS        32
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct _sysfsent {
+    string      name;
+    uint8_t     bus;
+    uint8_t     devnum;
+}sysfsent;
+
+////////////////////////////////////////////////////////////////////////////////
+
+void usbsysfs_freeconfig( libusb_config_descriptor* cfg )
+{
+    if ( cfg == NULL )
+        return;
+
+    if ( cfg->interface != NULL )
+    {
+        for ( uint8_t cnt=0; cnt<cfg->bNumInterfaces; cnt++ )
+        {
+            const libusb_interface* pif = &cfg->interface[cnt];
+
+            for ( int itr=0; itr<pif->num_altsetting; itr++ )
+            {
+                const libusb_interface_descriptor* pad = &pif->altsetting[itr];
+
+                if ( pad->endpoint != NULL )
+                {
+                    for ( uint8_t q=0; q<pad->bNumEndpoints; q++ )
+                    {
+                        free( (void*)pad->endpoint[q].extra );
+                    }
+                }
+
+                free( (void*)pad->endpoint );
+                free( (void*)pad->extra );
+            }
+
+            free( (void*)pif->altsetting );
+        }
+
+        free( (void*)cfg->interface );
+    }
+
+    free( (void*)cfg->extra );
+    free( cfg );
+}
+
+static void sysfs_extra( const uint8_t* raw, size_t start, size_t end,
+                         const unsigned char** extra, int* extralen )
+{
+    if ( end > start )
+    {
+        unsigned char* ext = (unsigned char*)malloc( end - start );
+        if ( ext != NULL )
+        {
+            memcpy( ext, raw + start, end - start );
+            *extra = ext;
+            *extralen = (int)( end - start );
+        }
+    }
+}
+
+libusb_config_descriptor* usbsysfs_parseconfig( const uint8_t* raw, size_t len )
+{
+    if ( ( len < LIBUSB_DT_CONFIG_SIZE ) || ( raw[1] != LIBUSB_DT_CONFIG ) )
+        return NULL;
+
+    libusb_config_descriptor* cfg = \
+        (libusb_config_descriptor*)calloc( 1, sizeof( libusb_config_descriptor ) );
+    if ( cfg == NULL )
+        return NULL;
+
+    cfg->bLength             = raw[0];
+    cfg->bDescriptorType     = raw[1];
+    cfg->wTotalLength        = raw[2] | ( raw[3] << 8 );
+    cfg->bNumInterfaces      = raw[4];
+    cfg->bConfigurationValue = raw[5];
+    cfg->iConfiguration      = raw[6];
+    cfg->bmAttributes        = raw[7];
+    cfg->MaxPower            = raw[8];
+
+    if ( len > cfg->wTotalLength )
+        len = cfg->wTotalLength;
+
+    libusb_interface* ifs = NULL;
+    if ( cfg->bNumInterfaces > 0 )
+    {
+        ifs = (libusb_interface*)calloc( cfg->bNumInterfaces, sizeof( libusb_interface ) );
+        if ( ifs == NULL )
+        {
+            free( cfg );
+            return NULL;
+        }
+    }
+    cfg->interface = ifs;
+
+    size_t pos = usbdesc_nextstd( raw, cfg->bLength, len );
+    sysfs_extra( raw, cfg->bLength, pos, &cfg->extra, &cfg->extra_length );
+
+    while( pos + LIBUSB_DT_INTERFACE_SIZE <= len )
+    {
+        if ( raw[pos + 1] != LIBUSB_DT_INTERFACE )
+        {
+            pos = usbdesc_nextstd( raw, pos + raw[pos], len );
+            continue;
+        }
+
+        uint8_t ifnum = raw[pos + 2];
+        if ( ifnum >= cfg->bNumInterfaces )
+            break;
+
+        libusb_interface* pif = &ifs[ifnum];
+        libusb_interface_descriptor* alts = \
+            (libusb_interface_descriptor*)realloc( (void*)pif->altsetting,
+                                                   ( pif->num_altsetting + 1 )
+                                                   * sizeof( libusb_interface_descriptor ) );
+        if ( alts == NULL )
+            break;
+
+        pif->altsetting = alts;
+        libusb_interface_descriptor* pad = &alts[pif->num_altsetting++];
+        memset( pad, 0, sizeof( libusb_interface_descriptor ) );
+
+        pad->bLength            = raw[pos];
+        pad->bDescriptorType    = raw[pos + 1];
+        pad->bInterfaceNumber   = raw[pos + 2];
+        pad->bAlternateSetting  = raw[pos + 3];
+        pad->bNumEndpoints      = raw[pos + 4];
+        pad->bInterfaceClass    = raw[pos + 5];
+        pad->bInterfaceSubClass = raw[pos + 6];
+        pad->bInterfaceProtocol = raw[pos + 7];
+        pad->iInterface         = raw[pos + 8];
+
+        size_t next = usbdesc_nextstd( raw, pos + raw[pos], len );
+        sysfs_extra( raw, pos + raw[pos], next, &pad->extra, &pad->extra_length );
+        pos = next;
+
+        if ( pad->bNumEndpoints == 0 )
+            continue;
+
+        libusb_endpoint_descriptor* eps = \
+            (libusb_endpoint_descriptor*)calloc( pad->bNumEndpoints,
+                                                 sizeof( libusb_endpoint_descriptor ) );
+        if ( eps == NULL )
+        {
+            pad->bNumEndpoints = 0;
+            continue;
+        }
+        pad->endpoint = eps;
+
+        for ( uint8_t cnt=0; cnt<pad->bNumEndpoints; cnt++ )
+        {
+            if ( ( pos + LIBUSB_DT_ENDPOINT_SIZE > len )
+                 || ( raw[pos + 1] != LIBUSB_DT_ENDPOINT ) )
+                break;
+
+            libusb_endpoint_descriptor* ped = &eps[cnt];
+
+            ped->bLength          = raw[pos];
+            ped->bDescriptorType  = raw[pos + 1];
+            ped->bEndpointAddress = raw[pos + 2];
+            ped->bmAttributes     = raw[pos + 3];
+            ped->wMaxPacketSize   = raw[pos + 4] | ( raw[pos + 5] << 8 );
+            ped->bInterval        = raw[pos + 6];
+
+            if ( ped->bLength >= LIBUSB_DT_ENDPOINT_AUDIO_SIZE )
+            {
+                ped->bRefresh      = raw[pos + 7];
+                ped->bSynchAddress = raw[pos + 8];
+            }
+
+            next = usbdesc_nextstd( raw, pos + raw[pos], len );
+            sysfs_extra( raw, pos + raw[pos], next, &ped->extra, &ped->extra_length );
+            pos = next;
+        }
+    }
+
+    return cfg;
+}
+
+#ifdef __linux__
+
+static size_t sysfs_read( const char* root, const char* dev, const char* attr,
+                          uint8_t* buff, size_t buffsz )
+{
+    char path[SYSFS_PATHMAX] = {0};
+    snprintf( path, SYSFS_PATHMAX, "%s/%s/%s", root, dev, attr );
+
+    int fd = open( path, O_RDONLY );
+    if ( fd < 0 )
+        return 0;
+
+    size_t rlen = 0;
+    while( rlen < buffsz )
+    {
+        ssize_t rr = read( fd, buff + rlen, buffsz - rlen );
+        if ( rr <= 0 )
+            break;
+        rlen += rr;
+    }
+
+    close( fd );
+    return rlen;
+}
+
+static bool sysfs_readstr( const char* root, const char* dev, const char* attr,
+                           uint8_t* dst, size_t dstlen )
+{
+    uint8_t buff[256] = {0};
+    size_t  rlen = sysfs_read( root, dev, attr, buff, sizeof( buff ) - 1 );
+
+    if ( rlen == 0 )
+        return false;
+
+    // kernel gives UTF-8 string with new line, kept as UTF-8 same as
+    // strings read from device, never cuts a character.
+    size_t di = 0;
+    for ( size_t si=0; ( si < rlen ) && ( buff[si] != '\n' ); )
+    {
+        size_t n = 1;
+        if ( buff[si] >= 0xF0 )
+            n = 4;
+        else
+        if ( buff[si] >= 0xE0 )
+            n = 3;
+        else
+        if ( buff[si] >= 0xC0 )
+            n = 2;
+
+        if ( ( si + n > rlen ) || ( di + n >= dstlen ) )
+            break;
+
+        memcpy( dst + di, buff + si, n );
+        di += n;
+        si += n;
+    }
+
+    dst[di] = 0;
+    return true;
+}
+
+static unsigned long sysfs_readnum( const char* root, const char* dev, const char* attr, int base )
+{
+    char buff[32] = {0};
+
+    if ( sysfs_read( root, dev, attr, (uint8_t*)buff, sizeof( buff ) - 1 ) > 0 )
+    {
+        return strtoul( buff, NULL, base );
+    }
+
+    return 0;
+}
+
+// speed attribute is Mbps, "1.5" for low speed reads as 1.
+static uint8_t sysfs_speed( const char* root, const char* dev )
+{
+    switch( sysfs_readnum( root, dev, "speed", 10 ) )
+    {
+        case 1:     return LIBUSB_SPEED_LOW;
+        case 12:    return LIBUSB_SPEED_FULL;
+        case 480:   return LIBUSB_SPEED_HIGH;
+        case 5000:  return LIBUSB_SPEED_SUPER;
+        case 10000: return LIBUSB_SPEED_SUPER_PLUS;
+        case 20000: return 6;   /// LIBUSB_SPEED_SUPER_PLUS_X2 of newer libusb.
+    }
+
+    return LIBUSB_SPEED_UNKNOWN;
+}
+
+static bool sysfs_isdevice( const char* name )
+{
+    // skip interfaces ( "1-1:1.0" ) and others than "usbN" or "N-p.p".
+    if ( strchr( name, ':' ) != NULL )
+        return false;
+
+    if ( strncmp( name, "usb", 3 ) == 0 )
+        return true;
+
+    return ( isdigit( name[0] ) && ( strchr( name, '-' ) != NULL ) );
+}
+
+static uint8_t sysfs_portnumber( const char* name )
+{
+    // root hub "usbN" has no port.
+    const char* sep = strrchr( name, '.' );
+    if ( sep == NULL )
+        sep = strrchr( name, '-' );
+
+    if ( sep == NULL )
+        return 0;
+
+    return (uint8_t)atoi( sep + 1 );
+}
+
+static uint8_t sysfs_portpath( const char* name, uint8_t* path, size_t pathlen )
+{
+    // "1-2.3.4" to { 2, 3, 4 }.
+    const char* sep = strchr( name, '-' );
+    uint8_t depth = 0;
+
+    while( ( sep != NULL ) && ( depth < pathlen ) )
+    {
+        path[depth++] = (uint8_t)atoi( sep + 1 );
+        sep = strchr( sep + 1, '.' );
+    }
+
+    return depth;
+}
+
+// interface directories of active config, "1-2.3:1.0", numbered from 0
+// as nearly every device does.
+static bool sysfs_active( const char* root, const char* name, usbdevfetch* pf )
+{
+    char buff[32] = {0};
+
+    // empty when unconfigured.
+    if ( sysfs_read( root, name, "bConfigurationValue", (uint8_t*)buff, sizeof( buff ) - 1 ) == 0 )
+        return false;
+
+    pf->active    = true;
+    pf->actconfig = (uint8_t)strtoul( buff, NULL, 10 );
+    pf->curalts.clear();
+
+    if ( pf->actconfig == 0 )
+        return true;
+
+    unsigned long numifs = sysfs_readnum( root, name, "bNumInterfaces", 10 );
+    if ( numifs > SYSFS_MAXIFS )
+        numifs = SYSFS_MAXIFS;
+
+    pf->curalts.assign( numifs, ALT_UNKNOWN );
+
+    for ( unsigned long cnt=0; cnt<numifs; cnt++ )
+    {
+        char ifname[SYSFS_PATHMAX] = {0};
+        snprintf( ifname, SYSFS_PATHMAX, "%s:%u.%lu", name, pf->actconfig, cnt );
+
+        if ( sysfs_read( root, ifname, "bAlternateSetting", (uint8_t*)buff, sizeof( buff ) - 1 ) > 0 )
+            pf->curalts[cnt] = (uint8_t)strtoul( buff, NULL, 10 );
+    }
+
+    return true;
+}
+
+bool usbsysfs_readactive( const char* root, usbdevfetch* pf )
+{
+    if ( pf == NULL )
+        return false;
+
+    if ( root == NULL )
+        root = USBSYSFS_ROOT;
+
+    char name[SYSFS_PATHMAX] = {0};
+
+    if ( pf->depth == 0 )
+    {
+        snprintf( name, SYSFS_PATHMAX, "usb%u", pf->bus );
+    }
+    else
+    {
+        int len = snprintf( name, SYSFS_PATHMAX, "%u-%u", pf->bus, pf->portpath[0] );
+
+        for ( uint8_t cnt=1; ( cnt<pf->depth ) && ( len > 0 ) && ( len < 64 ); cnt++ )
+            len += snprintf( name + len, SYSFS_PATHMAX - len, ".%u", pf->portpath[cnt] );
+    }
+
+    return sysfs_active( root, name, pf );
+}
+
+static void sysfs_fetchdev( const char* root, const char* name,
+                            usbdevfetch* pf, bool withconfig )
+{
+    vector< uint8_t > raw( SYSFS_DESCMAX );
+    size_t rawlen = sysfs_read( root, name, "descriptors", raw.data(), raw.size() );
+
+    libusb_device_descriptor& desc = pf->desc;
+
+    if ( rawlen >= LIBUSB_DT_DEVICE_SIZE )
+    {
+        desc.bLength            = raw[0];
+        desc.bDescriptorType    = raw[1];
+        desc.bcdUSB             = raw[2] | ( raw[3] << 8 );
+        desc.bDeviceClass       = raw[4];
+        desc.bDeviceSubClass    = raw[5];
+        desc.bDeviceProtocol    = raw[6];
+        desc.bMaxPacketSize0    = raw[7];
+        desc.idVendor           = raw[8] | ( raw[9] << 8 );
+        desc.idProduct          = raw[10] | ( raw[11] << 8 );
+        desc.bcdDevice          = raw[12] | ( raw[13] << 8 );
+        desc.iManufacturer      = raw[14];
+        desc.iProduct           = raw[15];
+        desc.iSerialNumber      = raw[16];
+        desc.bNumConfigurations = raw[17];
+    }
+    else
+    {
+        // no descriptors, use text attributes.
+        char ver[16] = {0};
+        sysfs_read( root, name, "version", (uint8_t*)ver, sizeof( ver ) - 1 );
+        unsigned vh = 0, vl = 0;
+        sscanf( ver, " %u.%x", &vh, &vl );
+
+        desc.bLength            = LIBUSB_DT_DEVICE_SIZE;
+        desc.bDescriptorType    = LIBUSB_DT_DEVICE;
+        desc.bcdUSB             = (uint16_t)( ( ( vh / 10 ) << 12 ) | ( ( vh % 10 ) << 8 ) | vl );
+        desc.bDeviceClass       = sysfs_readnum( root, name, "bDeviceClass", 16 );
+        desc.bDeviceSubClass    = sysfs_readnum( root, name, "bDeviceSubClass", 16 );
+        desc.bDeviceProtocol    = sysfs_readnum( root, name, "bDeviceProtocol", 16 );
+        desc.idVendor           = sysfs_readnum( root, name, "idVendor", 16 );
+        desc.idProduct          = sysfs_readnum( root, name, "idProduct", 16 );
+        desc.bcdDevice          = sysfs_readnum( root, name, "bcdDevice", 16 );
+        desc.bNumConfigurations = sysfs_readnum( root, name, "bNumConfigurations", 10 );
+        rawlen = 0;
+    }
+
+    pf->descerr   = 0;
+    pf->opened    = true;
+    pf->fromsysfs = true;
+    pf->bus       = sysfs_readnum( root, name, "busnum", 10 );
+    pf->port      = sysfs_portnumber( name );
+    pf->devnum    = sysfs_readnum( root, name, "devnum", 10 );
+    pf->speed     = sysfs_speed( root, name );
+    pf->depth     = sysfs_portpath( name, pf->portpath, MAX_PORTDEPTH );
+
+    sysfs_readstr( root, name, "manufacturer", pf->manufacturer, SLEN_MANUFACTURER );
+    sysfs_readstr( root, name, "product", pf->product, SLEN_PRODUCT );
+    sysfs_readstr( root, name, "serial", pf->serialnumber, SLEN_SN );
+
+    if ( ( withconfig == true ) && ( desc.bNumConfigurations > 0 ) )
+    {
+        pf->config.resize( desc.bNumConfigurations );
+
+        size_t pos = LIBUSB_DT_DEVICE_SIZE;
+        for ( uint8_t cnt=0; cnt<desc.bNumConfigurations; cnt++ )
+        {
+            pf->config[cnt].cfg = NULL;
+
+            if ( pos + LIBUSB_DT_CONFIG_SIZE <= rawlen )
+            {
+                uint16_t tlen = raw[pos + 2] | ( raw[pos + 3] << 8 );
+
+                // kept raw, read through usbdesc views without a tree.
+                size_t clen = tlen > LIBUSB_DT_CONFIG_SIZE ? tlen : LIBUSB_DT_CONFIG_SIZE;
+                if ( clen > rawlen - pos )
+                    clen = rawlen - pos;
+                pf->config[cnt].raw.assign( &raw[pos], &raw[pos] + clen );
+
+                if ( tlen < LIBUSB_DT_CONFIG_SIZE )
+                    tlen = LIBUSB_DT_CONFIG_SIZE;
+                pos += tlen;
+            }
+        }
+    }
+}
+
+static bool sysfs_entcmp( const sysfsent& a, const sysfsent& b )
+{
+    if ( a.bus != b.bus )
+        return ( a.bus < b.bus );
+
+    return ( a.devnum < b.devnum );
+}
+
+size_t usbsysfs_fetchdevs( const char* root, usbfetchlist& ufl, bool withconfig,
+                            int* listerr )
+{
+    if ( root == NULL )
+        root = USBSYSFS_ROOT;
+
+    if ( listerr != NULL )
+        *listerr = 0;
+
+    DIR* dir = opendir( root );
+    if ( dir == NULL )
+    {
+        if ( listerr != NULL )
+            *listerr = LIBUSB_ERROR_IO;
+        return 0;
+    }
+
+    vector< sysfsent > ents;
+    struct dirent* de = NULL;
+
+    while( ( de = readdir( dir ) ) != NULL )
+    {
+        if ( sysfs_isdevice( de->d_name ) == false )
+            continue;
+
+        sysfsent ent;
+        ent.name   = de->d_name;
+        ent.bus    = sysfs_readnum( root, de->d_name, "busnum", 10 );
+        ent.devnum = sysfs_readnum( root, de->d_name, "devnum", 10 );
+        ents.push_back( ent );
+    }
+
+    closedir( dir );
+
+    // readdir() order is not stable, keeps as bus and address.
+    sort( ents.begin(), ents.end(), sysfs_entcmp );
+
+    ufl.clear();
+    ufl.resize( ents.size() );
+
+    for ( size_t cnt=0; cnt<ents.size(); cnt++ )
+    {
+        sysfs_fetchdev( root, ents[cnt].name.c_str(), &ufl[cnt], withconfig );
+    }
+
+    return ufl.size();
+}
+
+#else /// of __linux__
+
+size_t usbsysfs_fetchdevs( const char* root, usbfetchlist& ufl, bool withconfig,
+                            int* listerr )
+{
+    ufl.clear();
+
+    if ( listerr != NULL )
+        *listerr = LIBUSB_ERROR_NOT_SUPPORTED;
+
+    return 0;
+}
+
+bool usbsysfs_readactive( const char* root, usbdevfetch* pf )
+{
+    return false;
+}
+
+#endif /// of __linux__
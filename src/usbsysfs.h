@@ -0,0 +1,30 @@
+#ifndef __USBSYSFS_H__
+#define __USBSYSFS_H__
+
+#include "usbfetch.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define USBSYSFS_ROOT       "/sys/bus/usb/devices"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Fills device records from Linux sysfs ( or same layout of fake tree in
+// root ) without opening any device. Config descriptors are kept as raw
+// bytes of `descriptors` file when withconfig is true, read by usbdesc
+// views. Returns number of devices, always 0 on other than Linux.
+size_t usbsysfs_fetchdevs( const char* root, usbfetchlist& ufl, bool withconfig,
+                            int* listerr = NULL );
+void   usbsysfs_freeconfig( libusb_config_descriptor* cfg );
+
+// Active config and current alternate setting of its interfaces, of
+// device at bus and port path of pf, as kernel keeps them, for devices of
+// libusb and of usbsysfs_fetchdevs() alike. False when not in sysfs.
+bool   usbsysfs_readactive( const char* root, usbdevfetch* pf );
+
+// Builds libusb_config_descriptor from raw descriptor bytes, as same way
+// of libusb does ( class specific descriptors are kept in extra ), on any
+// platform. Released by usbsysfs_freeconfig().
+libusb_config_descriptor* usbsysfs_parseconfig( const uint8_t* raw, size_t len );
+
+#endif /// of __USBSYSFS_H__
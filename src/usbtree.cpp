@@ -0,0 +1,397 @@
+#include <libusb.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include "usbtree.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define TREE_ALIGN          ( sizeof( void* ) * 2 )
+#define TREE_STRCAP         64      /// initial intern slots, power of 2.
+#define TREE_NODECAP        64      /// initial index slots, power of 2.
+
+struct _usbarenablk {
+    usbarenablk*    next;
+    size_t          size;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void* tree_alloc( usbtree& tree, size_t sz )
+{
+    sz = ( sz + TREE_ALIGN - 1 ) & ~( TREE_ALIGN - 1 );
+
+    if ( sz > tree.left )
+    {
+        // oversized request gets its own block, rest of current one is kept.
+        size_t blksz = sz > USBTREE_BLOCKSZ ? sz : USBTREE_BLOCKSZ;
+        size_t hdrsz = ( sizeof( usbarenablk ) + TREE_ALIGN - 1 ) & ~( TREE_ALIGN - 1 );
+
+        usbarenablk* pb = (usbarenablk*)malloc( hdrsz + blksz );
+        if ( pb == NULL )
+            return NULL;
+
+        pb->next    = tree.blocks;
+        pb->size    = blksz;
+        tree.blocks = pb;
+
+        if ( sz < USBTREE_BLOCKSZ )
+        {
+            tree.cur  = (char*)pb + hdrsz;
+            tree.left = blksz;
+        }
+        else
+        {
+            return (char*)pb + hdrsz;
+        }
+    }
+
+    void* p = tree.cur;
+    tree.cur  += sz;
+    tree.left -= sz;
+
+    return p;
+}
+
+static uint32_t tree_hash( const char* str, size_t len )
+{
+    // FNV-1a
+    uint32_t h = 2166136261u;
+
+    for ( size_t cnt=0; cnt<len; cnt++ )
+    {
+        h ^= (uint8_t)str[cnt];
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+static bool tree_growstr( usbtree& tree )
+{
+    size_t newcap = tree.strcap > 0 ? tree.strcap * 2 : TREE_STRCAP;
+
+    usbtreestr* newtab = (usbtreestr*)tree_alloc( tree, newcap * sizeof( usbtreestr ) );
+    if ( newtab == NULL )
+        return false;
+
+    memset( newtab, 0, newcap * sizeof( usbtreestr ) );
+
+    // old table stays in arena until tree is freed.
+    for ( size_t cnt=0; cnt<tree.strcap; cnt++ )
+    {
+        const usbtreestr* ps = &tree.strtab[cnt];
+        if ( ps->str == NULL )
+            continue;
+
+        size_t pos = ps->hash & ( newcap - 1 );
+        while( newtab[pos].str != NULL )
+            pos = ( pos + 1 ) & ( newcap - 1 );
+
+        newtab[pos] = *ps;
+    }
+
+    tree.strtab = newtab;
+    tree.strcap = newcap;
+
+    return true;
+}
+
+// bus in top byte, then ports from root. Port numbers start from 1,
+// so unused bytes of shorter chain never collide with a port.
+static uint64_t tree_key( uint8_t bus, const uint8_t* portpath, uint8_t depth )
+{
+    uint64_t k = (uint64_t)bus << 56;
+
+    for ( uint8_t cnt=0; ( cnt<depth ) && ( cnt<MAX_PORTDEPTH ); cnt++ )
+    {
+        k |= (uint64_t)portpath[cnt] << ( 48 - cnt * 8 );
+    }
+
+    return k;
+}
+
+static size_t tree_slot( uint64_t key, size_t cap )
+{
+    // 64 bit mix of murmur3 finalizer.
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDull;
+    key ^= key >> 33;
+
+    return key & ( cap - 1 );
+}
+
+static bool tree_index( usbtree& tree, uint64_t key, usbtreedev* pn )
+{
+    if ( ( tree.nodecnt + 1 ) * 4 > tree.nodecap * 3 )
+    {
+        size_t newcap = tree.nodecap > 0 ? tree.nodecap * 2 : TREE_NODECAP;
+
+        usbtreeidx* newtab = (usbtreeidx*)tree_alloc( tree, newcap * sizeof( usbtreeidx ) );
+        if ( newtab == NULL )
+            return false;
+
+        memset( newtab, 0, newcap * sizeof( usbtreeidx ) );
+
+        for ( size_t cnt=0; cnt<tree.nodecap; cnt++ )
+        {
+            const usbtreeidx* pi = &tree.nodetab[cnt];
+            if ( pi->node == NULL )
+                continue;
+
+            size_t pos = tree_slot( pi->key, newcap );
+            while( newtab[pos].node != NULL )
+                pos = ( pos + 1 ) & ( newcap - 1 );
+
+            newtab[pos] = *pi;
+        }
+
+        tree.nodetab = newtab;
+        tree.nodecap = newcap;
+    }
+
+    size_t pos = tree_slot( key, tree.nodecap );
+    while( tree.nodetab[pos].node != NULL )
+    {
+        // first one listed keeps same chain.
+        if ( tree.nodetab[pos].key == key )
+            return true;
+
+        pos = ( pos + 1 ) & ( tree.nodecap - 1 );
+    }
+
+    tree.nodetab[pos].key  = key;
+    tree.nodetab[pos].node = pn;
+    tree.nodecnt++;
+
+    return true;
+}
+
+static usbtreedev* tree_lookup( const usbtree& tree, uint64_t key )
+{
+    if ( tree.nodecap == 0 )
+        return NULL;
+
+    size_t pos = tree_slot( key, tree.nodecap );
+    while( tree.nodetab[pos].node != NULL )
+    {
+        if ( tree.nodetab[pos].key == key )
+            return tree.nodetab[pos].node;
+
+        pos = ( pos + 1 ) & ( tree.nodecap - 1 );
+    }
+
+    return NULL;
+}
+
+// inserts pn into sibling list of head, ordered by port.
+static void tree_insert( usbtreedev** head, usbtreedev* pn )
+{
+    while( ( *head != NULL ) && ( (*head)->port <= pn->port ) )
+        head = &(*head)->next;
+
+    pn->next = *head;
+    *head    = pn;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void usbtree_init( usbtree& tree )
+{
+    memset( &tree, 0, sizeof( usbtree ) );
+}
+
+void usbtree_free( usbtree& tree )
+{
+    usbarenablk* pb = tree.blocks;
+
+    while( pb != NULL )
+    {
+        usbarenablk* next = pb->next;
+        free( pb );
+        pb = next;
+    }
+
+    usbtree_init( tree );
+}
+
+const char* usbtree_intern( usbtree& tree, const char* str )
+{
+    if ( str == NULL )
+        return NULL;
+
+    // keeps load factor under 3/4.
+    if ( ( tree.strcnt + 1 ) * 4 > tree.strcap * 3 )
+    {
+        if ( tree_growstr( tree ) == false )
+            return NULL;
+    }
+
+    size_t   len = strlen( str );
+    uint32_t h   = tree_hash( str, len );
+    size_t   pos = h & ( tree.strcap - 1 );
+
+    while( tree.strtab[pos].str != NULL )
+    {
+        if ( ( tree.strtab[pos].hash == h )
+             && ( strcmp( tree.strtab[pos].str, str ) == 0 ) )
+        {
+            return tree.strtab[pos].str;
+        }
+
+        pos = ( pos + 1 ) & ( tree.strcap - 1 );
+    }
+
+    char* ps = (char*)tree_alloc( tree, len + 1 );
+    if ( ps == NULL )
+        return NULL;
+
+    memcpy( ps, str, len + 1 );
+
+    tree.strtab[pos].hash = h;
+    tree.strtab[pos].str  = ps;
+    tree.strcnt++;
+
+    return ps;
+}
+
+usbtreedev* usbtree_add( usbtree& tree, const usbsnapshot* snap, size_t idx )
+{
+    if ( ( snap == NULL ) || ( idx >= snap->devs.size() ) )
+        return NULL;
+
+    const snapdev* pd = &snap->devs[idx];
+    if ( pd->descerr != 0 )
+        return NULL;
+
+    usbtreebus* pb = tree.busidx[pd->bus];
+    if ( pb == NULL )
+    {
+        pb = (usbtreebus*)tree_alloc( tree, sizeof( usbtreebus ) );
+        if ( pb == NULL )
+            return NULL;
+
+        memset( pb, 0, sizeof( usbtreebus ) );
+        pb->bus = pd->bus;
+        tree.busidx[pd->bus] = pb;
+    }
+
+    usbtreedev* pn = (usbtreedev*)tree_alloc( tree, sizeof( usbtreedev ) );
+    if ( pn == NULL )
+        return NULL;
+
+    memset( pn, 0, sizeof( usbtreedev ) );
+    pn->bus      = pd->bus;
+    pn->port     = pd->port;
+    pn->depth    = pd->depth;
+    memcpy( pn->portpath, pd->portpath, MAX_PORTDEPTH );
+    pn->vid      = pd->desc.idVendor;
+    pn->pid      = pd->desc.idProduct;
+    pn->bcd      = libusb_cpu_to_le16( pd->desc.bcdUSB );
+    pn->clsid    = pd->desc.bDeviceClass;
+    pn->subclsid = pd->desc.bDeviceSubClass;
+
+    if ( pd->opened == true )
+    {
+        const char* dev_pn = usbsnap_str( snap, pd->product );
+        const char* dev_mn = usbsnap_str( snap, pd->manufacturer );
+        const char* dev_sn = usbsnap_str( snap, pd->serialnumber );
+
+        pn->product      = usbtree_intern( tree, *dev_pn != 0 ? dev_pn : "-" );
+        pn->manufacturer = usbtree_intern( tree, *dev_mn != 0 ? dev_mn : "-" );
+        pn->serialnumber = usbtree_intern( tree, *dev_sn != 0 ? dev_sn : "-" );
+    }
+
+    // not opened device shows empty strings.
+    if ( pn->product == NULL )
+        pn->product = "";
+    if ( pn->manufacturer == NULL )
+        pn->manufacturer = "";
+    if ( pn->serialnumber == NULL )
+        pn->serialnumber = "";
+
+    if ( tree_index( tree, tree_key( pn->bus, pn->portpath, pn->depth ), pn ) == false )
+        return NULL;
+
+    if ( tree.seqlast != NULL )
+        tree.seqlast->seq = pn;
+    else
+        tree.seqfirst = pn;
+
+    tree.seqlast = pn;
+    pb->devs++;
+
+    return pn;
+}
+
+void usbtree_link( usbtree& tree )
+{
+    // buses ordered by number.
+    usbtreebus** nextbus = &tree.first;
+    for ( size_t cnt=0; cnt<256; cnt++ )
+    {
+        usbtreebus* pb = tree.busidx[cnt];
+        if ( pb == NULL )
+            continue;
+
+        pb->first = NULL;
+        *nextbus  = pb;
+        nextbus   = &pb->next;
+    }
+    *nextbus = NULL;
+
+    for ( usbtreedev* pn = tree.seqfirst; pn != NULL; pn = pn->seq )
+    {
+        pn->child = NULL;
+        pn->next  = NULL;
+    }
+
+    for ( usbtreedev* pn = tree.seqfirst; pn != NULL; pn = pn->seq )
+    {
+        pn->parent = NULL;
+
+        // nearest listed hub of chain, root hub is chain of depth 0.
+        for ( int dep = (int)pn->depth - 1; dep >= 0; dep-- )
+        {
+            usbtreedev* pp = tree_lookup( tree, tree_key( pn->bus, pn->portpath, dep ) );
+            if ( ( pp != NULL ) && ( pp != pn ) )
+            {
+                pn->parent = pp;
+                break;
+            }
+        }
+
+        if ( pn->parent != NULL )
+            tree_insert( &pn->parent->child, pn );
+        else
+            tree_insert( &tree.busidx[pn->bus]->first, pn );
+    }
+}
+
+usbtreedev* usbtree_find( const usbtree& tree, uint8_t bus,
+                          const uint8_t* portpath, uint8_t depth )
+{
+    return tree_lookup( tree, tree_key( bus, portpath, depth ) );
+}
+
+const usbtreedev* usbtree_walk( const usbtreedev* pn )
+{
+    if ( pn == NULL )
+        return NULL;
+
+    if ( pn->child != NULL )
+        return pn->child;
+
+    while( pn != NULL )
+    {
+        if ( pn->next != NULL )
+            return pn->next;
+
+        pn = pn->parent;
+    }
+
+    return NULL;
+}
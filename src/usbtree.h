@@ -0,0 +1,90 @@
+#ifndef __USBTREE_H__
+#define __USBTREE_H__
+
+#include "usbsnap.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Hub topology tree of tree view. Each device is placed under the hub
+// which has its port chain less last port, or under its bus when no
+// such hub is listed. Nodes are indexed by bus and port chain, found in
+// O(1). Every node and string lives in arena blocks owned by tree, so
+// building costs no allocation per device and usbtree_free() releases
+// whole tree by its blocks. Strings are interned, devices of same
+// vendor share one manufacturer string.
+
+#define USBTREE_BLOCKSZ     65536
+
+typedef struct _usbtreedev {
+    struct _usbtreedev* parent;         /// NULL at top of bus.
+    struct _usbtreedev* child;          /// first child, ordered by port.
+    struct _usbtreedev* next;           /// next sibling.
+    struct _usbtreedev* seq;            /// next in order of usbtree_add().
+    const char*         manufacturer;   /// interned, "-" when empty.
+    const char*         product;
+    const char*         serialnumber;
+    uint16_t            vid;
+    uint16_t            pid;
+    uint16_t            bcd;
+    uint8_t             bus;
+    uint8_t             port;
+    uint8_t             depth;          /// 0 for root hub.
+    uint8_t             portpath[MAX_PORTDEPTH];
+    uint8_t             clsid;
+    uint8_t             subclsid;
+}usbtreedev;
+
+typedef struct _usbtreebus {
+    struct _usbtreebus* next;           /// ordered by bus number.
+    usbtreedev*         first;          /// top nodes, ordered by port.
+    size_t              devs;           /// all nodes of bus.
+    uint8_t             bus;
+}usbtreebus;
+
+typedef struct _usbtreestr {
+    uint32_t            hash;
+    const char*         str;
+}usbtreestr;
+
+typedef struct _usbtreeidx {
+    uint64_t            key;            /// bus and port chain.
+    usbtreedev*         node;
+}usbtreeidx;
+
+typedef struct _usbarenablk usbarenablk;
+
+typedef struct _usbtree {
+    usbarenablk*        blocks;         /// newest first.
+    char*               cur;
+    size_t              left;
+    usbtreestr*         strtab;         /// open addressing, in arena.
+    size_t              strcap;
+    size_t              strcnt;
+    usbtreeidx*         nodetab;        /// open addressing, in arena.
+    size_t              nodecap;
+    size_t              nodecnt;
+    usbtreedev*         seqfirst;
+    usbtreedev*         seqlast;
+    usbtreebus*         first;
+    usbtreebus*         busidx[256];    /// by bus number.
+}usbtree;
+
+////////////////////////////////////////////////////////////////////////////////
+
+void        usbtree_init( usbtree& tree );
+void        usbtree_free( usbtree& tree );
+
+// adds device idx of snap, NULL for descriptor error. Nodes are placed
+// in topology by usbtree_link() after all devices are added, as a hub
+// may be listed after its children.
+usbtreedev* usbtree_add( usbtree& tree, const usbsnapshot* snap, size_t idx );
+void        usbtree_link( usbtree& tree );
+usbtreedev* usbtree_find( const usbtree& tree, uint8_t bus,
+                          const uint8_t* portpath, uint8_t depth );
+
+// next node of depth first walk inside one bus, NULL at end.
+const usbtreedev* usbtree_walk( const usbtreedev* pn );
+
+const char* usbtree_intern( usbtree& tree, const char* str );
+
+#endif /// of __USBTREE_H__
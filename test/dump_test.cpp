@@ -0,0 +1,101 @@
+// Decoding of snapshot images against crafted headers, as --load of a
+// file and --from-daemon of socket data both decode untrusted bytes.
+// Image of usbmock devices is encoded, decoded back, then patched :
+//
+//  truncated : image cut in half.
+//  wrapped   : section offset near 2^64, offset plus size wraps to
+//              inside of image.
+//  beyond    : section offset past end of image, no entries.
+//
+// Each case prints ok or FAIL, exit code is number of failed cases.
+//
+// build : make test
+// usage : bin/dump_test
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+
+#include "usbenum.h"
+#include "usbsnap.h"
+#include "usbdump.h"
+#include "usbmock.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// of dumphdr : magic, version, endian, hdrsize and reserved, then
+// sections of offset, count and entsize. Devices are first section.
+#define TEST_SECTOFF        24
+#define TEST_SECTSZ         16
+
+static int failed = 0;
+
+static void check( const char* name, bool result, bool expected )
+{
+    printf( "%-12s: %s\n", name, result == expected ? "ok" : "FAIL" );
+
+    if ( result != expected )
+        failed++;
+}
+
+static void setsect( std::vector< uint8_t >& img, size_t sect,
+                     uint64_t offset, uint32_t count )
+{
+    uint8_t* ps = &img[TEST_SECTOFF + sect * TEST_SECTSZ];
+
+    memcpy( ps, &offset, sizeof( uint64_t ) );
+    memcpy( ps + 8, &count, sizeof( uint32_t ) );
+}
+
+static uint32_t getentsize( const std::vector< uint8_t >& img, size_t sect )
+{
+    uint32_t entsize = 0;
+
+    memcpy( &entsize, &img[TEST_SECTOFF + sect * TEST_SECTSZ + 12], sizeof( uint32_t ) );
+    return entsize;
+}
+
+int main( int argc, char** argv )
+{
+    usbmockopt mopt;
+    usbmock_defaults( &mopt );
+    mopt.devices = 8;
+
+    usbmock* mock = usbmock_create( &mopt );
+
+    usbenumopt opt;
+    usbenum_defaults( &opt );
+    opt.backend = usbmock_backend();
+
+    usbfetchlist ufl;
+    usbsnapshot  snap;
+    usbsnapshot  back;
+
+    usbenum_fetchdevs( usbmock_context( mock ), &opt, ufl, true );
+    usbsnap_build( snap, ufl );
+    usbenum_free( ufl );
+    usbmock_destroy( mock );
+
+    std::vector< uint8_t > img;
+    check( "encode", usbdump_encode( &snap, img ), true );
+    check( "decode", usbdump_decode( img.data(), img.size(), back ), true );
+    check( "devices", back.devs.size() == snap.devs.size(), true );
+
+    std::vector< uint8_t > cut( img.begin(), img.begin() + img.size() / 2 );
+    check( "truncated", usbdump_decode( cut.data(), cut.size(), back ), false );
+
+    // 2^64 less a few entries, plus count of entries ends at 16.
+    std::vector< uint8_t > wrap( img );
+    uint32_t entsize = getentsize( wrap, 0 );
+    uint32_t count   = 0x10000;
+    setsect( wrap, 0, (uint64_t)0 - (uint64_t)count * entsize + 16, count );
+    check( "wrapped", usbdump_decode( wrap.data(), wrap.size(), back ), false );
+
+    std::vector< uint8_t > beyond( img );
+    setsect( beyond, 0, (uint64_t)img.size() + 8, 0 );
+    check( "beyond", usbdump_decode( beyond.data(), beyond.size(), back ), false );
+
+    return failed;
+}